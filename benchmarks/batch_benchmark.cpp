@@ -0,0 +1,77 @@
+#include "BitmapPlusPlus.hpp"
+#include "benchmark.hpp"
+#include <string>
+#include <vector>
+
+int main() {
+  constexpr std::int32_t size = 2048;
+  constexpr std::size_t count = 100000;
+  bmp::Bitmap image(size, size);
+
+  std::vector<std::int32_t> x(count), y(count), x2(count), y2(count), width(count), height(count), radius(count);
+  std::vector<bmp::Pixel> colors(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    x[i] = static_cast<std::int32_t>((i * 97) % (size - 32));
+    y[i] = static_cast<std::int32_t>((i * 61) % (size - 32));
+    x2[i] = x[i] + static_cast<std::int32_t>(i % 24);
+    y2[i] = y[i] + static_cast<std::int32_t>(i % 17);
+    width[i] = 4 + static_cast<std::int32_t>(i % 12);
+    height[i] = 4 + static_cast<std::int32_t>(i % 8);
+    radius[i] = 2 + static_cast<std::int32_t>(i % 6);
+    colors[i] = bmp::Pixel(static_cast<std::uint8_t>(i), static_cast<std::uint8_t>(i >> 8), 128);
+  }
+  // Offset the circles so every one of them lies inside the bitmap
+  std::vector<std::int32_t> cx(count), cy(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    cx[i] = x[i] + 8;
+    cy[i] = y[i] + 8;
+  }
+
+  std::printf("%-40s %16s %15s\n", "primitive", "throughput", "time/call");
+  const double n = static_cast<double>(count);
+
+  bench::report("fill_rect x100k (single calls)", n, bench::measure([&] {
+    for (std::size_t i = 0; i < count; ++i) image.fill_rect(x[i], y[i], width[i], height[i], colors[i]);
+  }), "prim");
+  bench::report("fill_rects 100k (batch)", n, bench::measure([&] {
+    image.fill_rects(x.data(), y.data(), width.data(), height.data(), colors.data(), count);
+  }), "prim");
+
+  bench::report("fill_circle x100k (single calls)", n, bench::measure([&] {
+    for (std::size_t i = 0; i < count; ++i) image.fill_circle(cx[i], cy[i], radius[i], colors[i]);
+  }), "prim");
+  bench::report("fill_circles 100k (batch)", n, bench::measure([&] {
+    image.fill_circles(cx.data(), cy.data(), radius.data(), colors.data(), count);
+  }), "prim");
+
+  bench::report("draw_line x100k (single calls)", n, bench::measure([&] {
+    for (std::size_t i = 0; i < count; ++i) image.draw_line(x[i], y[i], x2[i], y2[i], colors[i]);
+  }), "prim");
+  bench::report("draw_lines 100k (batch)", n, bench::measure([&] {
+    image.draw_lines(x.data(), y.data(), x2.data(), y2.data(), colors.data(), count);
+  }), "prim");
+
+  // Synthetic 8x12 font: every printable glyph is a noisy block of ink
+  bmp::Bitmap atlas(16 * 8, 6 * 12);
+  for (std::int32_t y = 0; y < atlas.height(); ++y)
+    for (std::int32_t x = 0; x < atlas.width(); ++x)
+      if (x % 8 != 7 && y % 12 > 1 && (x * 7 + y * 13) % 5 < 3)
+        atlas.set(x, y, bmp::White);
+  const bmp::Font font(atlas.view(), 8, 12);
+  std::vector<std::string> strings(count / 10);
+  std::vector<bmp::TextLabel> labels(count / 10);
+  for (std::size_t i = 0; i < labels.size(); ++i) {
+    strings[i] = "label " + std::to_string(i);
+    labels[i] = {x[i], y[i], strings[i], colors[i], static_cast<std::uint8_t>(i % 2 == 0 ? 255 : 128)};
+  }
+  const double label_count = static_cast<double>(labels.size());
+
+  bench::report("draw_text x10k (single calls)", label_count, bench::measure([&] {
+    for (const bmp::TextLabel &label: labels) image.draw_text(font, label.x, label.y, label.text, label.color, label.opacity);
+  }), "label");
+  bench::report("draw_text 10k labels (batch)", label_count, bench::measure([&] {
+    image.draw_text(font, labels.data(), labels.size());
+  }), "label");
+
+  return 0;
+}
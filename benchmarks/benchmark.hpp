@@ -0,0 +1,32 @@
+#pragma once
+
+#include <chrono>
+#include <cstdio>
+#include <cstdint>
+
+namespace bench {
+  /**
+   * Runs `function` repeatedly for at least `min_seconds` and returns the average seconds per call
+   */
+  template<typename Function>
+  double measure(Function &&function, const double min_seconds = 0.25) {
+    using clock = std::chrono::steady_clock;
+    function(); // Warm up
+    std::uint64_t calls = 0;
+    const clock::time_point start = clock::now();
+    double elapsed = 0.0;
+    do {
+      function();
+      ++calls;
+      elapsed = std::chrono::duration<double>(clock::now() - start).count();
+    } while (elapsed < min_seconds);
+    return elapsed / static_cast<double>(calls);
+  }
+
+  /**
+   * Prints one result row: name, throughput in millions of `unit` per second and time per call
+   */
+  inline void report(const char *name, const double units_per_call, const double seconds_per_call, const char *unit = "pix") {
+    std::printf("%-40s %10.1f M%s/s %12.3f us\n", name, units_per_call / seconds_per_call / 1e6, unit, seconds_per_call * 1e6);
+  }
+}
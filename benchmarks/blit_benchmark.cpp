@@ -0,0 +1,42 @@
+#include "BitmapPlusPlus.hpp"
+#include "benchmark.hpp"
+#include <vector>
+
+// Nested get/set loop, as icons were stamped before
+static void reference_blit(bmp::Bitmap &target, const bmp::Bitmap &atlas, const bmp::Sprite &sprite, const bmp::Pixel key) {
+  for (std::int32_t j = 0; j < sprite.height; ++j)
+    for (std::int32_t i = 0; i < sprite.width; ++i) {
+      const bmp::Pixel pixel = atlas.get(sprite.source_x + i, sprite.source_y + j);
+      if (pixel != key)
+        target.set(sprite.x + i, sprite.y + j, pixel);
+    }
+}
+
+int main() {
+  constexpr std::int32_t size = 2048;
+  constexpr std::size_t count = 10000;
+  bmp::Bitmap image(size, size);
+  bmp::Bitmap atlas(512, 32);
+  atlas.clear(bmp::Magenta);
+  for (std::int32_t i = 0; i < 16; ++i)
+    atlas.fill_circle(16 + 32 * i, 16, 14, bmp::Pixel(static_cast<std::uint8_t>(16 * i), 180, 90));
+
+  std::vector<bmp::Sprite> sprites(count);
+  for (std::size_t i = 0; i < count; ++i)
+    sprites[i] = {static_cast<std::int32_t>(32 * (i % 16)), 0, 32, 32,
+                  static_cast<std::int32_t>((i * 97) % (size - 32)), static_cast<std::int32_t>((i * 61) % (size - 32))};
+  const double pixels = 32.0 * 32.0 * count;
+
+  std::printf("%-40s %16s %15s\n", "blit", "throughput", "time/call");
+  bench::report("10k keyed sprites (reference get/set)", pixels, bench::measure([&] {
+    for (const bmp::Sprite &sprite: sprites) reference_blit(image, atlas, sprite, bmp::Magenta);
+  }));
+  bench::report("10k keyed sprites (batch blit)", pixels, bench::measure([&] {
+    image.blit(atlas, sprites.data(), sprites.size(), bmp::Magenta);
+  }));
+  bench::report("10k opaque sprites (batch blit)", pixels, bench::measure([&] {
+    image.blit(atlas, sprites.data(), sprites.size());
+  }));
+
+  return 0;
+}
@@ -0,0 +1,42 @@
+#include "BitmapPlusPlus.hpp"
+#include "benchmark.hpp"
+#include <vector>
+
+// Per pixel loop through get/set with floating point blending, as overlays were composited before
+static void reference_blend(bmp::Bitmap &target, const bmp::Bitmap &source, const std::uint8_t opacity) {
+  const double a = opacity / 255.0;
+  for (std::int32_t y = 0; y < source.height(); ++y) {
+    for (std::int32_t x = 0; x < source.width(); ++x) {
+      const bmp::Pixel s = source.get(x, y), d = target.get(x, y);
+      const auto mix = [&](const std::uint8_t sc, const std::uint8_t dc) {
+        return static_cast<std::uint8_t>(dc + (sc - dc) * a + 0.5);
+      };
+      target.set(x, y, bmp::Pixel(mix(s.r, d.r), mix(s.g, d.g), mix(s.b, d.b)));
+    }
+  }
+}
+
+int main() {
+  constexpr std::int32_t size = 2048;
+  bmp::Bitmap image(size, size);
+  bmp::Bitmap overlay(size, size);
+  image.clear(bmp::Navy);
+  overlay.clear(bmp::Gold);
+  std::vector<std::uint8_t> alpha(static_cast<std::size_t>(size) * size);
+  for (std::size_t i = 0; i < alpha.size(); ++i)
+    alpha[i] = static_cast<std::uint8_t>(i * 7);
+  const double area = static_cast<double>(size) * size;
+
+  std::printf("%-40s %16s %15s\n", "composite", "throughput", "time/call");
+  bench::report("opacity 50% (reference get/set loop)", area, bench::measure([&] { reference_blend(image, overlay, 128); }));
+  bench::report("blend Normal opacity 50%", area, bench::measure([&] { image.blend(overlay.view(), 0, 0, bmp::BlendMode::Normal, 128); }));
+  bench::report("blend Normal alpha mask", area, bench::measure([&] { image.blend(overlay.view(), alpha.data(), size, 0, 0); }));
+  bench::report("blend Multiply", area, bench::measure([&] { image.blend(overlay.view(), 0, 0, bmp::BlendMode::Multiply); }));
+  bench::report("blend Screen alpha mask", area, bench::measure([&] {
+    image.blend(overlay.view(), alpha.data(), size, 0, 0, bmp::BlendMode::Screen);
+  }));
+  bench::report("blend Add", area, bench::measure([&] { image.blend(overlay.view(), 0, 0, bmp::BlendMode::Add); }));
+  bench::report("blend Normal opaque (copy)", area, bench::measure([&] { image.blend(overlay.view(), 0, 0); }));
+
+  return 0;
+}
@@ -0,0 +1,71 @@
+#include "BitmapPlusPlus.hpp"
+#include "benchmark.hpp"
+#include <cmath>
+
+// The per pixel kernel of examples/fractals/mandelbrot.cpp: one scalar double orbit, log2 and sqrt per escape
+static bmp::Pixel reference_mandelbrot(const bmp::FractalParams &params, const bmp::Bitmap &image, const std::int32_t x,
+                                       const std::int32_t y) {
+  const double step = params.width / image.width();
+  const double cr = params.center_x + (x - (image.width() - 1) / 2.0) * step;
+  const double ci = params.center_y - (y - (image.height() - 1) / 2.0) * step;
+  double zr = 0.0, zi = 0.0;
+  for (std::uint32_t i = 0; i < params.max_iterations; ++i) {
+    const double ri = zr * zi;
+    zr = zr * zr - zi * zi + cr;
+    zi = ri + ri + ci;
+    if (zr * zr + zi * zi > 4.0) {
+      const double z = std::sqrt(zr * zr + zi * zi);
+      const double t = std::log2(1.75 + i - std::log2(std::log2(z))) / std::log2(params.max_iterations);
+      return bmp::Pixel(static_cast<std::uint8_t>(255.0 * std::fmin(std::fmax(t, 0.0), 1.0)), 0, 0);
+    }
+  }
+  return bmp::Black;
+}
+
+int main() {
+  bmp::Bitmap image(1280, 960);
+  const double area = static_cast<double>(image.width()) * image.height();
+  bmp::FractalRenderer renderer;
+
+  std::printf("%-40s %16s %15s\n", "fractal 1280x960", "throughput", "time/call");
+
+  // Full set at 1000 iterations: a third of the pixels are inside and run to the limit without the checks
+  bmp::FractalParams full;
+  full.max_iterations = 1000;
+  bench::report("mandelbrot (scalar reference, generate)", area, bench::measure([&] {
+    image.generate([&](const std::int32_t x, const std::int32_t y) { return reference_mandelbrot(full, image, x, y); });
+  }));
+  bmp::FractalParams unchecked = full;
+  unchecked.periodicity_check = unchecked.interior_check = false;
+  bench::report("mandelbrot (renderer, no checks)", area, bench::measure([&] { renderer.render(image, unchecked); }));
+  bmp::FractalParams periodicity = full;
+  periodicity.interior_check = false;
+  bench::report("mandelbrot (renderer, periodicity)", area, bench::measure([&] { renderer.render(image, periodicity); }));
+  bench::report("mandelbrot (renderer, periodicity + bulbs)", area, bench::measure([&] { renderer.render(image, full); }));
+  bench::report("mandelbrot (adaptive)", area, bench::measure([&] { renderer.render_adaptive(image, full); }));
+
+  // Latency of the first preview of a progressive render: the grid lines alone, the render is cancelled from the callback
+  struct Cancel {};
+  bench::report("mandelbrot (progressive, first preview)", area, bench::measure([&] {
+    try {
+      renderer.render_progressive(image, full, [](const bmp::Bitmap &, std::int32_t) { throw Cancel{}; });
+    } catch (const Cancel &) {
+    }
+  }));
+
+  // Boundary zoom where most pixels escape late and no bulb test applies
+  bmp::FractalParams seahorse = full;
+  seahorse.center_x = -0.7453;
+  seahorse.center_y = 0.1127;
+  seahorse.width = 0.01;
+  bench::report("seahorse valley zoom (renderer)", area, bench::measure([&] { renderer.render(image, seahorse); }));
+  bench::report("seahorse valley zoom (adaptive)", area, bench::measure([&] { renderer.render_adaptive(image, seahorse); }));
+
+  bmp::FractalParams julia;
+  julia.type = bmp::FractalType::Julia;
+  julia.center_x = 0.0;
+  julia.max_iterations = 300;
+  bench::report("julia 300 (renderer)", area, bench::measure([&] { renderer.render(image, julia); }));
+
+  return 0;
+}
@@ -0,0 +1,329 @@
+#include "BitmapPlusPlus.hpp"
+#include "benchmark.hpp"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Reference loops reproducing the previous per-pixel implementations, for before/after numbers
+namespace reference {
+  void fill_rect(bmp::Bitmap &image, std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h, bmp::Pixel color) {
+    for (std::int32_t dx = x; dx < x + w; ++dx)
+      for (std::int32_t dy = y; dy < y + h; ++dy)
+        image[static_cast<std::size_t>(dy) * image.width() + dx] = color;
+  }
+
+  void clear(bmp::Bitmap &image, bmp::Pixel color) {
+    for (bmp::Pixel &pixel: image) pixel = color;
+  }
+
+  void fill_circle(bmp::Bitmap &image, std::int32_t cx, std::int32_t cy, std::int32_t radius, bmp::Pixel color) {
+    const auto span = [&](std::int32_t x1, std::int32_t x2, std::int32_t y) {
+      for (std::int32_t i = x1; i <= x2; ++i) image[static_cast<std::size_t>(y) * image.width() + i] = color;
+    };
+    std::int32_t x = radius, y = 0, err = 0;
+    while (x >= y) {
+      span(cx - x, cx + x, cy + y);
+      span(cx - x, cx + x, cy - y);
+      span(cx - y, cx + y, cy + x);
+      span(cx - y, cx + y, cy - x);
+      if (err <= 0) err += 2 * ++y + 1;
+      if (err > 0) err -= 2 * --x + 1;
+    }
+  }
+
+  // Heatmap background: the gradient position and color of every pixel computed in floating point
+  void linear_gradient(bmp::Bitmap &image, bmp::PointF from, bmp::PointF to, bmp::Pixel a, bmp::Pixel b) {
+    const float dx = to.x - from.x, dy = to.y - from.y, length2 = dx * dx + dy * dy;
+    std::size_t i = 0;
+    for (bmp::Pixel &pixel: image) {
+      const auto x = static_cast<float>(i % static_cast<std::size_t>(image.width()));
+      const auto y = static_cast<float>(i / static_cast<std::size_t>(image.width()));
+      const float t = std::clamp(((x - from.x) * dx + (y - from.y) * dy) / length2, 0.0f, 1.0f);
+      pixel = bmp::Pixel(static_cast<std::uint8_t>(a.r + (b.r - a.r) * t), static_cast<std::uint8_t>(a.g + (b.g - a.g) * t),
+                         static_cast<std::uint8_t>(a.b + (b.b - a.b) * t));
+      ++i;
+    }
+  }
+
+  void radial_gradient(bmp::Bitmap &image, bmp::PointF center, float radius, const bmp::Pixel *colormap, std::size_t size) {
+    std::size_t i = 0;
+    for (bmp::Pixel &pixel: image) {
+      const auto x = static_cast<float>(i % static_cast<std::size_t>(image.width()));
+      const auto y = static_cast<float>(i / static_cast<std::size_t>(image.width()));
+      const float t = std::hypot(x - center.x, y - center.y) / radius;
+      pixel = colormap[std::min(static_cast<std::size_t>(t * static_cast<float>(size)), size - 1)];
+      ++i;
+    }
+  }
+
+  // Bucket fill through get/set with a per-pixel stack
+  void flood_fill(bmp::Bitmap &image, std::int32_t x, std::int32_t y, bmp::Pixel color) {
+    const bmp::Pixel seed = image.get(x, y);
+    if (seed == color) return;
+    std::vector<std::pair<std::int32_t, std::int32_t> > stack{{x, y}};
+    while (!stack.empty()) {
+      const auto [px, py] = stack.back();
+      stack.pop_back();
+      if (px < 0 || py < 0 || px >= image.width() || py >= image.height() || image.get(px, py) != seed) continue;
+      image.set(px, py, color);
+      stack.push_back({px + 1, py});
+      stack.push_back({px - 1, py});
+      stack.push_back({px, py + 1});
+      stack.push_back({px, py - 1});
+    }
+  }
+}
+
+int main() {
+  constexpr std::int32_t size = 2048;
+  bmp::Bitmap image(size, size);
+  const double area = static_cast<double>(size) * size;
+
+  std::printf("%-40s %16s %15s\n", "primitive", "throughput", "time/call");
+
+  bench::report("clear (reference loop)", area, bench::measure([&] { reference::clear(image, bmp::Coral); }));
+  bench::report("clear", area, bench::measure([&] { image.clear(bmp::Coral); }));
+
+  bench::report("fill_rect 2048x2048 (reference loop)", area, bench::measure([&] { reference::fill_rect(image, 0, 0, size, size, bmp::Teal); }));
+  bench::report("fill_rect 2048x2048", area, bench::measure([&] { image.fill_rect(0, 0, size, size, bmp::Teal); }));
+
+  const double small = 64.0 * 64.0 * 256.0;
+  bench::report("fill_rect 256x 64x64 (reference loop)", small, bench::measure([&] {
+    for (std::int32_t i = 0; i < 256; ++i) reference::fill_rect(image, (i * 97) % (size - 64), (i * 61) % (size - 64), 64, 64, bmp::Gold);
+  }));
+  bench::report("fill_rect 256x 64x64", small, bench::measure([&] {
+    for (std::int32_t i = 0; i < 256; ++i) image.fill_rect((i * 97) % (size - 64), (i * 61) % (size - 64), 64, 64, bmp::Gold);
+  }));
+
+  const double disc = 3.14159265 * 1000.0 * 1000.0;
+  bench::report("fill_circle r=1000 (reference loop)", disc, bench::measure([&] { reference::fill_circle(image, 1024, 1024, 1000, bmp::Navy); }));
+  bench::report("fill_circle r=1000", disc, bench::measure([&] { image.fill_circle(1024, 1024, 1000, bmp::Navy); }));
+
+  const double dots = 3.14159265 * 6.0 * 6.0 * 100000.0;
+  bench::report("fill_circle 100k dots r=6 (reference loop)", dots, bench::measure([&] {
+    for (std::int32_t i = 0; i < 100000; ++i) reference::fill_circle(image, 8 + (i * 97) % (size - 16), 8 + (i * 61) % (size - 16), 6, bmp::Lime);
+  }));
+  bench::report("fill_circle 100k dots r=6", dots, bench::measure([&] {
+    for (std::int32_t i = 0; i < 100000; ++i) image.fill_circle(8 + (i * 97) % (size - 16), 8 + (i * 61) % (size - 16), 6, bmp::Lime);
+  }));
+
+  const double ellipse = 3.14159265 * 1000.0 * 600.0;
+  bench::report("fill_ellipse 1000x600", ellipse, bench::measure([&] { image.fill_ellipse(1024, 1024, 1000, 600, bmp::Olive); }));
+
+  const double triangle = 0.5 * 2028.0 * 2000.0;
+  bench::report("fill_triangle", triangle, bench::measure([&] { image.fill_triangle(1024, 10, 10, 2010, 2038, 2010, bmp::Crimson); }));
+
+  // Anti-aliased rasterization against the aliased versions
+  const double lines = 1e4 * size;
+  bench::report("draw_line 10k (aliased)", lines, bench::measure([&] {
+    for (std::int32_t i = 0; i < 10000; ++i) image.draw_line(i % size, 0, (i * 7) % size, size - 1, bmp::Black);
+  }));
+  bench::report("draw_line_aa 10k", lines, bench::measure([&] {
+    for (std::int32_t i = 0; i < 10000; ++i)
+      image.draw_line_aa(static_cast<float>(i % size), 0.0f, static_cast<float>((i * 7) % size), size - 1.0f, bmp::Black);
+  }));
+  bench::report("fill_circle r=1000 (aliased)", disc, bench::measure([&] { image.fill_circle(1024, 1024, 1000, bmp::Navy); }));
+  bench::report("fill_circle_aa r=1000", disc, bench::measure([&] { image.fill_circle_aa(1024.3f, 1023.6f, 1000.0f, bmp::Navy); }));
+  bench::report("fill_triangle (aliased)", triangle, bench::measure([&] { image.fill_triangle(1024, 10, 10, 2010, 2038, 2010, bmp::Crimson); }));
+  const bmp::PointF polygon[] = {{1024.0f, 10.0f}, {10.0f, 2010.0f}, {2038.0f, 2010.0f}};
+  bench::report("fill_polygon_aa triangle", triangle, bench::measure([&] { image.fill_polygon_aa(polygon, 3, bmp::Crimson); }));
+
+  // Map style polygon: a 2000 vertex wavy outline with a hole
+  std::vector<bmp::PointF> outline;
+  for (int i = 0; i < 2000; ++i) {
+    const float angle = 6.2831853f * static_cast<float>(i) / 2000.0f;
+    const float radius = 900.0f + 60.0f * std::sin(angle * 37.0f);
+    outline.push_back({1024.0f + radius * std::cos(angle), 1024.0f + radius * std::sin(angle)});
+  }
+  for (int i = 0; i < 200; ++i) {
+    const float angle = -6.2831853f * static_cast<float>(i) / 200.0f;
+    outline.push_back({1024.0f + 300.0f * std::cos(angle), 1024.0f + 300.0f * std::sin(angle)});
+  }
+  const std::size_t contours[] = {2000, 200};
+  const double map = 3.14159265 * (900.0 * 900.0 - 300.0 * 300.0);
+  bench::report("fill_polygon 2200 vertices, 2 contours", map, bench::measure([&] {
+    image.fill_polygon(outline.data(), contours, 2, bmp::Olive);
+  }));
+
+  // Bucket fill of everything outside a large circle
+  image.clear(bmp::Black);
+  image.draw_circle(1024, 1024, 700, bmp::White);
+  const double outside = area - 3.14159265 * 700.0 * 700.0;
+  bmp::Pixel bucket[2] = {bmp::Navy, bmp::Black};
+  int which = 0;
+  bench::report("flood_fill (reference get/set stack)", outside, bench::measure([&] { reference::flood_fill(image, 0, 0, bucket[which ^= 1]); }));
+  bench::report("flood_fill", outside, bench::measure([&] { image.flood_fill(0, 0, bucket[which ^= 1]); }));
+  bench::report("flood_fill tolerance 8", outside, bench::measure([&] { image.flood_fill(0, 0, bucket[which ^= 1], 8); }));
+
+  // Per pixel writes of a computed color through the checked and unchecked accessors
+  const auto shade = [](const std::int32_t x, const std::int32_t y) {
+    return bmp::Pixel(static_cast<std::uint8_t>(x), static_cast<std::uint8_t>(y), static_cast<std::uint8_t>(x ^ y));
+  };
+  bench::report("per pixel set", area, bench::measure([&] {
+    for (std::int32_t y = 0; y < size; ++y)
+      for (std::int32_t x = 0; x < size; ++x)
+        image.set(x, y, shade(x, y));
+  }));
+  bench::report("per pixel set_unchecked", area, bench::measure([&] {
+    for (std::int32_t y = 0; y < size; ++y)
+      for (std::int32_t x = 0; x < size; ++x)
+        image.set_unchecked(x, y, shade(x, y));
+  }));
+  bench::report("row pointers", area, bench::measure([&] {
+    for (bmp::PixelRow<bmp::Pixel> row: image.rows())
+      for (std::int32_t x = 0; x < row.size(); ++x)
+        row[x] = shade(x, row.y());
+  }));
+  bench::report("generate", area, bench::measure([&] { image.generate(shade); }));
+
+  // Escape time workload costing 1 to 64 iterations per pixel, serial and balanced over the thread pool
+  const auto escape = [&](const std::int32_t x, const std::int32_t y) {
+    const double cr = 3.0 * x / size - 2.0, ci = 2.4 * y / size - 1.2;
+    double zr = 0.0, zi = 0.0;
+    std::uint32_t i = 0;
+    for (; i < 64 && zr * zr + zi * zi <= 4.0; ++i) {
+      const double t = zr * zr - zi * zi + cr;
+      zi = 2.0 * zr * zi + ci;
+      zr = t;
+    }
+    return bmp::Pixel(static_cast<std::uint8_t>(i), static_cast<std::uint8_t>(i * 3), static_cast<std::uint8_t>(i * 7));
+  };
+  bench::report("escape time 64 (serial rows)", area, bench::measure([&] {
+    for (bmp::PixelRow<bmp::Pixel> row: image.rows())
+      for (std::int32_t x = 0; x < row.size(); ++x)
+        row[x] = escape(x, row.y());
+  }));
+  bench::report("escape time 64 (generate)", area, bench::measure([&] { image.generate(escape); }));
+  bmp::TileScheduler scheduler;
+  bench::report("escape time 64 (64x64 tile scheduler)", area, bench::measure([&] { scheduler.generate(image, escape); }));
+
+  // Full canvas checkerboard and tiled backgrounds
+  bench::report("checkerboard 16x16 (fill_rect per cell)", area, bench::measure([&] {
+    for (std::int32_t y = 0; y < size; y += 16)
+      for (std::int32_t x = 0; x < size; x += 16)
+        image.fill_rect(x, y, 16, 16, ((x ^ y) & 16) == 0 ? bmp::White : bmp::Black);
+  }));
+  bench::report("fill_checkerboard 16x16", area, bench::measure([&] { image.fill_checkerboard(16, 16, bmp::White, bmp::Black); }));
+  bmp::Bitmap tile(37, 23);
+  for (std::int32_t y = 0; y < tile.height(); ++y)
+    for (std::int32_t x = 0; x < tile.width(); ++x)
+      tile.set(x, y, bmp::Pixel(static_cast<std::uint8_t>(x * 7), static_cast<std::uint8_t>(y * 11), 90));
+  bench::report("tile 37x23 (reference loop)", area, bench::measure([&] {
+    for (std::int32_t y = 0; y < size; ++y)
+      for (std::int32_t x = 0; x < size; ++x)
+        image[static_cast<std::size_t>(y) * size + x] = tile.get(x % tile.width(), y % tile.height());
+  }));
+  bench::report("fill_pattern 37x23", area, bench::measure([&] { image.fill_pattern(tile); }));
+  bench::report("fill_pattern 37x23 in 2000x2000 rect", 2000.0 * 2000.0, bench::measure([&] {
+    image.fill_pattern(24, 24, 2000, 2000, tile, 5, 5);
+  }));
+
+  // Full canvas heatmap backgrounds
+  std::vector<bmp::Pixel> heat(1000);
+  for (std::size_t i = 0; i < heat.size(); ++i)
+    heat[i] = bmp::Pixel(static_cast<std::uint8_t>(std::min<std::size_t>(255, i * 3 / 4)), static_cast<std::uint8_t>(i * 255 / 999),
+                         static_cast<std::uint8_t>(255 - i * 255 / 999));
+  const bmp::PointF corner{0.0f, 0.0f}, opposite{2047.0f, 1500.0f}, middle{1024.0f, 1024.0f};
+  const bmp::Gradient ramp{bmp::Navy, bmp::Gold};
+  const bmp::Gradient heatmap{{}, {}, heat.data(), heat.size()};
+  bench::report("linear gradient (reference loop)", area, bench::measure([&] {
+    reference::linear_gradient(image, corner, opposite, bmp::Navy, bmp::Gold);
+  }));
+  bench::report("fill_linear_gradient", area, bench::measure([&] { image.fill_linear_gradient(corner, opposite, ramp); }));
+  bench::report("radial colormap (reference loop)", area, bench::measure([&] {
+    reference::radial_gradient(image, middle, 1200.0f, heat.data(), heat.size());
+  }));
+  bench::report("fill_radial_gradient colormap", area, bench::measure([&] { image.fill_radial_gradient(middle, 1200.0f, heatmap); }));
+
+  // 1M point trace stroked 3 pixels wide, against three offset 1 pixel lines per segment
+  std::vector<bmp::PointF> trace(1000000);
+  for (std::size_t i = 0; i < trace.size(); ++i) {
+    const float t = static_cast<float>(i) / static_cast<float>(trace.size());
+    trace[i] = {20.0f + 2000.0f * t, 1024.0f + 700.0f * std::sin(t * 40.0f) + 150.0f * std::sin(t * 7919.0f)};
+  }
+  const double points = static_cast<double>(trace.size());
+  bench::report("trace 1M points (draw_line offsets)", points, bench::measure([&] {
+    for (std::size_t i = 0; i + 1 < trace.size(); ++i)
+      for (std::int32_t offset = -1; offset <= 1; ++offset)
+        image.draw_line(static_cast<std::int32_t>(trace[i].x), static_cast<std::int32_t>(trace[i].y) + offset,
+                        static_cast<std::int32_t>(trace[i + 1].x), static_cast<std::int32_t>(trace[i + 1].y) + offset, bmp::Lime);
+  }), "pt");
+  bench::report("trace 1M points (draw_polyline width 3)", points, bench::measure([&] {
+    image.draw_polyline(trace.data(), trace.size(), bmp::Lime, {3.0f});
+  }), "pt");
+  bench::report("trace 1M points (width 3, round joins)", points, bench::measure([&] {
+    image.draw_polyline(trace.data(), trace.size(), bmp::Lime, {3.0f, bmp::LineJoin::Round, bmp::LineCap::Round});
+  }), "pt");
+
+  // 10k cubic curves: 64 client side draw_line calls each against one reused path, counted in 64 chords per curve
+  std::vector<bmp::PointF> controls(4 * 10000);
+  for (std::size_t i = 0; i < controls.size(); ++i)
+    controls[i] = {static_cast<float>((i * 173) % 2000) + 20.0f, static_cast<float>((i * 331) % 2000) + 20.0f};
+  const double chords = 10000.0 * 64.0;
+  bench::report("10k cubics (64 draw_line calls each)", chords, bench::measure([&] {
+    for (std::size_t c = 0; c < controls.size(); c += 4) {
+      const bmp::PointF *p = controls.data() + c;
+      std::int32_t px = static_cast<std::int32_t>(p[0].x), py = static_cast<std::int32_t>(p[0].y);
+      for (int i = 1; i <= 64; ++i) {
+        const float t = static_cast<float>(i) / 64.0f, u = 1.0f - t;
+        const auto x = static_cast<std::int32_t>(u * u * u * p[0].x + 3 * u * u * t * p[1].x + 3 * u * t * t * p[2].x + t * t * t * p[3].x);
+        const auto y = static_cast<std::int32_t>(u * u * u * p[0].y + 3 * u * u * t * p[1].y + 3 * u * t * t * p[2].y + t * t * t * p[3].y);
+        image.draw_line(px, py, x, y, bmp::Pink);
+        px = x, py = y;
+      }
+    }
+  }), "seg");
+  bmp::Path path;
+  bench::report("10k cubics (path, 2 px stroke)", chords, bench::measure([&] {
+    path.clear();
+    for (std::size_t c = 0; c < controls.size(); c += 4)
+      path.move_to(controls[c]).cubic_to(controls[c + 1], controls[c + 2], controls[c + 3]);
+    image.draw_path(path, bmp::Pink, {2.0f});
+  }), "seg");
+
+  // 100k mixed dashboard primitives, drawn immediately and through a binned display list
+  bmp::DisplayList list;
+  list.reserve(100000);
+  for (std::int32_t i = 0; i < 100000; ++i) {
+    const std::int32_t x = (i * 97) % size, y = (i * 61) % size;
+    switch (i % 3) {
+      case 0: list.fill_rect(x, y, 12, 8, bmp::Gold); break;
+      case 1: list.fill_circle(x, y, 5, bmp::Lime); break;
+      default: list.draw_line(x, y, x + 20, y + 7, bmp::White); break;
+    }
+  }
+  const auto immediate = [&] {
+    for (std::int32_t i = 0; i < 100000; ++i) {
+      const std::int32_t x = (i * 97) % size, y = (i * 61) % size;
+      switch (i % 3) {
+        case 0: image.fill_rect_clipped(x, y, 12, 8, bmp::Gold); break;
+        case 1: image.fill_circle_clipped(x, y, 5, bmp::Lime); break;
+        default: image.draw_line(x, y, x + 20, y + 7, bmp::White); break;
+      }
+    }
+  };
+  bench::report("100k mixed primitives (immediate)", 1e5, bench::measure(immediate), "prim");
+  bench::report("100k mixed primitives (display list)", 1e5, bench::measure([&] { list.render(image); }), "prim");
+
+  // Circles far larger than a 64x64 tile: every tile they touch must only rasterize its own rows of them
+  const auto large_circles = [](auto &&target) {
+    for (std::int32_t i = 0; i < 64; ++i) {
+      const std::int32_t x = (i * 389) % size, y = (i * 211) % size, radius = 500 + (i * 733) % 4000;
+      if (i % 2)
+        target.fill_circle(x, y, radius, bmp::Pixel(i * 4, 255 - i * 4, 128));
+      else
+        target.draw_circle(x, y, radius, bmp::Pixel(255, i * 4, 0));
+    }
+  };
+  bmp::DisplayList circles;
+  large_circles(circles);
+  struct Immediate {
+    bmp::Bitmap &image;
+    void fill_circle(std::int32_t x, std::int32_t y, std::int32_t r, bmp::Pixel c) { image.fill_circle_clipped(x, y, r, c); }
+    void draw_circle(std::int32_t x, std::int32_t y, std::int32_t r, bmp::Pixel c) { image.draw_circle_clipped(x, y, r, c); }
+  };
+  bench::report("64 large circles (immediate)", area, bench::measure([&] { large_circles(Immediate{image}); }));
+  bench::report("64 large circles (display list)", area, bench::measure([&] { circles.render(image); }));
+
+  return 0;
+}
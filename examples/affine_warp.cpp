@@ -0,0 +1,35 @@
+#include "BitmapPlusPlus.hpp"
+#include <filesystem>
+#include <iostream>
+
+int main() {
+  try {
+    bmp::Bitmap image;
+    image.load(std::filesystem::path(ROOT_DIR) / "images" / "penguin.bmp");
+
+    // Arbitrary angle rotation, the canvas grows to fit the rotated image
+    image.rotate(30.0, bmp::White).save(std::filesystem::path(BIN_DIR) / "penguin_rotated_30.bmp");
+
+    // Quarter turns must match the exact 90 degrees rotations
+    if (image.rotate(90.0) != image.rotate_90_right() || image.rotate(-90.0) != image.rotate_90_left()) {
+      std::cerr << "Bitmap::rotate(+-90) does not match rotate_90_right/left" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // General affine warp (shear + scale + rotation) into a preallocated destination
+    const bmp::AffineTransform transform =
+      bmp::AffineTransform::translation(image.width() / 2.0, image.height() / 2.0) *
+      bmp::AffineTransform{1.0, 0.3, 0.0, 0.0, 1.0, 0.0} *
+      bmp::AffineTransform::rotation(-10.0) *
+      bmp::AffineTransform::scaling(0.75, 0.75) *
+      bmp::AffineTransform::translation(-image.width() / 2.0, -image.height() / 2.0);
+    bmp::Bitmap warped(image.width(), image.height());
+    image.warp_affine(warped, transform, bmp::Pixel(0x25292e));
+    warped.save(std::filesystem::path(BIN_DIR) / "penguin_warped.bmp");
+
+    return EXIT_SUCCESS;
+  } catch (const bmp::Exception &e) {
+    std::cerr << "[BMP ERROR]: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
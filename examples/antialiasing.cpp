@@ -0,0 +1,70 @@
+#include "BitmapPlusPlus.hpp"
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+
+int main() {
+  try {
+    bmp::Bitmap image(400, 300);
+    image.clear(bmp::White);
+
+    // Interior pixels of an axis aligned line are fully covered
+    image.draw_line_aa(20.0f, 20.0f, 200.0f, 20.0f, bmp::Black);
+    if (image.get(100, 20) != bmp::Black || image.get(100, 19) != bmp::White || image.get(100, 21) != bmp::White) {
+      std::cerr << "Horizontal anti-aliased line is not crisp" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // A line halfway between two rows splits its coverage evenly between them
+    image.draw_line_aa(20.0f, 30.5f, 200.0f, 30.5f, bmp::Black);
+    if (image.get(100, 30) != bmp::Pixel(127, 127, 127) || image.get(100, 31) != bmp::Pixel(127, 127, 127)) {
+      std::cerr << "Half covered pixels are not blended evenly" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // A pixel aligned square polygon is exactly a filled rect
+    const bmp::PointF square[] = {{9.5f, 49.5f}, {29.5f, 49.5f}, {29.5f, 59.5f}, {9.5f, 59.5f}};
+    bmp::Bitmap expected = image;
+    expected.fill_rect(10, 50, 20, 10, bmp::Red);
+    image.fill_polygon_aa(square, 4, bmp::Red);
+    if (image != expected) {
+      std::cerr << "Pixel aligned polygon differs from fill_rect" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // The coverage of a filled circle adds up to its area
+    bmp::Bitmap disc(128, 128);
+    disc.fill_circle_aa(63.3f, 64.7f, 40.0f, bmp::White);
+    double area = 0.0;
+    for (const bmp::Pixel &pixel: disc)
+      area += pixel.r / 255.0;
+    const double exact = 3.14159265358979 * 40.0 * 40.0;
+    if (std::abs(area - exact) > exact * 0.005) {
+      std::cerr << "Circle coverage " << area << " differs from its area " << exact << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // A star polygon clipped by the image borders
+    bmp::PointF star[10];
+    for (int i = 0; i < 10; ++i) {
+      const float angle = 3.14159265f * static_cast<float>(i) / 5.0f;
+      const float radius = (i % 2 == 0) ? 120.0f : 50.0f;
+      star[i] = {330.0f + radius * std::sin(angle), 90.0f - radius * std::cos(angle)};
+    }
+    image.fill_polygon_aa(star, 10, bmp::Navy);
+
+    for (int i = 0; i < 12; ++i) {
+      const float angle = 3.14159265f * static_cast<float>(i) / 12.0f;
+      image.draw_line_aa(120.0f, 200.0f, 120.0f + 90.0f * std::cos(angle), 200.0f + 90.0f * std::sin(angle), bmp::Crimson);
+    }
+    image.fill_circle_aa(300.5f, 230.25f, 40.0f, bmp::Teal);
+    image.draw_circle_aa(300.5f, 230.25f, 55.0f, bmp::Black);
+    image.draw_circle_aa(0.0f, 300.0f, 80.0f, bmp::Green);
+    image.save(std::filesystem::path(BIN_DIR) / "antialiasing.bmp");
+
+    return EXIT_SUCCESS;
+  } catch (const bmp::Exception &e) {
+    std::cerr << "[BMP ERROR]: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,77 @@
+#include "BitmapPlusPlus.hpp"
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Structure of arrays geometry, as produced by charting code
+struct Batch {
+  std::vector<std::int32_t> a, b, c, d;
+  std::vector<bmp::Pixel> colors;
+};
+
+static Batch random_batch(std::mt19937 &rng, const std::size_t count, const std::int32_t lo, const std::int32_t hi,
+                          const std::int32_t max_size) {
+  std::uniform_int_distribution<std::int32_t> position(lo, hi);
+  std::uniform_int_distribution<std::int32_t> size(1, max_size);
+  std::uniform_int_distribution<int> channel(0, 255);
+  Batch batch;
+  for (std::size_t i = 0; i < count; ++i) {
+    batch.a.push_back(position(rng));
+    batch.b.push_back(position(rng));
+    batch.c.push_back(size(rng));
+    batch.d.push_back(position(rng));
+    batch.colors.emplace_back(static_cast<std::uint8_t>(channel(rng)), static_cast<std::uint8_t>(channel(rng)),
+                              static_cast<std::uint8_t>(channel(rng)));
+  }
+  return batch;
+}
+
+int main() {
+  try {
+    std::mt19937 rng(35);
+    bmp::Bitmap image(400, 400);
+
+    // Batches entirely inside the bitmap (unchecked path) and reaching outside it (clipped path)
+    // produce the same pixels as the equivalent single calls
+    for (const std::int32_t margin: {0, 60}) {
+      const Batch rects = random_batch(rng, 300, 40 - margin, 300 + margin, 40);
+      const Batch circles = random_batch(rng, 300, 40 - margin, 340 + margin, 30);
+      const Batch lines = random_batch(rng, 300, 0 - margin, 399 + margin, 40);
+      const std::size_t n = rects.colors.size();
+
+      bmp::Bitmap expected(400, 400);
+      for (std::size_t i = 0; i < n; i += 100) {
+        for (std::size_t j = i; j < i + 100; ++j)
+          expected.fill_rect_clipped(rects.a[j], rects.b[j], rects.c[j], rects.c[j] / 2 + 1, rects.colors[j]);
+        for (std::size_t j = i; j < i + 100; ++j)
+          expected.fill_circle_clipped(circles.a[j], circles.b[j], circles.c[j], bmp::Gold);
+        for (std::size_t j = i; j < i + 100; ++j)
+          expected.draw_line(lines.a[j], lines.b[j], lines.d[j], lines.a[(j + 1) % n], lines.colors[j]);
+      }
+
+      std::vector<std::int32_t> heights;
+      for (const std::int32_t width: rects.c)
+        heights.push_back(width / 2 + 1);
+      image.clear();
+      for (std::size_t i = 0; i < n; i += 100) {
+        image.fill_rects(&rects.a[i], &rects.b[i], &rects.c[i], &heights[i], &rects.colors[i], 100);
+        image.fill_circles(&circles.a[i], &circles.b[i], &circles.c[i], bmp::Gold, 100);
+        std::vector<std::int32_t> y2(100);
+        for (std::size_t j = 0; j < 100; ++j)
+          y2[j] = lines.a[(i + j + 1) % n];
+        image.draw_lines(&lines.a[i], &lines.b[i], &lines.d[i], y2.data(), &lines.colors[i], 100);
+      }
+      if (image != expected) {
+        std::cerr << "Batched primitives differ from single calls (margin " << margin << ")" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+    image.save(std::filesystem::path(BIN_DIR) / "batch_primitives.bmp");
+
+    return EXIT_SUCCESS;
+  } catch (const bmp::Exception &e) {
+    std::cerr << "[BMP ERROR]: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -9,13 +9,20 @@ int main() {
     bmp::Bitmap image(512, 512);
 
     std::random_device seed{};
-    std::default_random_engine eng{seed()};
-    std::bernoulli_distribution dist(0.10); // 10% White, 90% Black
+    const std::uint32_t image_seed = seed();
 
-    for (bmp::Pixel& pixel: image) {
-      const bmp::Pixel color = dist(eng) ? bmp::White : bmp::Black;
-      pixel = color;
-    }
+    // Rows are filled in parallel, each from its own engine seeded by the image seed and the row index,
+    // so the image only depends on image_seed and not on the thread count
+    image.for_each_row([&](const bmp::PixelRow<bmp::Pixel> row) {
+      std::seed_seq row_seed{image_seed, static_cast<std::uint32_t>(row.y())};
+      std::default_random_engine eng{row_seed};
+      std::bernoulli_distribution dist(0.10); // 10% White, 90% Black
+
+      for (bmp::Pixel& pixel: row) {
+        const bmp::Pixel color = dist(eng) ? bmp::White : bmp::Black;
+        pixel = color;
+      }
+    });
 
     image.save(std::filesystem::path(BIN_DIR) / "bernoulli.bmp");
 
@@ -6,22 +6,12 @@ int main() {
   try {
     // 8x8 chess board
     bmp::Bitmap image(640, 640);
-    const std::size_t board_dims = 8;
+    const std::int32_t board_dims = 8;
     const std::int32_t rect_w = image.width() / board_dims;
     const std::int32_t rect_h = image.height() / board_dims;
 
-    // Iterate over rects
-    bool is_white = true;
-    for (std::size_t x = 0; x < image.width(); x += rect_w) {
-      for (std::size_t y = 0; y < image.height(); y += rect_h) {
-        const bmp::Pixel color = is_white ? bmp::White : bmp::Black;
-        // Fill rect
-        image.fill_rect(x, y, rect_w, rect_h, color);
-        // Next rect in will be the opposite color
-        is_white = !is_white;
-      }
-      is_white = !is_white;
-    }
+    // White top left square, each row of squares built once and copied down
+    image.fill_checkerboard(rect_w, rect_h, bmp::White, bmp::Black);
 
     // Save bitmap to file
     image.save(std::filesystem::path(BIN_DIR) / "chess_board.bmp");
@@ -0,0 +1,159 @@
+#include "BitmapPlusPlus.hpp"
+#include <filesystem>
+#include <iostream>
+#include <limits>
+#include <random>
+
+// Reference Bresenham which plots only the pixels that fall inside the image
+static void reference_line(bmp::Bitmap &image, std::int32_t x1, std::int32_t y1, const std::int32_t x2,
+                           const std::int32_t y2, const bmp::Pixel color) {
+  const std::int32_t dx = std::abs(x2 - x1);
+  const std::int32_t dy = std::abs(y2 - y1);
+  const std::int32_t sx = (x1 < x2) ? 1 : -1;
+  const std::int32_t sy = (y1 < y2) ? 1 : -1;
+  std::int32_t err = dx - dy;
+  while (true) {
+    if (x1 >= 0 && y1 >= 0 && x1 < image.width() && y1 < image.height())
+      image.set(x1, y1, color);
+    if (x1 == x2 && y1 == y2)
+      break;
+    const std::int32_t e2 = 2 * err;
+    if (e2 > -dy) {
+      err -= dy;
+      x1 += sx;
+    }
+    if (e2 < dx) {
+      err += dx;
+      y1 += sy;
+    }
+  }
+}
+
+// Reference midpoint circle which plots only the pixels that fall inside the image
+static void reference_circle(bmp::Bitmap &image, const std::int32_t center_x, const std::int32_t center_y,
+                             const std::int32_t radius, const bmp::Pixel color) {
+  const auto plot = [&](const std::int32_t x, const std::int32_t y) {
+    if (x >= 0 && y >= 0 && x < image.width() && y < image.height())
+      image.set(x, y, color);
+  };
+  std::int32_t x = radius, y = 0, err = 0;
+  while (x >= y) {
+    plot(center_x + x, center_y + y);
+    plot(center_x + y, center_y + x);
+    plot(center_x - y, center_y + x);
+    plot(center_x - x, center_y + y);
+    plot(center_x - x, center_y - y);
+    plot(center_x - y, center_y - x);
+    plot(center_x + y, center_y - x);
+    plot(center_x + x, center_y - y);
+    if (err <= 0) {
+      y += 1;
+      err += 2 * y + 1;
+    }
+    if (err > 0) {
+      x -= 1;
+      err -= 2 * x + 1;
+    }
+  }
+}
+
+int main() {
+  try {
+    // Lines reaching far outside the image are clipped to exactly the pixels Bresenham would plot inside it
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<std::int32_t> coordinate(-200, 400);
+    bmp::Bitmap expected(200, 150);
+    bmp::Bitmap actual(200, 150);
+    for (int i = 0; i < 2000; ++i) {
+      const std::int32_t x1 = coordinate(rng), y1 = coordinate(rng), x2 = coordinate(rng), y2 = coordinate(rng);
+      const bmp::Pixel color(static_cast<std::uint8_t>(i), static_cast<std::uint8_t>(i >> 3), 200);
+      reference_line(expected, x1, y1, x2, y2, color);
+      actual.draw_line(x1, y1, x2, y2, color);
+    }
+    if (actual != expected) {
+      std::cerr << "Clipped lines differ from the reference" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Circle outlines crossing the image edges keep exactly the reference pixels inside it
+    std::uniform_int_distribution<std::int32_t> radii(0, 300);
+    for (int i = 0; i < 2000; ++i) {
+      const std::int32_t x = coordinate(rng), y = coordinate(rng), r = radii(rng);
+      const bmp::Pixel color(static_cast<std::uint8_t>(i), 90, static_cast<std::uint8_t>(i >> 3));
+      reference_circle(expected, x, y, r, color);
+      actual.draw_circle_clipped(x, y, r, color);
+    }
+    if (actual != expected) {
+      std::cerr << "Clipped circles differ from the reference" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // A rect hanging over the top left corner only colors its visible quarter
+    bmp::Bitmap image(120, 80);
+    image.fill_rect_clipped(-10, -10, 20, 20, bmp::Red);
+    std::size_t red = 0;
+    for (const bmp::Pixel &pixel: image)
+      red += pixel == bmp::Red;
+    if (red != 100 || image.get(9, 9) != bmp::Red || image.get(10, 10) != bmp::Black) {
+      std::cerr << "fill_rect_clipped colored " << red << " pixels" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Shapes partially (or entirely) outside the image never throw
+    image.fill_circle_clipped(110, 70, 30, bmp::Blue);
+    image.draw_circle_clipped(0, 40, 25, bmp::Yellow);
+    image.fill_ellipse_clipped(60, -5, 40, 15, bmp::Green);
+    image.fill_annulus_clipped(60, 85, 10, 20, bmp::Orange);
+    image.fill_triangle_clipped(-50, 70, 70, 30, 40, 200, bmp::Purple);
+    image.draw_triangle_clipped(-50, 70, 70, 30, 40, 200, bmp::White);
+    image.draw_rect_clipped(80, -20, 60, 50, bmp::Cyan);
+    image.fill_circle_clipped(1000, 1000, 5, bmp::Red);
+    image.save(std::filesystem::path(BIN_DIR) / "clipping.bmp");
+
+    // Radii far larger than the bitmap cover it exactly where the ellipse says, without overflowing
+    bmp::Bitmap large(64, 64);
+    large.fill_ellipse_clipped(32, 32, 40000, 40000, bmp::Red);
+    large.fill_ellipse_clipped(32 - 40000, 32, 40000, 40000, bmp::Green);
+    large.fill_ellipse_clipped(32, 0, std::numeric_limits<std::int32_t>::max(), 0, bmp::Blue);
+    for (std::int32_t y = 0; y < large.height(); ++y) {
+      for (std::int32_t x = 0; x < large.width(); ++x) {
+        const bmp::Pixel expected = y == 0 ? bmp::Blue : x <= 32 ? bmp::Green : bmp::Red;
+        if (large.get(x, y) != expected) {
+          std::cerr << "Large ellipse is wrong at " << x << ", " << y << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+    }
+
+    // Huge circles visit only their visible rows, and each row of the fill ends where the outline is drawn
+    bmp::Bitmap huge(64, 64);
+    const std::int32_t radius = 50'000'000;
+    huge.fill_circle_clipped(32 - radius, 32, radius, bmp::Red);
+    huge.draw_circle_clipped(32 - radius, 32, radius, bmp::Blue);
+    huge.fill_annulus_clipped(32, 7 - radius, radius - 8, radius, bmp::Green);
+    huge.fill_circle_clipped(32, std::numeric_limits<std::int32_t>::max() - 647, 1000, bmp::Yellow);
+    for (std::int32_t y = 8; y < huge.height(); ++y) {
+      std::int32_t edge = huge.width() - 1;
+      while (edge > 0 && huge.get(edge, y) == bmp::Black)
+        --edge;
+      bool solid = huge.get(edge, y) == bmp::Blue;
+      for (std::int32_t x = 0; x < edge; ++x)
+        solid = solid && huge.get(x, y) == bmp::Red;
+      if (!solid || edge < 30 || edge > 32) {
+        std::cerr << "Huge circle is wrong on row " << y << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+    for (std::int32_t y = 0; y < 8; ++y) {
+      if (huge.get(32, y) != bmp::Green) {
+        std::cerr << "Huge ring is wrong on row " << y << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    return EXIT_SUCCESS;
+  } catch (const bmp::Exception &e) {
+    std::cerr << "[BMP ERROR]: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
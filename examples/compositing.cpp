@@ -0,0 +1,98 @@
+#include "BitmapPlusPlus.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// x / 255 rounded to nearest
+static int round255(const int x) { return (2 * x + 255) / 510; }
+
+static int reference_mode(const bmp::BlendMode mode, const int s, const int d) {
+  switch (mode) {
+    case bmp::BlendMode::Normal: return s;
+    case bmp::BlendMode::Add: return std::min(s + d, 255);
+    case bmp::BlendMode::Subtract: return std::max(d - s, 0);
+    case bmp::BlendMode::Multiply: return round255(s * d);
+    case bmp::BlendMode::Screen: return 255 - round255((255 - s) * (255 - d));
+    case bmp::BlendMode::Darken: return std::min(s, d);
+    case bmp::BlendMode::Lighten: return std::max(s, d);
+    default: return std::abs(s - d);
+  }
+}
+
+static bmp::Bitmap random_bitmap(std::mt19937 &rng, const std::int32_t width, const std::int32_t height) {
+  std::uniform_int_distribution<int> channel(0, 255);
+  bmp::Bitmap image(width, height);
+  for (bmp::Pixel &pixel: image)
+    pixel = bmp::Pixel(static_cast<std::uint8_t>(channel(rng)), static_cast<std::uint8_t>(channel(rng)),
+                       static_cast<std::uint8_t>(channel(rng)));
+  return image;
+}
+
+int main() {
+  try {
+    std::mt19937 rng(37);
+    const bmp::Bitmap source = random_bitmap(rng, 53, 21);
+    const bmp::Bitmap background = random_bitmap(rng, 60, 40);
+    std::vector<std::uint8_t> alpha(53 * 21);
+    for (std::uint8_t &a: alpha)
+      a = static_cast<std::uint8_t>(rng());
+
+    // Every mode matches a scalar reference with exact rounding, including the clipped edges
+    for (const bmp::BlendMode mode: {bmp::BlendMode::Normal, bmp::BlendMode::Add, bmp::BlendMode::Subtract,
+                                     bmp::BlendMode::Multiply, bmp::BlendMode::Screen, bmp::BlendMode::Darken,
+                                     bmp::BlendMode::Lighten, bmp::BlendMode::Difference}) {
+      for (const bool masked: {false, true}) {
+        const std::int32_t x = -7, y = 25;
+        const std::uint8_t opacity = 200;
+        bmp::Bitmap image = background;
+        if (masked)
+          image.blend(source.view(), alpha.data(), 53, x, y, mode, opacity);
+        else
+          image.blend(source.view(), x, y, mode, opacity);
+
+        for (std::int32_t j = 0; j < 40; ++j) {
+          for (std::int32_t i = 0; i < 60; ++i) {
+            bmp::Pixel expected = background.get(i, j);
+            const std::int32_t sx = i - x, sy = j - y;
+            if (sx >= 0 && sy >= 0 && sx < 53 && sy < 21) {
+              const int a = masked ? round255(alpha[sy * 53 + sx] * opacity) : opacity;
+              const bmp::Pixel s = source.get(sx, sy), d = background.get(i, j);
+              const auto mix = [&](const int sc, const int dc) {
+                return static_cast<std::uint8_t>(round255(dc * (255 - a) + reference_mode(mode, sc, dc) * a));
+              };
+              expected = bmp::Pixel(mix(s.r, d.r), mix(s.g, d.g), mix(s.b, d.b));
+            }
+            if (image.get(i, j) != expected) {
+              std::cerr << "Blend mode " << static_cast<int>(mode) << " differs at " << i << ", " << j << std::endl;
+              return EXIT_FAILURE;
+            }
+          }
+        }
+      }
+    }
+
+    // Opaque normal blending is a plain copy
+    bmp::Bitmap copy(53, 21);
+    copy.blend(source.view(), 0, 0);
+    if (copy != source) {
+      std::cerr << "Opaque blend is not a copy" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Overlay a translucent, multiplied and screened copy of the penguin onto itself
+    bmp::Bitmap image;
+    image.load(std::filesystem::path(ROOT_DIR) / "images" / "penguin.bmp");
+    const bmp::Bitmap overlay = image.transform().flip_h().to_bitmap();
+    image.blend(overlay.view(), image.width() / 3, 0, bmp::BlendMode::Normal, 128);
+    image.blend(overlay.view(), -image.width() / 2, image.height() / 2, bmp::BlendMode::Multiply);
+    image.blend(overlay.view(), image.width() / 2, -image.height() / 2, bmp::BlendMode::Screen);
+    image.save(std::filesystem::path(BIN_DIR) / "penguin_composited.bmp");
+
+    return EXIT_SUCCESS;
+  } catch (const bmp::Exception &e) {
+    std::cerr << "[BMP ERROR]: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
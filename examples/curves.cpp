@@ -0,0 +1,125 @@
+#include "BitmapPlusPlus.hpp"
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Distance from (x, y) to the polyline through `points`
+static double polyline_distance(const std::vector<bmp::PointF> &points, const double x, const double y) {
+  double best = std::hypot(x - points[0].x, y - points[0].y);
+  for (std::size_t i = 0; i + 1 < points.size(); ++i) {
+    const double ax = points[i].x, ay = points[i].y;
+    const double dx = points[i + 1].x - ax, dy = points[i + 1].y - ay;
+    const double length2 = dx * dx + dy * dy;
+    const double t = length2 > 0.0 ? std::clamp(((x - ax) * dx + (y - ay) * dy) / length2, 0.0, 1.0) : 0.0;
+    best = std::min(best, std::hypot(x - ax - t * dx, y - ay - t * dy));
+  }
+  return best;
+}
+
+int main() {
+  try {
+    // Flattened curves stay within the tolerance of the exact curve
+    std::mt19937 rng(43);
+    std::uniform_real_distribution<float> coordinate(-200.0f, 600.0f);
+    for (int test = 0; test < 200; ++test) {
+      const bmp::PointF p[4] = {{coordinate(rng), coordinate(rng)}, {coordinate(rng), coordinate(rng)},
+                                {coordinate(rng), coordinate(rng)}, {coordinate(rng), coordinate(rng)}};
+      const float tolerance = test % 2 == 0 ? 0.25f : 2.0f;
+      bmp::Path path(tolerance);
+      const bool cubic = test % 4 < 2;
+      if (cubic)
+        path.move_to(p[0]).cubic_to(p[1], p[2], p[3]);
+      else
+        path.move_to(p[0]).quad_to(p[1], p[3]);
+      const std::vector<bmp::PointF> &points = path.points();
+      if (points.size() > 400 || points.back().x != p[3].x || points.back().y != p[3].y) {
+        std::cerr << "Curve " << test << " has " << points.size() << " points or a wrong end" << std::endl;
+        return EXIT_FAILURE;
+      }
+      for (int i = 0; i <= 1000; ++i) {
+        const double t = i / 1000.0, u = 1.0 - t;
+        double x, y;
+        if (cubic) {
+          x = u * u * u * p[0].x + 3 * u * u * t * p[1].x + 3 * u * t * t * p[2].x + t * t * t * p[3].x;
+          y = u * u * u * p[0].y + 3 * u * u * t * p[1].y + 3 * u * t * t * p[2].y + t * t * t * p[3].y;
+        } else {
+          x = u * u * p[0].x + 2 * u * t * p[1].x + t * t * p[3].x;
+          y = u * u * p[0].y + 2 * u * t * p[1].y + t * t * p[3].y;
+        }
+        if (polyline_distance(points, x, y) > tolerance + 1e-3) {
+          std::cerr << "Curve " << test << " strays from its flattening at t = " << t << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+    }
+
+    // Straight curves need a single chord
+    bmp::Path straight;
+    straight.move_to({0, 0}).cubic_to({10, 10}, {20, 20}, {30, 30});
+    if (straight.points().size() != 2) {
+      std::cerr << "A straight cubic was split into " << straight.points().size() - 1 << " chords" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // A full elliptical arc filled as a path covers the pixel centers inside the ellipse
+    bmp::Bitmap ellipse(120, 80);
+    bmp::Path outline;
+    outline.arc({60.0f, 40.0f}, 50.0f, 30.0f, 0.0f, 360.0f).close();
+    ellipse.fill_path(outline, bmp::White);
+    for (std::int32_t y = 0; y < ellipse.height(); ++y) {
+      for (std::int32_t x = 0; x < ellipse.width(); ++x) {
+        const double dx = (x - 60.0) / 50.0, dy = (y - 40.0) / 30.0;
+        const double radius = std::sqrt(dx * dx + dy * dy);
+        const bool filled = ellipse.get(x, y) == bmp::White;
+        if ((radius < 1.0 - 0.3 / 30.0 && !filled) || (radius > 1.0 + 1e-4 && filled)) {
+          std::cerr << "Filled ellipse is wrong at " << x << ", " << y << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+    }
+
+    // Rotated quarter arcs end where the ellipse says they do
+    bmp::Path quarter;
+    quarter.arc({0.0f, 0.0f}, 40.0f, 20.0f, 0.0f, 90.0f, 90.0f);
+    const bmp::PointF start = quarter.points().front(), end = quarter.points().back();
+    if (std::abs(start.x) > 1e-4f || std::abs(start.y - 40.0f) > 1e-4f || std::abs(end.x + 20.0f) > 1e-4f || std::abs(end.y) > 1e-4f) {
+      std::cerr << "Rotated arc runs from " << start.x << ", " << start.y << " to " << end.x << ", " << end.y << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Stroking a path equals stroking its flattened points, and clearing keeps the capacity
+    bmp::Path wave;
+    wave.move_to({10, 60}).cubic_to({60, -20}, {110, 140}, {160, 60}).quad_to({200, 10}, {230, 60});
+    bmp::Bitmap stroked(240, 120), expected(240, 120);
+    const bmp::StrokeStyle style{6.0f, bmp::LineJoin::Round, bmp::LineCap::Round};
+    stroked.draw_path(wave, bmp::Gold, style);
+    expected.draw_polyline(wave.points().data(), wave.points().size(), bmp::Gold, style);
+    const std::size_t capacity = wave.points().capacity();
+    wave.clear();
+    wave.move_to({10, 60}).cubic_to({60, -20}, {110, 140}, {160, 60}).quad_to({200, 10}, {230, 60});
+    if (stroked != expected || wave.points().capacity() != capacity) {
+      std::cerr << "Stroked path differs from its polyline or reallocated" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    bmp::Bitmap image(320, 200);
+    image.clear(bmp::Pixel(20, 24, 36));
+    bmp::Path pie;
+    pie.move_to({90, 100}).arc({90, 100}, 70, 70, -30, 240).close();
+    image.fill_path(pie, bmp::Teal);
+    bmp::Path heart;
+    heart.move_to({230, 170}).cubic_to({140, 100}, {190, 30}, {230, 80}).cubic_to({270, 30}, {320, 100}, {230, 170}).close();
+    image.fill_path(heart, bmp::Crimson);
+    image.draw_path(heart, bmp::White, {3.0f, bmp::LineJoin::Round});
+    image.draw_path(pie, bmp::White, {3.0f, bmp::LineJoin::Miter});
+    image.save(std::filesystem::path(BIN_DIR) / "curves.bmp");
+
+    return EXIT_SUCCESS;
+  } catch (const bmp::Exception &e) {
+    std::cerr << "[BMP ERROR]: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
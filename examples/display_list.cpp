@@ -0,0 +1,89 @@
+#include "BitmapPlusPlus.hpp"
+#include <filesystem>
+#include <iostream>
+#include <random>
+
+int main() {
+  try {
+    constexpr std::int32_t width = 640;
+    constexpr std::int32_t height = 480;
+    std::mt19937 rng(34);
+    std::uniform_int_distribution<std::int32_t> x_dist(-100, width + 100);
+    std::uniform_int_distribution<std::int32_t> y_dist(-100, height + 100);
+    std::uniform_int_distribution<std::int32_t> size_dist(0, 150);
+    std::uniform_int_distribution<int> kind_dist(0, 6);
+    std::uniform_int_distribution<int> color_dist(0, 255);
+
+    // Record a scene, drawing it immediately at the same time for comparison
+    bmp::DisplayList list;
+    bmp::Bitmap expected(width, height);
+    for (int i = 0; i < 5000; ++i) {
+      const bmp::Pixel color(static_cast<std::uint8_t>(color_dist(rng)), static_cast<std::uint8_t>(color_dist(rng)),
+                             static_cast<std::uint8_t>(color_dist(rng)));
+      const std::int32_t x1 = x_dist(rng), y1 = y_dist(rng), x2 = x_dist(rng), y2 = y_dist(rng);
+      const std::int32_t x3 = x_dist(rng), y3 = y_dist(rng), size = size_dist(rng);
+      switch (kind_dist(rng)) {
+        case 0:
+          list.draw_line(x1, y1, x2, y2, color);
+          expected.draw_line(x1, y1, x2, y2, color);
+          break;
+        case 1:
+          list.fill_rect(x1, y1, size, size / 2, color);
+          expected.fill_rect_clipped(x1, y1, size, size / 2, color);
+          break;
+        case 2:
+          list.draw_rect(x1, y1, size, size, color);
+          expected.draw_rect_clipped(x1, y1, size, size, color);
+          break;
+        case 3:
+          list.fill_triangle(x1, y1, x2, y2, x3, y3, color);
+          expected.fill_triangle_clipped(x1, y1, x2, y2, x3, y3, color);
+          break;
+        case 4:
+          list.draw_triangle(x1, y1, x2, y2, x3, y3, color);
+          expected.draw_triangle_clipped(x1, y1, x2, y2, x3, y3, color);
+          break;
+        case 5:
+          list.fill_circle(x1, y1, size / 3, color);
+          expected.fill_circle_clipped(x1, y1, size / 3, color);
+          break;
+        default:
+          list.draw_circle(x1, y1, size, color);
+          expected.draw_circle_clipped(x1, y1, size, color);
+          break;
+      }
+    }
+
+    // Tiles are rasterized in parallel but keep the recording order
+    bmp::Bitmap image(width, height);
+    list.render(image);
+    if (image != expected) {
+      std::cerr << "Display list output differs from immediate drawing" << std::endl;
+      return EXIT_FAILURE;
+    }
+    image.save(std::filesystem::path(BIN_DIR) / "display_list.bmp");
+
+    // Circles spanning thousands of tiles are cut to each tile's rows and still match immediate drawing
+    bmp::DisplayList large;
+    bmp::Bitmap large_expected(width, height);
+    for (std::int32_t i = 0; i < 16; ++i) {
+      const bmp::Pixel color(static_cast<std::uint8_t>(i * 16), 255, static_cast<std::uint8_t>(255 - i * 16));
+      const std::int32_t radius = 1000 << i, x = width / 2 - radius + (i * 37) % 300, y = (i * 53) % height;
+      large.fill_circle(x, y, radius, color);
+      large.draw_circle(x + 40, y, radius, bmp::White);
+      large_expected.fill_circle_clipped(x, y, radius, color);
+      large_expected.draw_circle_clipped(x + 40, y, radius, bmp::White);
+    }
+    bmp::Bitmap large_image(width, height);
+    large.render(large_image);
+    if (large_image != large_expected) {
+      std::cerr << "Display list output differs from immediate drawing for large circles" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+  } catch (const bmp::Exception &e) {
+    std::cerr << "[BMP ERROR]: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
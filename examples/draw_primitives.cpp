@@ -28,6 +28,10 @@ int main() {
   // Draw a filled Lime circle in position (300, 170) with 50 pixels radius
   image.fill_circle(420, 170, 50, Lime);
 
+  /** Ellipse and ring **/
+  image.fill_ellipse(330, 25, 60, 15, Orange);
+  image.fill_annulus(480, 90, 10, 20, Teal);
+
   // Save bitmap
   image.save(std::filesystem::path(BIN_DIR) / "primitives.bmp");
 
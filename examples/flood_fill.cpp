@@ -0,0 +1,88 @@
+#include "BitmapPlusPlus.hpp"
+#include <filesystem>
+#include <iostream>
+#include <queue>
+#include <random>
+#include <utility>
+#include <vector>
+
+// Breadth first reference fill over every pixel whose channels are within `tolerance` of the seed
+static bmp::Bitmap reference_fill(const bmp::Bitmap &source, const std::int32_t x, const std::int32_t y,
+                                  const bmp::Pixel color, const int tolerance, const bool eight) {
+  bmp::Bitmap image = source;
+  const bmp::Pixel seed = source.get(x, y);
+  const auto near = [&](const bmp::Pixel &p) {
+    return std::abs(p.r - seed.r) <= tolerance && std::abs(p.g - seed.g) <= tolerance && std::abs(p.b - seed.b) <= tolerance;
+  };
+  std::vector<bool> seen(static_cast<std::size_t>(source.width()) * source.height());
+  std::queue<std::pair<std::int32_t, std::int32_t> > queue;
+  queue.emplace(x, y);
+  seen[static_cast<std::size_t>(y) * source.width() + x] = true;
+  while (!queue.empty()) {
+    const auto [px, py] = queue.front();
+    queue.pop();
+    image.set(px, py, color);
+    for (std::int32_t dy = -1; dy <= 1; ++dy) {
+      for (std::int32_t dx = -1; dx <= 1; ++dx) {
+        if ((dx == 0 && dy == 0) || (!eight && dx != 0 && dy != 0))
+          continue;
+        const std::int32_t nx = px + dx, ny = py + dy;
+        if (nx < 0 || ny < 0 || nx >= source.width() || ny >= source.height())
+          continue;
+        const std::size_t i = static_cast<std::size_t>(ny) * source.width() + nx;
+        if (!seen[i] && near(source.get(nx, ny))) {
+          seen[i] = true;
+          queue.emplace(nx, ny);
+        }
+      }
+    }
+  }
+  return image;
+}
+
+int main() {
+  try {
+    // Noisy two tone images give maze like regions with diagonal only connections
+    std::mt19937 rng(40);
+    for (int test = 0; test < 40; ++test) {
+      bmp::Bitmap image(97, 61);
+      for (bmp::Pixel &pixel: image) {
+        const auto shade = static_cast<std::uint8_t>(rng() % 100 < 55 ? 20 + rng() % 8 : 200);
+        pixel = bmp::Pixel(shade, shade, shade);
+      }
+      const std::int32_t x = static_cast<std::int32_t>(rng() % 97), y = static_cast<std::int32_t>(rng() % 61);
+      const bool eight = test % 2 == 1;
+      const bmp::Connectivity connectivity = eight ? bmp::Connectivity::Eight : bmp::Connectivity::Four;
+
+      bmp::Bitmap exact = image;
+      exact.flood_fill(x, y, bmp::Red, connectivity);
+      bmp::Bitmap tolerant = image;
+      tolerant.flood_fill(x, y, bmp::Red, 10, connectivity);
+      if (exact != reference_fill(image, x, y, bmp::Red, 0, eight) ||
+          tolerant != reference_fill(image, x, y, bmp::Red, 10, eight)) {
+        std::cerr << "Flood fill " << test << " differs from the breadth first reference" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    // Large regions need only a small span stack
+    bmp::Bitmap large(2048, 2048);
+    large.draw_circle(1024, 1024, 700, bmp::White);
+    const std::size_t outside = large.flood_fill(0, 0, bmp::Navy);
+    const std::size_t inside = large.flood_fill(1024, 1024, bmp::Gold, 0, bmp::Connectivity::Four);
+    if (outside + inside + 1 > 2048u * 2048u || inside < 1500000) {
+      std::cerr << "Unexpected region sizes " << outside << " and " << inside << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    bmp::Bitmap shapes;
+    shapes.load(std::filesystem::path(ROOT_DIR) / "images" / "shapes.bmp");
+    shapes.flood_fill(0, 0, bmp::Lavender, 30);
+    shapes.save(std::filesystem::path(BIN_DIR) / "flood_fill.bmp");
+
+    return EXIT_SUCCESS;
+  } catch (const bmp::Exception &e) {
+    std::cerr << "[BMP ERROR]: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,103 @@
+#include "BitmapPlusPlus.hpp"
+#include "fractals/color_maps.inl"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+
+// Scalar escape time of one pixel with the renderer's mapping and bailout: -1 for points that never escape
+static double smooth_count(const bmp::FractalParams &params, const std::int32_t width, const std::int32_t height,
+                           const std::int32_t x, const std::int32_t y) {
+  const double step = params.width / width;
+  const double pr = params.center_x - step * (width - 1) / 2.0 + x * step;
+  const double pi = params.center_y + step * (height - 1) / 2.0 - y * step;
+  const bool julia = params.type == bmp::FractalType::Julia;
+  double zr = julia ? pr : 0.0, zi = julia ? pi : 0.0;
+  const double kr = julia ? params.julia_x : pr, ki = julia ? params.julia_y : pi;
+  for (std::uint32_t i = 1; i <= params.max_iterations; ++i) {
+    const double ri = zr * zi;
+    zr = zr * zr - zi * zi + kr;
+    zi = ri + ri + ki;
+    const double radius2 = zr * zr + zi * zi;
+    if (radius2 > 65536.0)
+      return i + 1.0 - std::log2(std::log2(radius2) / 16.0);
+  }
+  return -1.0;
+}
+
+int main() {
+  try {
+    bmp::FractalRenderer renderer;
+    bmp::FractalParams params;
+    params.max_iterations = 100;
+    params.colors = {bmp::Black, bmp::White};
+    params.inside = bmp::Magenta;
+
+    for (const bmp::FractalType type: {bmp::FractalType::Mandelbrot, bmp::FractalType::Julia}) {
+      params.type = type;
+      params.center_x = type == bmp::FractalType::Julia ? 0.0 : -0.5;
+      bmp::Bitmap image(203, 157);
+      renderer.render(image, params);
+
+      // Inside points match a scalar reference exactly, escaped ones take the gray of their smooth iteration count
+      for (std::int32_t y = 0; y < image.height(); ++y) {
+        for (std::int32_t x = 0; x < image.width(); ++x) {
+          const double count = smooth_count(params, image.width(), image.height(), x, y);
+          const bmp::Pixel pixel = image.get(x, y);
+          const int gray = std::min(255, static_cast<int>((std::floor(count * 16.0) + 0.5) / (16.0 * 100.0) * 256.0));
+          if (count < 0.0 ? pixel != bmp::Magenta : (pixel == bmp::Magenta || std::abs(pixel.r - gray) > 1)) {
+            std::cerr << "Fractal " << static_cast<int>(type) << " is wrong at " << x << ", " << y << std::endl;
+            return EXIT_FAILURE;
+          }
+        }
+      }
+
+      // The periodicity and interior checks only skip work
+      bmp::FractalParams unchecked = params;
+      unchecked.periodicity_check = unchecked.interior_check = false;
+      bmp::Bitmap reference(image.width(), image.height());
+      renderer.render(reference, unchecked);
+      if (image != reference) {
+        std::cerr << "Fractal " << static_cast<int>(type) << " changes with the periodicity or interior checks" << std::endl;
+        return EXIT_FAILURE;
+      }
+      if (renderer.scheduler().timings().size() != 12) {
+        std::cerr << "Render ran " << renderer.scheduler().timings().size() << " tiles" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    // Bad iteration limits and views are rejected
+    for (int bad = 0; bad < 2; ++bad) {
+      bmp::FractalParams wrong;
+      if (bad == 0)
+        wrong.max_iterations = 0;
+      else
+        wrong.width = -1.0;
+      try {
+        bmp::Bitmap image(8, 8);
+        renderer.render(image, wrong);
+        std::cerr << "Invalid fractal parameters were accepted" << std::endl;
+        return EXIT_FAILURE;
+      } catch (const bmp::Exception &) {
+      }
+    }
+
+    bmp::Bitmap image(1280, 960);
+    bmp::FractalParams seahorse;
+    seahorse.center_x = -0.7453;
+    seahorse.center_y = 0.1127;
+    seahorse.width = 0.01;
+    seahorse.max_iterations = 1000;
+    seahorse.colors = {{}, {}, jet_colormap, 1000};
+    seahorse.color_period = 128.0;
+    renderer.render(image, seahorse);
+    image.save(std::filesystem::path(BIN_DIR) / "fractal_renderer.bmp");
+
+    return EXIT_SUCCESS;
+  } catch (const bmp::Exception &e) {
+    std::cerr << "[BMP ERROR]: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
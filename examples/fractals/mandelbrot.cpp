@@ -6,39 +6,35 @@
 int main() {
   bmp::Bitmap image(1280, 960);
 
-  double cr, ci;
-  double nextr, nexti;
-  double prevr, previ;
   constexpr std::uint16_t max_iterations = 3000;
 
-  for (std::int32_t y = 0; y < image.height(); ++y) {
-    for (std::int32_t x = 0; x < image.width(); ++x) {
-      cr = 1.5 * (2.0 * x / image.width() - 1.0) - 0.5;
-      ci = (2.0 * y / image.height() - 1.0);
+  // Points near the set take up to max_iterations each, so rows cost very different amounts:
+  // generate() hands out small bands of rows to the thread pool to keep every thread busy
+  image.generate([&](const std::int32_t x, const std::int32_t y) {
+    const double cr = 1.5 * (2.0 * x / image.width() - 1.0) - 0.5;
+    const double ci = (2.0 * y / image.height() - 1.0);
 
-      nextr = nexti = 0;
-      prevr = previ = 0;
+    double nextr = 0, nexti = 0;
+    double prevr, previ;
 
-      for (std::uint16_t i = 0; i < max_iterations; ++i) {
-        prevr = nextr;
-        previ = nexti;
+    for (std::uint16_t i = 0; i < max_iterations; ++i) {
+      prevr = nextr;
+      previ = nexti;
 
-        nextr = prevr * prevr - previ * previ + cr;
-        nexti = 2 * prevr * previ + ci;
+      nextr = prevr * prevr - previ * previ + cr;
+      nexti = 2 * prevr * previ + ci;
 
-        if (((nextr * nextr) + (nexti * nexti)) > 4) {
-          const double z = sqrt(nextr * nextr + nexti * nexti);
+      if (((nextr * nextr) + (nexti * nexti)) > 4) {
+        const double z = sqrt(nextr * nextr + nexti * nexti);
 
-          // https://en.wikipedia.org/wiki/Mandelbrot_set#Continuous_.28smooth.29_coloring
-          const std::uint32_t index = static_cast<std::uint32_t>(1000.0 * log2(1.75 + i - log2(log2(z))) / log2(max_iterations));
+        // https://en.wikipedia.org/wiki/Mandelbrot_set#Continuous_.28smooth.29_coloring
+        const std::uint32_t index = static_cast<std::uint32_t>(1000.0 * log2(1.75 + i - log2(log2(z))) / log2(max_iterations));
 
-          image.set(x, y, jet_colormap[index]);
-
-          break;
-        }
+        return jet_colormap[index];
       }
     }
-  }
+    return bmp::Black;
+  });
 
   image.save(std::filesystem::path(BIN_DIR) / "mandelbrot.bmp");
 
@@ -0,0 +1,152 @@
+#include "BitmapPlusPlus.hpp"
+#include "fractals/color_maps.inl"
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <vector>
+
+static std::uint8_t div255(const std::uint32_t x) {
+  return static_cast<std::uint8_t>((x + 128 + ((x + 128) >> 8)) >> 8);
+}
+
+// Color of table entry `entry` of a gradient: a colormap entry or a 256 step blend of its two colors
+static bmp::Pixel entry_color(const bmp::Gradient &gradient, const std::int64_t entry) {
+  if (gradient.colormap != nullptr)
+    return gradient.colormap[entry];
+  const auto i = static_cast<std::uint32_t>(entry);
+  const bmp::Pixel a = gradient.start, b = gradient.end;
+  return {div255(a.r * (255 - i) + b.r * i), div255(a.g * (255 - i) + b.g * i), div255(a.b * (255 - i) + b.b * i)};
+}
+
+// Whether `pixel` is the gradient color at position u (in table entries), allowing for rounding right at an entry boundary
+static bool matches(const bmp::Gradient &gradient, const double u, const bmp::Pixel pixel) {
+  const auto size = static_cast<std::int64_t>(gradient.colormap != nullptr ? gradient.colormap_size : 256);
+  for (const double v: {u - 1e-3, u + 1e-3}) {
+    const std::int64_t entry = std::clamp<std::int64_t>(static_cast<std::int64_t>(std::floor(v)), 0, size - 1);
+    if (entry_color(gradient, entry) == pixel)
+      return true;
+  }
+  return false;
+}
+
+static double linear_position(const bmp::PointF from, const bmp::PointF to, const double size, const double x, const double y) {
+  const double dx = to.x - from.x, dy = to.y - from.y;
+  return ((x - from.x) * dx + (y - from.y) * dy) / (dx * dx + dy * dy) * size;
+}
+
+static double radial_position(const bmp::PointF center, const float radius, const double size, const double x, const double y) {
+  return std::hypot(x - center.x, y - center.y) / radius * size;
+}
+
+int main() {
+  try {
+    std::mt19937 rng(44);
+    std::uniform_real_distribution<float> coordinate(-150.0f, 450.0f);
+    const bmp::Gradient ramp{bmp::Pixel(10, 200, 40), bmp::Pixel(250, 20, 180)};
+    const bmp::Gradient hot{{}, {}, hot_colormap, 1000};
+    const bmp::Gradient palette{{}, {}, palette_colormap, std::size(palette_colormap)};
+
+    // Whole bitmap fills against a per pixel evaluation of the gradient, with steep, shallow and reversed axes
+    for (int test = 0; test < 30; ++test) {
+      const bmp::Gradient &gradient = test % 3 == 0 ? ramp : (test % 3 == 1 ? hot : palette);
+      const double size = gradient.colormap != nullptr ? static_cast<double>(gradient.colormap_size) : 256.0;
+      const bmp::PointF a{coordinate(rng), coordinate(rng)};
+      const bmp::PointF b = test % 5 == 0 ? bmp::PointF{a.x + 0.75f, a.y - 0.5f} : bmp::PointF{coordinate(rng), coordinate(rng)};
+      const float radius = test % 5 == 0 ? 3.5f : std::abs(coordinate(rng));
+      bmp::Bitmap linear(300, 200), radial(300, 200);
+      linear.fill_linear_gradient(a, b, gradient);
+      radial.fill_radial_gradient(a, radius, gradient);
+      for (std::int32_t y = 0; y < linear.height(); ++y) {
+        for (std::int32_t x = 0; x < linear.width(); ++x) {
+          if (!matches(gradient, linear_position(a, b, size, x, y), linear.get(x, y))) {
+            std::cerr << "Linear gradient " << test << " is wrong at " << x << ", " << y << std::endl;
+            return EXIT_FAILURE;
+          }
+          if (!matches(gradient, radial_position(a, radius, size, x, y), radial.get(x, y))) {
+            std::cerr << "Radial gradient " << test << " is wrong at " << x << ", " << y << std::endl;
+            return EXIT_FAILURE;
+          }
+        }
+      }
+
+      // Rects, spans and polygons color the pixels they cover exactly as the whole bitmap fill does
+      const std::int32_t rx = static_cast<std::int32_t>(rng() % 250), ry = static_cast<std::int32_t>(rng() % 150);
+      const std::int32_t rw = 1 + static_cast<std::int32_t>(rng() % static_cast<std::uint32_t>(300 - rx));
+      const std::int32_t rh = 1 + static_cast<std::int32_t>(rng() % static_cast<std::uint32_t>(200 - ry));
+      std::vector<bmp::Span> spans;
+      for (int i = 0; i < 40; ++i)
+        spans.push_back({static_cast<std::int32_t>(rng() % 400) - 50, static_cast<std::int32_t>(rng() % 240) - 20,
+                         static_cast<std::int32_t>(rng() % 200) - 10});
+      std::vector<bmp::PointF> polygon(3 + rng() % 6);
+      for (bmp::PointF &point: polygon)
+        point = {coordinate(rng), coordinate(rng)};
+
+      bmp::Bitmap shaded(300, 200), covered(300, 200);
+      shaded.fill_linear_gradient(rx, ry, rw, rh, a, b, gradient);
+      shaded.fill_linear_gradient(spans.data(), spans.size(), a, b, gradient);
+      shaded.fill_linear_gradient(polygon.data(), polygon.size(), a, b, gradient, bmp::FillRule::EvenOdd);
+      covered.fill_rect(rx, ry, rw, rh, bmp::White);
+      for (const bmp::Span &span: spans)
+        if (span.width > 0)
+          covered.fill_rect_clipped(span.x, span.y, span.width, 1, bmp::White);
+      covered.fill_polygon(polygon.data(), polygon.size(), bmp::White, bmp::FillRule::EvenOdd);
+      for (const bool is_radial: {false, true}) {
+        if (is_radial) {
+          shaded.clear();
+          shaded.fill_radial_gradient(rx, ry, rw, rh, a, radius, gradient);
+          shaded.fill_radial_gradient(spans.data(), spans.size(), a, radius, gradient);
+          shaded.fill_radial_gradient(polygon.data(), polygon.size(), a, radius, gradient, bmp::FillRule::EvenOdd);
+        }
+        const bmp::Bitmap &full = is_radial ? radial : linear;
+        for (std::int32_t y = 0; y < shaded.height(); ++y) {
+          for (std::int32_t x = 0; x < shaded.width(); ++x) {
+            const bmp::Pixel expected = covered.get(x, y) == bmp::White ? full.get(x, y) : bmp::Black;
+            if (shaded.get(x, y) != expected) {
+              std::cerr << (is_radial ? "Radial" : "Linear") << " rect, span or polygon gradient " << test
+                        << " is wrong at " << x << ", " << y << std::endl;
+              return EXIT_FAILURE;
+            }
+          }
+        }
+      }
+    }
+
+    // Degenerate gradients take their end color everywhere
+    bmp::Bitmap flat(40, 30), flat_expected(40, 30);
+    flat_expected.clear(ramp.end);
+    flat.fill_linear_gradient({12.0f, 7.0f}, {12.0f, 7.0f}, ramp);
+    if (flat != flat_expected) {
+      std::cerr << "Linear gradient with coincident points is not the end color" << std::endl;
+      return EXIT_FAILURE;
+    }
+    flat.clear();
+    flat.fill_radial_gradient({12.0f, 7.0f}, 0.0f, ramp);
+    if (flat != flat_expected) {
+      std::cerr << "Radial gradient of radius 0 is not the end color" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Empty colormaps are rejected
+    try {
+      flat.fill_linear_gradient({0.0f, 0.0f}, {10.0f, 0.0f}, bmp::Gradient{{}, {}, hot_colormap, 0});
+      std::cerr << "Empty colormap was accepted" << std::endl;
+      return EXIT_FAILURE;
+    } catch (const bmp::Exception &) {
+    }
+
+    bmp::Bitmap image(480, 240);
+    image.fill_linear_gradient({0.0f, 0.0f}, {0.0f, 239.0f}, {bmp::Pixel(12, 16, 40), bmp::Pixel(60, 90, 140)});
+    image.fill_radial_gradient(20, 20, 200, 200, {120.0f, 120.0f}, 100.0f, hot);
+    const bmp::PointF star[] = {{360, 20}, {385, 95}, {460, 95}, {400, 140}, {425, 220},
+                                {360, 170}, {295, 220}, {320, 140}, {260, 95}, {335, 95}};
+    image.fill_linear_gradient(star, std::size(star), {260.0f, 20.0f}, {460.0f, 220.0f}, {{}, {}, jet_colormap, 1000});
+    image.save(std::filesystem::path(BIN_DIR) / "gradients.bmp");
+
+    return EXIT_SUCCESS;
+  } catch (const bmp::Exception &e) {
+    std::cerr << "[BMP ERROR]: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
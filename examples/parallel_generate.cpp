@@ -0,0 +1,101 @@
+#include "BitmapPlusPlus.hpp"
+#include <atomic>
+#include <filesystem>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+static bmp::Pixel pattern(const std::int32_t x, const std::int32_t y) {
+  // Uneven work per pixel, like an escape time fractal
+  std::uint32_t h = static_cast<std::uint32_t>(x) * 73856093u ^ static_cast<std::uint32_t>(y) * 19349663u;
+  for (std::int32_t i = 0; i < (x * y) % 97; ++i)
+    h = h * 1664525u + 1013904223u;
+  return {static_cast<std::uint8_t>(h >> 24), static_cast<std::uint8_t>(h >> 16), static_cast<std::uint8_t>(x ^ y)};
+}
+
+int main() {
+  try {
+    bmp::Bitmap expected(301, 203);
+    for (std::int32_t y = 0; y < expected.height(); ++y)
+      for (std::int32_t x = 0; x < expected.width(); ++x)
+        expected.set(x, y, pattern(x, y));
+
+    // Any thread count gives the serial result, and every row is visited exactly once
+    for (const std::size_t threads: {1, 3, 0}) {
+      bmp::set_thread_count(threads);
+      if (threads != 0 && bmp::thread_count() != threads) {
+        std::cerr << "Asked for " << threads << " threads, got " << bmp::thread_count() << std::endl;
+        return EXIT_FAILURE;
+      }
+      bmp::Bitmap image(expected.width(), expected.height());
+      image.generate(pattern);
+      if (image != expected) {
+        std::cerr << "generate() on " << threads << " threads differs from a serial loop" << std::endl;
+        return EXIT_FAILURE;
+      }
+
+      std::vector<std::atomic<int>> visits(static_cast<std::size_t>(image.height()));
+      image.for_each_row([&](const bmp::PixelRow<bmp::Pixel> row) {
+        ++visits[static_cast<std::size_t>(row.y())];
+        for (bmp::Pixel &pixel: row)
+          pixel = bmp::Pixel(255 - pixel.r, 255 - pixel.g, 255 - pixel.b);
+      });
+      std::atomic<std::int64_t> sum{0};
+      const bmp::Bitmap &constant = image;
+      constant.for_each_row([&](const bmp::PixelRow<const bmp::Pixel> row) {
+        std::int64_t row_sum = 0;
+        for (const bmp::Pixel &pixel: row)
+          row_sum += pixel.r;
+        sum += row_sum;
+      });
+      std::int64_t expected_sum = 0;
+      for (const bmp::Pixel &pixel: expected)
+        expected_sum += 255 - pixel.r;
+      for (const std::atomic<int> &count: visits) {
+        if (count != 1) {
+          std::cerr << "for_each_row() on " << threads << " threads visited a row " << count << " times" << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+      if (sum != expected_sum) {
+        std::cerr << "const for_each_row() on " << threads << " threads saw the wrong pixels" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    // Exceptions thrown by the callback reach the caller, and the pool keeps working afterwards
+    bmp::set_thread_count(3);
+    bmp::Bitmap image(expected.width(), expected.height());
+    try {
+      image.generate([](const std::int32_t x, const std::int32_t y) {
+        if (x == 150 && y == 100)
+          throw std::runtime_error("callback failed");
+        return bmp::White;
+      });
+      std::cerr << "Exception thrown by the callback was lost" << std::endl;
+      return EXIT_FAILURE;
+    } catch (const std::runtime_error &) {
+    }
+
+    // The thread count cannot change while a parallel algorithm is running
+    try {
+      image.for_each_row([](const bmp::PixelRow<bmp::Pixel>) { bmp::set_thread_count(2); });
+      std::cerr << "set_thread_count() inside a parallel task was accepted" << std::endl;
+      return EXIT_FAILURE;
+    } catch (const bmp::Exception &) {
+    }
+
+    image.generate(pattern);
+    bmp::set_thread_count(0);
+    if (image != expected) {
+      std::cerr << "generate() after a failed call differs from a serial loop" << std::endl;
+      return EXIT_FAILURE;
+    }
+    image.save(std::filesystem::path(BIN_DIR) / "parallel_generate.bmp");
+
+    return EXIT_SUCCESS;
+  } catch (const bmp::Exception &e) {
+    std::cerr << "[BMP ERROR]: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
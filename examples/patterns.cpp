@@ -0,0 +1,101 @@
+#include "BitmapPlusPlus.hpp"
+#include <filesystem>
+#include <iostream>
+#include <random>
+
+static std::int32_t floor_mod(const std::int64_t a, const std::int64_t b) {
+  return static_cast<std::int32_t>(((a % b) + b) % b);
+}
+
+int main() {
+  try {
+    std::mt19937 rng(45);
+    const auto random_pixel = [&] {
+      return bmp::Pixel(static_cast<std::uint8_t>(rng()), static_cast<std::uint8_t>(rng()), static_cast<std::uint8_t>(rng()));
+    };
+
+    // Whole bitmap and rect tilings against a per pixel lookup, with tiles wider or taller than the bitmap
+    for (int test = 0; test < 100; ++test) {
+      bmp::Bitmap tile(1 + static_cast<std::int32_t>(rng() % 90), 1 + static_cast<std::int32_t>(rng() % 70));
+      for (bmp::Pixel &pixel: tile)
+        pixel = random_pixel();
+      const std::int32_t origin_x = static_cast<std::int32_t>(rng() % 400) - 200, origin_y = static_cast<std::int32_t>(rng() % 400) - 200;
+      bmp::Bitmap image(1 + static_cast<std::int32_t>(rng() % 200), 1 + static_cast<std::int32_t>(rng() % 150));
+      image.fill_pattern(tile, origin_x, origin_y);
+      const std::int32_t rx = static_cast<std::int32_t>(rng() % static_cast<std::uint32_t>(image.width()));
+      const std::int32_t ry = static_cast<std::int32_t>(rng() % static_cast<std::uint32_t>(image.height()));
+      const std::int32_t rw = 1 + static_cast<std::int32_t>(rng() % static_cast<std::uint32_t>(image.width() - rx));
+      const std::int32_t rh = 1 + static_cast<std::int32_t>(rng() % static_cast<std::uint32_t>(image.height() - ry));
+      bmp::Bitmap rect(image.width(), image.height());
+      rect.clear(bmp::Magenta);
+      rect.fill_pattern(rx, ry, rw, rh, tile, origin_x, origin_y);
+      for (std::int32_t y = 0; y < image.height(); ++y) {
+        for (std::int32_t x = 0; x < image.width(); ++x) {
+          const bmp::Pixel expected = tile.get(floor_mod(x - origin_x, tile.width()), floor_mod(y - origin_y, tile.height()));
+          const bool inside = x >= rx && x < rx + rw && y >= ry && y < ry + rh;
+          if (image.get(x, y) != expected || rect.get(x, y) != (inside ? expected : bmp::Magenta)) {
+            std::cerr << "Pattern " << test << " is wrong at " << x << ", " << y << std::endl;
+            return EXIT_FAILURE;
+          }
+        }
+      }
+
+      // Checkerboards of random cells and origins
+      const std::int32_t cell_width = 1 + static_cast<std::int32_t>(rng() % 40), cell_height = 1 + static_cast<std::int32_t>(rng() % 40);
+      const bmp::Pixel first = random_pixel(), second = random_pixel();
+      image.fill_checkerboard(cell_width, cell_height, first, second, origin_x, origin_y);
+      for (std::int32_t y = 0; y < image.height(); ++y) {
+        for (std::int32_t x = 0; x < image.width(); ++x) {
+          const std::int64_t cx = (static_cast<std::int64_t>(x) - origin_x - floor_mod(x - origin_x, cell_width)) / cell_width;
+          const std::int64_t cy = (static_cast<std::int64_t>(y) - origin_y - floor_mod(y - origin_y, cell_height)) / cell_height;
+          if (image.get(x, y) != (((cx + cy) & 1) == 0 ? first : second)) {
+            std::cerr << "Checkerboard " << test << " is wrong at " << x << ", " << y << std::endl;
+            return EXIT_FAILURE;
+          }
+        }
+      }
+    }
+
+    // Tiling a bitmap with a view of its own corner repeats the corner as it was before the fill
+    bmp::Bitmap self(64, 48), expected(64, 48);
+    for (bmp::Pixel &pixel: self)
+      pixel = random_pixel();
+    bmp::Bitmap corner(10, 7);
+    corner.blit(self, 0, 0, 10, 7, 0, 0);
+    self.fill_pattern(self.view(0, 0, 10, 7), 3, 2);
+    expected.fill_pattern(corner, 3, 2);
+    if (self != expected) {
+      std::cerr << "Tiling with a view of the bitmap itself differs from tiling with a copy" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Empty tiles and cells are rejected
+    for (int bad = 0; bad < 2; ++bad) {
+      try {
+        if (bad == 0)
+          self.fill_pattern(bmp::BitmapView());
+        else
+          self.fill_checkerboard(0, 8, bmp::White, bmp::Black);
+        std::cerr << "Empty tile or cell was accepted" << std::endl;
+        return EXIT_FAILURE;
+      } catch (const bmp::Exception &) {
+      }
+    }
+
+    bmp::Bitmap brick(32, 16);
+    brick.clear(bmp::Pixel(170, 74, 68));
+    brick.fill_rect(0, 7, 32, 1, bmp::Pixel(200, 200, 190));
+    brick.fill_rect(0, 15, 32, 1, bmp::Pixel(200, 200, 190));
+    brick.fill_rect(31, 0, 1, 8, bmp::Pixel(200, 200, 190));
+    brick.fill_rect(15, 8, 1, 8, bmp::Pixel(200, 200, 190));
+    bmp::Bitmap image(320, 160);
+    image.fill_checkerboard(20, 20, bmp::Pixel(60, 60, 60), bmp::Pixel(90, 90, 90), 10, 10);
+    image.fill_pattern(40, 40, 240, 80, brick, 40, 40);
+    image.save(std::filesystem::path(BIN_DIR) / "patterns.bmp");
+
+    return EXIT_SUCCESS;
+  } catch (const bmp::Exception &e) {
+    std::cerr << "[BMP ERROR]: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,98 @@
+#include "BitmapPlusPlus.hpp"
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Brute force point in polygon test at every pixel center with the same edge conventions
+static bmp::Bitmap reference_fill(const std::int32_t width, const std::int32_t height, const std::vector<bmp::PointF> &points,
+                                  const std::vector<std::size_t> &sizes, const bmp::FillRule rule) {
+  bmp::Bitmap image(width, height);
+  for (std::int32_t y = 0; y < height; ++y) {
+    for (std::int32_t x = 0; x < width; ++x) {
+      std::int32_t winding = 0;
+      std::size_t offset = 0;
+      for (const std::size_t size: sizes) {
+        for (std::size_t i = 0; i < size; ++i) {
+          bmp::PointF a = points[offset + i], b = points[offset + (i + 1) % size];
+          std::int32_t direction = 1;
+          if (a.y > b.y) {
+            std::swap(a, b);
+            direction = -1;
+          }
+          if (!(a.y <= y && y < b.y))
+            continue;
+          const double crossing = a.x + (y - static_cast<double>(a.y)) * ((static_cast<double>(b.x) - a.x) / (static_cast<double>(b.y) - a.y));
+          if (crossing <= x)
+            winding += direction;
+        }
+        offset += size;
+      }
+      if (rule == bmp::FillRule::EvenOdd ? (winding % 2 != 0) : (winding != 0))
+        image.set(x, y, bmp::White);
+    }
+  }
+  return image;
+}
+
+int main() {
+  try {
+    // A pixel aligned rectangle is exactly fill_rect
+    bmp::Bitmap image(64, 64);
+    bmp::Bitmap expected(64, 64);
+    const bmp::PointF rect[] = {{9.5f, 9.5f}, {29.5f, 9.5f}, {29.5f, 19.5f}, {9.5f, 19.5f}};
+    image.fill_polygon(rect, 4, bmp::White);
+    expected.fill_rect(10, 10, 20, 10, bmp::White);
+    if (image != expected) {
+      std::cerr << "Rectangle polygon differs from fill_rect" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Random concave, self intersecting, multi contour polygons partly outside the bitmap
+    std::mt19937 rng(39);
+    std::uniform_real_distribution<float> coordinate(-20.0f, 100.0f);
+    for (int test = 0; test < 200; ++test) {
+      std::vector<bmp::PointF> points;
+      std::vector<std::size_t> sizes;
+      for (std::size_t contour = 0; contour < 1 + static_cast<std::size_t>(test % 3); ++contour) {
+        sizes.push_back(3 + rng() % 8);
+        for (std::size_t i = 0; i < sizes.back(); ++i)
+          points.push_back({coordinate(rng), coordinate(rng)});
+      }
+      for (const bmp::FillRule rule: {bmp::FillRule::EvenOdd, bmp::FillRule::NonZero}) {
+        bmp::Bitmap filled(80, 70);
+        filled.fill_polygon(points.data(), sizes.data(), sizes.size(), bmp::White, rule);
+        if (filled != reference_fill(80, 70, points, sizes, rule)) {
+          std::cerr << "Polygon " << test << " differs from the point in polygon reference" << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+    }
+
+    // A star with a hole: the inner contour is wound the other way, so both rules cut it out
+    std::vector<bmp::PointF> star;
+    for (int i = 0; i < 10; ++i) {
+      const float angle = 3.14159265f * static_cast<float>(i) / 5.0f;
+      const float radius = (i % 2 == 0) ? 140.0f : 60.0f;
+      star.push_back({160.0f + radius * std::sin(angle), 160.0f - radius * std::cos(angle)});
+    }
+    for (int i = 0; i < 32; ++i) {
+      const float angle = -2.0f * 3.14159265f * static_cast<float>(i) / 32.0f;
+      star.push_back({160.0f + 30.0f * std::sin(angle), 160.0f - 30.0f * std::cos(angle)});
+    }
+    const std::size_t sizes[] = {10, 32};
+    bmp::Bitmap shapes(320, 320);
+    shapes.fill_polygon(star.data(), sizes, 2, bmp::Gold, bmp::FillRule::NonZero);
+    if (shapes.get(160, 160) != bmp::Black || shapes.get(160, 110) != bmp::Gold) {
+      std::cerr << "Star hole is not cut out" << std::endl;
+      return EXIT_FAILURE;
+    }
+    shapes.save(std::filesystem::path(BIN_DIR) / "polygon_fill.bmp");
+
+    return EXIT_SUCCESS;
+  } catch (const bmp::Exception &e) {
+    std::cerr << "[BMP ERROR]: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
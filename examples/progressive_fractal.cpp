@@ -0,0 +1,75 @@
+#include "BitmapPlusPlus.hpp"
+#include "fractals/color_maps.inl"
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+int main() {
+  try {
+    bmp::FractalRenderer renderer;
+    bmp::FractalParams params;
+    params.max_iterations = 500;
+    params.colors = {{}, {}, jet_colormap, 1000};
+    params.color_period = 64.0;
+
+    for (const bmp::FractalType type: {bmp::FractalType::Mandelbrot, bmp::FractalType::Julia}) {
+      params.type = type;
+      params.center_x = type == bmp::FractalType::Julia ? 0.0 : -0.5;
+      bmp::Bitmap full(421, 317), adaptive(421, 317), progressive(421, 317);
+      renderer.render(full, params);
+      renderer.render_adaptive(adaptive, params);
+
+      // Subdivision only skips cells enclosed by one color, so it agrees with the full render almost everywhere
+      std::int64_t differences = 0;
+      for (std::int32_t y = 0; y < full.height(); ++y)
+        for (std::int32_t x = 0; x < full.width(); ++x)
+          differences += full.get(x, y) != adaptive.get(x, y);
+      if (differences > full.width() * full.height() / 200) {
+        std::cerr << "Adaptive render differs from the full render in " << differences << " pixels" << std::endl;
+        return EXIT_FAILURE;
+      }
+
+      // Progressive passes are numbered in order and end with the adaptive render
+      std::vector<std::int32_t> passes;
+      bmp::Bitmap coarse;
+      renderer.render_progressive(progressive, params, [&](const bmp::Bitmap &partial, const std::int32_t pass) {
+        passes.push_back(pass);
+        if (pass == 0)
+          coarse = partial;
+      });
+      if (passes.size() < 4 || passes.front() != 0 || passes.back() != static_cast<std::int32_t>(passes.size()) - 1) {
+        std::cerr << "Progressive render reported " << passes.size() << " passes" << std::endl;
+        return EXIT_FAILURE;
+      }
+      if (progressive != adaptive) {
+        std::cerr << "Last progressive pass differs from the adaptive render" << std::endl;
+        return EXIT_FAILURE;
+      }
+      if (type == bmp::FractalType::Mandelbrot)
+        coarse.save(std::filesystem::path(BIN_DIR) / "progressive_fractal_preview.bmp");
+    }
+
+    // Images too thin to have cell interiors are computed in full
+    for (const std::int32_t size: {1, 2, 3, 70}) {
+      bmp::Bitmap full(size, 3), adaptive(size, 3);
+      renderer.render(full, params);
+      renderer.render_adaptive(adaptive, params);
+      if (full != adaptive) {
+        std::cerr << "Adaptive render of a " << size << "x3 image differs from the full render" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    bmp::Bitmap image(1280, 960);
+    params.type = bmp::FractalType::Mandelbrot;
+    params.center_x = -0.5;
+    renderer.render_adaptive(image, params);
+    image.save(std::filesystem::path(BIN_DIR) / "progressive_fractal.bmp");
+
+    return EXIT_SUCCESS;
+  } catch (const bmp::Exception &e) {
+    std::cerr << "[BMP ERROR]: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,67 @@
+#include "BitmapPlusPlus.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+
+int main() {
+  try {
+    bmp::Bitmap image;
+    image.load(std::filesystem::path(ROOT_DIR) / "images" / "penguin.bmp");
+
+    // Build every power of two downscale and write all levels concurrently
+    const bmp::Pyramid pyramid = bmp::build_pyramid(image);
+    pyramid.save(BIN_DIR, "penguin_level");
+    for (std::size_t i = 0; i < pyramid.levels(); ++i) {
+      const bmp::BitmapView level = pyramid.level(i);
+      std::cout << "Level " << i << ": " << level.width() << "x" << level.height() << std::endl;
+    }
+
+    // Level 0 is the source itself and the chain always ends with a single pixel
+    const bmp::BitmapView last = pyramid.level(pyramid.levels() - 1);
+    if (bmp::Bitmap(pyramid.level(0)) != image || last.width() != 1 || last.height() != 1) {
+      std::cerr << "Unexpected pyramid levels" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // A 2x2 black and white checker averages to mid gray
+    bmp::Bitmap checker(2, 2);
+    checker.set(0, 0, bmp::White);
+    checker.set(1, 1, bmp::White);
+    if (bmp::build_pyramid(checker).level(1).get(0, 0) != bmp::Pixel(128, 128, 128)) {
+      std::cerr << "Box reduction is not an average" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Every box average matches a per channel reference, for odd and even sizes
+    std::uint32_t seed = 29;
+    for (std::int32_t width = 2; width <= 48; ++width) {
+      for (const std::int32_t height: {1, 2, 5}) {
+        bmp::Bitmap noise(width, height);
+        for (bmp::Pixel &pixel: noise) {
+          seed = seed * 1664525u + 1013904223u;
+          pixel = bmp::Pixel(static_cast<std::int32_t>(seed >> 8));
+        }
+        const bmp::Bitmap half(bmp::build_pyramid(noise).level(1));
+        for (std::int32_t y = 0; y < half.height(); ++y) {
+          for (std::int32_t x = 0; x < half.width(); ++x) {
+            const std::int32_t x0 = 2 * x, x1 = std::min(2 * x + 1, width - 1);
+            const std::int32_t y0 = std::min(2 * y, height - 1), y1 = std::min(2 * y + 1, height - 1);
+            const auto average = [&](std::uint8_t bmp::Pixel::*channel) {
+              return static_cast<std::uint8_t>((noise.get(x0, y0).*channel + noise.get(x1, y0).*channel +
+                                                noise.get(x0, y1).*channel + noise.get(x1, y1).*channel + 2) >> 2);
+            };
+            if (half.get(x, y) != bmp::Pixel(average(&bmp::Pixel::r), average(&bmp::Pixel::g), average(&bmp::Pixel::b))) {
+              std::cerr << "Box reduction of a " << width << "x" << height << " level differs at " << x << "," << y << std::endl;
+              return EXIT_FAILURE;
+            }
+          }
+        }
+      }
+    }
+
+    return EXIT_SUCCESS;
+  } catch (const bmp::Exception &e) {
+    std::cerr << "[BMP ERROR]: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
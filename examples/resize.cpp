@@ -0,0 +1,66 @@
+#include "BitmapPlusPlus.hpp"
+#include <filesystem>
+#include <iostream>
+
+int main() {
+  try {
+    bmp::Bitmap image;
+    image.load(std::filesystem::path(ROOT_DIR) / "images" / "penguin.bmp");
+
+    // Upscale and downscale with every filter
+    const std::pair<bmp::ResizeFilter, const char *> filters[] = {
+      {bmp::ResizeFilter::Nearest, "nearest"},
+      {bmp::ResizeFilter::Bilinear, "bilinear"},
+      {bmp::ResizeFilter::Area, "area"},
+      {bmp::ResizeFilter::Lanczos3, "lanczos3"}};
+    for (const auto &[filter, name]: filters) {
+      image.resize(image.width() * 2, image.height() * 2, filter)
+        .save(std::filesystem::path(BIN_DIR) / ("penguin_up_" + std::string(name) + ".bmp"));
+      image.resize(image.width() / 3, image.height() / 3, filter)
+        .save(std::filesystem::path(BIN_DIR) / ("penguin_down_" + std::string(name) + ".bmp"));
+    }
+
+    // Resize into a preallocated thumbnail, reused for every call
+    bmp::Bitmap thumbnail(64, 64);
+    image.resize(thumbnail, bmp::ResizeFilter::Area);
+    thumbnail.save(std::filesystem::path(BIN_DIR) / "penguin_thumbnail.bmp");
+
+    // A flat color must stay exactly the same whatever the filter
+    bmp::Bitmap flat(37, 23);
+    flat.clear(bmp::Coral);
+    for (const auto &[filter, name]: filters) {
+      for (const bmp::Pixel &pixel: flat.resize(101, 9, filter)) {
+        if (pixel != bmp::Coral) {
+          std::cerr << "Resize with " << name << " filter altered a flat color" << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+    }
+
+    // Resizing only one axis leaves stripes along the other axis untouched
+    bmp::Bitmap rows(40, 40), columns(40, 40);
+    for (std::int32_t i = 0; i < 40; ++i) {
+      const bmp::Pixel color(static_cast<std::uint8_t>(i * 6), static_cast<std::uint8_t>(255 - i * 5), static_cast<std::uint8_t>(i * 37));
+      rows.fill_rect(0, i, 40, 1, color);
+      columns.fill_rect(i, 0, 1, 40, color);
+    }
+    for (const auto &[filter, name]: filters) {
+      for (const std::int32_t size: {20, 80}) {
+        const bmp::Bitmap wide = rows.resize(size, 40, filter), tall = columns.resize(40, size, filter);
+        for (std::int32_t i = 0; i < 40; ++i) {
+          for (std::int32_t j = 0; j < size; ++j) {
+            if (wide.get(j, i) != rows.get(0, i) || tall.get(i, j) != columns.get(i, 0)) {
+              std::cerr << "Resize with " << name << " filter along one axis moved stripe " << i << std::endl;
+              return EXIT_FAILURE;
+            }
+          }
+        }
+      }
+    }
+
+    return EXIT_SUCCESS;
+  } catch (const bmp::Exception &e) {
+    std::cerr << "[BMP ERROR]: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,76 @@
+#include "BitmapPlusPlus.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <string>
+
+int main() {
+  try {
+    bmp::Bitmap image(97, 61), expected(97, 61);
+
+    // Writes through row pointers, unchecked accessors and row ranges land where set() puts them
+    for (std::int32_t y = 0; y < image.height(); ++y) {
+      bmp::Pixel *row = image.row(y);
+      for (std::int32_t x = 0; x < image.width(); ++x) {
+        const bmp::Pixel color(static_cast<std::uint8_t>(x * 3), static_cast<std::uint8_t>(y * 5), static_cast<std::uint8_t>(x ^ y));
+        row[x] = color;
+        expected.set(x, y, color);
+      }
+    }
+    if (image != expected || image.data() != &image.get(0, 0) || image.row(7) != &image.get(0, 7)) {
+      std::cerr << "Row pointers do not address the pixels set() writes" << std::endl;
+      return EXIT_FAILURE;
+    }
+    image.set_unchecked(10, 20, bmp::Gold);
+    expected.at_unchecked(10, 20) = bmp::Gold;
+    for (bmp::PixelRow<bmp::Pixel> row: image.rows(30, 40))
+      std::fill(row.begin(), row.end(), bmp::Pixel(0, 0, static_cast<std::uint8_t>(row.y())));
+    for (std::int32_t y = 30; y < 40; ++y)
+      expected.fill_rect(0, y, expected.width(), 1, bmp::Pixel(0, 0, static_cast<std::uint8_t>(y)));
+    if (image != expected || image.get(10, 20) != bmp::Gold) {
+      std::cerr << "Unchecked writes or row range writes differ from the checked ones" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Rows of a sub view step by the stride of the bitmap they view
+    const bmp::BitmapView view = image.view(5, 9, 20, 12);
+    std::int32_t rows = 0;
+    for (const bmp::PixelRow<const bmp::Pixel> row: view.rows()) {
+      if (row.size() != 20 || row.data() != &image.get(5, 9 + row.y()) || row[19] != image.get(24, 9 + row.y())) {
+        std::cerr << "View row " << row.y() << " is misplaced" << std::endl;
+        return EXIT_FAILURE;
+      }
+      ++rows;
+    }
+    const bmp::Bitmap &constant = image;
+    if (rows != 12 || constant.rows().size() != image.height() || constant.rows(61, 61).size() != 0) {
+      std::cerr << "Row ranges have the wrong number of rows" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Checked accessors still throw with the coordinates, as do bad row ranges
+    try {
+      image.set(97, 3, bmp::White);
+      std::cerr << "Out of bounds set was accepted" << std::endl;
+      return EXIT_FAILURE;
+    } catch (const bmp::Exception &e) {
+      if (std::string(e.what()) != "Bitmap::set(97, 3): x,y out of bounds") {
+        std::cerr << "Unexpected message: " << e.what() << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+    try {
+      (void) image.rows(10, 62);
+      std::cerr << "Out of bounds row range was accepted" << std::endl;
+      return EXIT_FAILURE;
+    } catch (const bmp::Exception &) {
+    }
+
+    image.save(std::filesystem::path(BIN_DIR) / "row_access.bmp");
+
+    return EXIT_SUCCESS;
+  } catch (const bmp::Exception &e) {
+    std::cerr << "[BMP ERROR]: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
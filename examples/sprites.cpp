@@ -0,0 +1,83 @@
+#include "BitmapPlusPlus.hpp"
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Reference blit through checked get/set, skipping pixels outside either bitmap
+static void reference_blit(bmp::Bitmap &target, const bmp::Bitmap &source, const bmp::Sprite &sprite,
+                           const bmp::Pixel *key) {
+  for (std::int32_t j = 0; j < sprite.height; ++j) {
+    for (std::int32_t i = 0; i < sprite.width; ++i) {
+      const std::int32_t sx = sprite.source_x + i, sy = sprite.source_y + j;
+      const std::int32_t x = sprite.x + i, y = sprite.y + j;
+      if (sx < 0 || sy < 0 || sx >= source.width() || sy >= source.height() ||
+          x < 0 || y < 0 || x >= target.width() || y >= target.height())
+        continue;
+      if (key == nullptr || source.get(sx, sy) != *key)
+        target.set(x, y, source.get(sx, sy));
+    }
+  }
+}
+
+int main() {
+  try {
+    constexpr bmp::Pixel key = bmp::Magenta;
+    std::mt19937 rng(38);
+
+    // Atlas of 8 icons on a transparent background, with scattered key pixels inside the icons
+    bmp::Bitmap atlas(256, 32);
+    atlas.clear(key);
+    for (std::int32_t i = 0; i < 8; ++i) {
+      atlas.fill_circle(16 + 32 * i, 16, 6 + i, bmp::Pixel(static_cast<std::uint8_t>(30 * i), 200, static_cast<std::uint8_t>(255 - 30 * i)));
+      atlas.draw_rect(32 * i + 2, 2, 28, 28, bmp::Black);
+    }
+    for (int i = 0; i < 200; ++i)
+      atlas.set(static_cast<std::int32_t>(rng() % 256), static_cast<std::int32_t>(rng() % 32), key);
+
+    std::uniform_int_distribution<std::int32_t> position(-40, 340);
+    std::vector<bmp::Sprite> sprites;
+    for (int i = 0; i < 500; ++i) {
+      const std::int32_t icon = static_cast<std::int32_t>(rng() % 8);
+      sprites.push_back({32 * icon - 3, -2, 38, 36, position(rng), position(rng)});
+    }
+
+    // Batched, keyed and clipped blits match the reference loop
+    for (const bool keyed: {false, true}) {
+      bmp::Bitmap expected(300, 300);
+      expected.clear(bmp::Silver);
+      bmp::Bitmap image = expected;
+      for (const bmp::Sprite &sprite: sprites)
+        reference_blit(expected, atlas, sprite, keyed ? &key : nullptr);
+      if (keyed)
+        image.blit(atlas, sprites.data(), sprites.size(), key);
+      else
+        image.blit(atlas, sprites.data(), sprites.size());
+      if (image != expected) {
+        std::cerr << (keyed ? "Keyed" : "Opaque") << " sprite blits differ from the reference" << std::endl;
+        return EXIT_FAILURE;
+      }
+      if (keyed)
+        image.save(std::filesystem::path(BIN_DIR) / "sprites.bmp");
+    }
+
+    // Blitting a bitmap onto itself with overlapping rectangles behaves like copying from a snapshot
+    bmp::Bitmap image(64, 64);
+    for (std::int32_t y = 0; y < 64; ++y)
+      for (std::int32_t x = 0; x < 64; ++x)
+        image.set(x, y, bmp::Pixel(static_cast<std::uint8_t>(x * 4), static_cast<std::uint8_t>(y * 4), 0));
+    const bmp::Bitmap snapshot = image;
+    bmp::Bitmap expected = image;
+    reference_blit(expected, snapshot, {0, 0, 40, 40, 5, 3}, nullptr);
+    image.blit(image, 0, 0, 40, 40, 5, 3);
+    if (image != expected) {
+      std::cerr << "Overlapping self blit is wrong" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+  } catch (const bmp::Exception &e) {
+    std::cerr << "[BMP ERROR]: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
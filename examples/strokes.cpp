@@ -0,0 +1,123 @@
+#include "BitmapPlusPlus.hpp"
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// Distance from (x, y) to the polyline through `points`
+static double polyline_distance(const std::vector<bmp::PointF> &points, const double x, const double y) {
+  double best = std::hypot(x - points[0].x, y - points[0].y);
+  for (std::size_t i = 0; i + 1 < points.size(); ++i) {
+    const double ax = points[i].x, ay = points[i].y;
+    const double dx = points[i + 1].x - ax, dy = points[i + 1].y - ay;
+    const double length2 = dx * dx + dy * dy;
+    const double t = length2 > 0.0 ? std::clamp(((x - ax) * dx + (y - ay) * dy) / length2, 0.0, 1.0) : 0.0;
+    best = std::min(best, std::hypot(x - ax - t * dx, y - ay - t * dy));
+  }
+  return best;
+}
+
+int main() {
+  try {
+    // Axis aligned strokes have exact pixel footprints
+    bmp::Bitmap corner(16, 16), expected(16, 16);
+    const bmp::PointF elbow[] = {{2, 2}, {10, 2}, {10, 10}};
+    corner.draw_polyline(elbow, 3, bmp::White, {3.0f, bmp::LineJoin::Miter});
+    expected.fill_rect(2, 1, 8, 3, bmp::White);
+    expected.fill_rect(9, 1, 3, 9, bmp::White);
+    if (corner != expected) {
+      std::cerr << "Mitered elbow has the wrong footprint" << std::endl;
+      return EXIT_FAILURE;
+    }
+    corner.clear();
+    corner.draw_polyline(elbow, 3, bmp::White, {3.0f, bmp::LineJoin::Bevel});
+    expected.set(11, 1, bmp::Black);
+    if (corner != expected) {
+      std::cerr << "Beveled elbow has the wrong footprint" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    bmp::Bitmap frame(40, 40), frame_expected(40, 40);
+    const bmp::PointF square[] = {{10, 10}, {30, 10}, {30, 30}, {10, 30}};
+    frame.draw_polygon(square, 4, bmp::White, {4.0f});
+    frame_expected.fill_rect(8, 8, 24, 24, bmp::White);
+    frame_expected.fill_rect(12, 12, 16, 16, bmp::Black);
+    if (frame != frame_expected) {
+      std::cerr << "Closed square outline has the wrong footprint" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    bmp::Bitmap dot(8, 8), dot_expected(8, 8);
+    const bmp::PointF center{3.5f, 3.5f};
+    dot.draw_polyline(&center, 1, bmp::White, {4.0f, bmp::LineJoin::Miter, bmp::LineCap::Square});
+    dot_expected.fill_rect(2, 2, 4, 4, bmp::White);
+    if (dot != dot_expected) {
+      std::cerr << "Square capped point is not a square" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Round joins and caps cover every pixel within half the width of the path, up to arc flattening
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> coordinate(-20.0f, 140.0f);
+    for (int test = 0; test < 60; ++test) {
+      std::vector<bmp::PointF> points(2 + rng() % 6);
+      for (bmp::PointF &point: points)
+        point = {coordinate(rng), coordinate(rng) * 0.75f};
+      const float width = 1.0f + static_cast<float>(rng() % 24) * 0.5f;
+      bmp::Bitmap image(120, 90);
+      image.draw_polyline(points.data(), points.size(), bmp::White, {width, bmp::LineJoin::Round, bmp::LineCap::Round});
+      for (std::int32_t y = 0; y < image.height(); ++y) {
+        for (std::int32_t x = 0; x < image.width(); ++x) {
+          const double distance = polyline_distance(points, x, y);
+          const bool filled = image.get(x, y) == bmp::White;
+          if ((distance < width * 0.5 - 0.3 && !filled) || (distance > width * 0.5 + 1e-3 && filled)) {
+            std::cerr << "Round stroke " << test << " is wrong at " << x << ", " << y << std::endl;
+            return EXIT_FAILURE;
+          }
+        }
+      }
+    }
+
+    // Pieces culled past the right and bottom edges of a small bitmap do not change what is visible
+    std::vector<bmp::PointF> walk(5000);
+    float wx = 150.0f, wy = 150.0f;
+    for (bmp::PointF &point: walk) {
+      wx += static_cast<float>(static_cast<int>(rng() % 41) - 20) * 0.5f;
+      wy += static_cast<float>(static_cast<int>(rng() % 41) - 20) * 0.5f;
+      point = {wx, wy};
+    }
+    for (const bmp::LineJoin join: {bmp::LineJoin::Miter, bmp::LineJoin::Bevel, bmp::LineJoin::Round}) {
+      const bmp::StrokeStyle style{5.0f, join, bmp::LineCap::Square};
+      bmp::Bitmap small(200, 200), large(1200, 1200);
+      small.draw_polyline(walk.data(), walk.size(), bmp::Cyan, style);
+      large.draw_polyline(walk.data(), walk.size(), bmp::Cyan, style);
+      for (std::int32_t y = 0; y < 200; ++y) {
+        for (std::int32_t x = 0; x < 200; ++x) {
+          if (small.get(x, y) != large.get(x, y)) {
+            std::cerr << "Clipped stroke differs from the unclipped one at " << x << ", " << y << std::endl;
+            return EXIT_FAILURE;
+          }
+        }
+      }
+    }
+
+    bmp::Bitmap image(320, 160);
+    image.clear(bmp::Pixel(24, 24, 40));
+    const bmp::LineJoin joins[] = {bmp::LineJoin::Miter, bmp::LineJoin::Bevel, bmp::LineJoin::Round};
+    const bmp::LineCap caps[] = {bmp::LineCap::Butt, bmp::LineCap::Square, bmp::LineCap::Round};
+    for (int i = 0; i < 3; ++i) {
+      const float x = 20.0f + 100.0f * static_cast<float>(i);
+      const bmp::PointF zigzag[] = {{x, 130}, {x + 20, 30}, {x + 40, 110}, {x + 70, 40}};
+      image.draw_polyline(zigzag, 4, bmp::Orange, {12.0f, joins[i], caps[i]});
+      image.draw_polyline(zigzag, 4, bmp::Black);
+    }
+    image.save(std::filesystem::path(BIN_DIR) / "strokes.bmp");
+
+    return EXIT_SUCCESS;
+  } catch (const bmp::Exception &e) {
+    std::cerr << "[BMP ERROR]: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,150 @@
+#include "BitmapPlusPlus.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 5x7 glyphs for ' ' to 'Z' drawn as ASCII art, '#' is full ink and '+' half ink. Missing glyphs stay blank.
+static const char *glyph_art(const char c) {
+  switch (c) {
+    case '0': return " ### #   ##  ### # ###  ##   # ### ";
+    case '1': return "  #   ##    #    #    #    #   ### ";
+    case '2': return " ### #   #    #   #   #   #   #####";
+    case '3': return "#####   #   #     #     ##   # ### ";
+    case '4': return "   #   ##  # # #  # #####   #    # ";
+    case '5': return "######    ####     #    ##   # ### ";
+    case '6': return "  ##  #   #    #### #   ##   # ### ";
+    case '7': return "#####    #   #   #   #    #    #   ";
+    case '8': return " ### #   ##   # ### #   ##   # ### ";
+    case '9': return " ### #   ##   # ####    #   #  ##  ";
+    case '.': return "                          ++   ++  ";
+    case ':': return "      ++   ++        ++   ++       ";
+    case '-': return "               #####               ";
+    case 'B': return "#### #   ##   ##### #   ##   ##### ";
+    case 'M': return "#   ### ### # ##   ##   ##   ##   #";
+    case 'P': return "#### #   ##   ##### #    #    #    ";
+    default: return nullptr;
+  }
+}
+
+static constexpr std::int32_t GLYPH_WIDTH = 6, GLYPH_HEIGHT = 8, COLUMNS = 16;
+
+// Atlas of 64 cells from ' ', each 6x8 cell holding a 5x7 glyph
+static bmp::Bitmap make_atlas() {
+  bmp::Bitmap atlas(COLUMNS * GLYPH_WIDTH, 4 * GLYPH_HEIGHT);
+  for (std::int32_t g = 0; g < 64; ++g) {
+    const char *art = glyph_art(static_cast<char>(' ' + g));
+    if (art == nullptr)
+      continue;
+    for (std::int32_t y = 0; y < 7; ++y) {
+      for (std::int32_t x = 0; x < 5; ++x) {
+        const char ink = art[y * 5 + x];
+        if (ink != ' ')
+          atlas.set((g % COLUMNS) * GLYPH_WIDTH + x, (g / COLUMNS) * GLYPH_HEIGHT + y,
+                    ink == '#' ? bmp::White : bmp::Pixel(0, 128, 40));
+      }
+    }
+  }
+  return atlas;
+}
+
+static std::uint8_t div255(const std::uint32_t x) {
+  return static_cast<std::uint8_t>((x + 128 + ((x + 128) >> 8)) >> 8);
+}
+
+// Pixel by pixel reference: blends the atlas coverage of every glyph straight from the atlas
+static void reference_text(bmp::Bitmap &image, const bmp::Bitmap &atlas, const std::int32_t x, const std::int32_t y,
+                           const std::string_view text, const bmp::Pixel color, const std::uint8_t opacity) {
+  std::int32_t pen_x = x, pen_y = y;
+  for (const char c: text) {
+    if (c == '\n') {
+      pen_x = x;
+      pen_y += GLYPH_HEIGHT;
+      continue;
+    }
+    const std::int32_t g = static_cast<unsigned char>(c) - ' ';
+    if (g >= 0 && g < 64) {
+      for (std::int32_t gy = 0; gy < GLYPH_HEIGHT; ++gy) {
+        for (std::int32_t gx = 0; gx < GLYPH_WIDTH; ++gx) {
+          const std::int32_t px = pen_x + gx, py = pen_y + gy;
+          if (px < 0 || py < 0 || px >= image.width() || py >= image.height())
+            continue;
+          const bmp::Pixel ink = atlas.get((g % COLUMNS) * GLYPH_WIDTH + gx, (g / COLUMNS) * GLYPH_HEIGHT + gy);
+          const std::uint32_t alpha = div255(std::max({ink.r, ink.g, ink.b}) * static_cast<std::uint32_t>(opacity));
+          const bmp::Pixel dst = image.get(px, py);
+          image.set(px, py, bmp::Pixel(div255(dst.r * (255 - alpha) + color.r * alpha),
+                                       div255(dst.g * (255 - alpha) + color.g * alpha),
+                                       div255(dst.b * (255 - alpha) + color.b * alpha)));
+        }
+      }
+    }
+    pen_x += GLYPH_WIDTH;
+  }
+}
+
+int main() {
+  try {
+    const bmp::Bitmap atlas = make_atlas();
+    const std::filesystem::path atlas_path = std::filesystem::path(BIN_DIR) / "font_atlas.bmp";
+    atlas.save(atlas_path);
+    const bmp::Font font = bmp::Font::load(atlas_path, GLYPH_WIDTH, GLYPH_HEIGHT);
+    if (font.text_width("12:30\n-5") != 5 * GLYPH_WIDTH || font.text_height("12:30\n-5") != 2 * GLYPH_HEIGHT ||
+        !font.has_glyph('Z') || font.has_glyph('a') || font.glyph('~') != nullptr) {
+      std::cerr << "Unexpected font metrics" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Single strings, including ones hanging off every edge and missing glyphs
+    std::mt19937 rng(41);
+    const std::string alphabet = "0123456789.:- BMPxq\n";
+    for (int test = 0; test < 200; ++test) {
+      bmp::Bitmap image(64, 40), expected(64, 40);
+      image.clear(bmp::Pixel(30, 60, 90));
+      expected.clear(bmp::Pixel(30, 60, 90));
+      std::string text;
+      for (std::uint32_t i = rng() % 24; i > 0; --i)
+        text += alphabet[rng() % alphabet.size()];
+      const std::int32_t x = static_cast<std::int32_t>(rng() % 96) - 24, y = static_cast<std::int32_t>(rng() % 64) - 16;
+      const bmp::Pixel color(static_cast<std::uint8_t>(rng()), static_cast<std::uint8_t>(rng()), static_cast<std::uint8_t>(rng()));
+      const auto opacity = static_cast<std::uint8_t>(test % 3 == 0 ? 255 : rng() % 256);
+      image.draw_text(font, x, y, text, color, opacity);
+      reference_text(expected, atlas, x, y, text, color, opacity);
+      if (image != expected) {
+        std::cerr << "Text " << test << " differs from the pixel by pixel reference" << std::endl;
+        return EXIT_FAILURE;
+      }
+    }
+
+    // The banded batch matches drawing the labels one by one
+    std::vector<std::string> strings;
+    for (std::int32_t i = 0; i < 4000; ++i)
+      strings.push_back(std::to_string(i * 7919 % 100000) + (i % 3 == 0 ? "\nBMP" : "-MB"));
+    std::vector<bmp::TextLabel> labels;
+    for (std::size_t i = 0; i < strings.size(); ++i)
+      labels.push_back({static_cast<std::int32_t>(rng() % 560) - 40, static_cast<std::int32_t>(rng() % 440) - 20,
+                        strings[i], bmp::Pixel(static_cast<std::uint8_t>(i), 255, static_cast<std::uint8_t>(i * 3)),
+                        static_cast<std::uint8_t>(i % 2 == 0 ? 255 : 160)});
+    bmp::Bitmap batch(512, 400), sequential(512, 400);
+    batch.draw_text(font, labels.data(), labels.size());
+    for (const bmp::TextLabel &label: labels)
+      sequential.draw_text(font, label.x, label.y, label.text, label.color, label.opacity);
+    if (batch != sequential) {
+      std::cerr << "Batched labels differ from sequential draw_text calls" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    bmp::Bitmap sample(120, 40);
+    sample.clear(bmp::Navy);
+    sample.draw_text(font, 8, 8, "BMP 2026-10-18\n12:30.45", bmp::Gold);
+    sample.draw_text(font, 9, 25, "-- 0123456789 --", bmp::White, 128);
+    sample.save(std::filesystem::path(BIN_DIR) / "text.bmp");
+
+    return EXIT_SUCCESS;
+  } catch (const bmp::Exception &e) {
+    std::cerr << "[BMP ERROR]: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
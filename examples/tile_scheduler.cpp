@@ -0,0 +1,105 @@
+#include "BitmapPlusPlus.hpp"
+#include "fractals/color_maps.inl"
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+static bmp::Pixel mandelbrot(const std::int32_t x, const std::int32_t y) {
+  const double cr = 3.0 * x / 400.0 - 2.1, ci = 2.4 * y / 300.0 - 1.2;
+  double zr = 0.0, zi = 0.0;
+  for (std::uint32_t i = 0; i < 500; ++i) {
+    const double t = zr * zr - zi * zi + cr;
+    zi = 2.0 * zr * zi + ci;
+    zr = t;
+    if (zr * zr + zi * zi > 4.0)
+      return jet_colormap[i * 2];
+  }
+  return bmp::Black;
+}
+
+int main() {
+  try {
+    bmp::Bitmap expected(400, 300);
+    expected.generate(mandelbrot);
+
+    // Every pixel is covered by exactly one tile for any thread count, and the result matches generate()
+    for (const std::size_t threads: {1, 4, 0}) {
+      bmp::set_thread_count(threads);
+      bmp::TileScheduler scheduler(48, 40);
+      bmp::Bitmap image(expected.width(), expected.height());
+      scheduler.generate(image, mandelbrot);
+      if (image != expected) {
+        std::cerr << "Tiled render on " << threads << " threads differs from generate()" << std::endl;
+        return EXIT_FAILURE;
+      }
+
+      std::vector<std::atomic<int>> covered(static_cast<std::size_t>(image.width()) * image.height());
+      scheduler.run(image.width(), image.height(), [&](const bmp::Tile &tile) {
+        for (std::int32_t y = tile.y; y < tile.y + tile.height; ++y)
+          for (std::int32_t x = tile.x; x < tile.x + tile.width; ++x)
+            ++covered[static_cast<std::size_t>(y) * image.width() + x];
+      });
+      if (std::any_of(covered.begin(), covered.end(), [](const std::atomic<int> &count) { return count != 1; })) {
+        std::cerr << "Tiles on " << threads << " threads do not cover every pixel once" << std::endl;
+        return EXIT_FAILURE;
+      }
+
+      // 9 x 8 tiles, the last column and row clipped, scheduled in Z order: (0,0) (1,0) (0,1) (1,1) (2,0) ...
+      const std::vector<bmp::TileTiming> &timings = scheduler.timings();
+      const std::int32_t expected_x[] = {0, 48, 0, 48, 96}, expected_y[] = {0, 0, 40, 40, 0};
+      for (std::size_t i = 0; i < std::size(expected_x); ++i) {
+        if (timings.size() != 72 || timings[i].tile.x != expected_x[i] || timings[i].tile.y != expected_y[i]) {
+          std::cerr << "Tile " << i << " is not scheduled in Morton order" << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+      for (const bmp::TileTiming &timing: timings) {
+        if (timing.seconds < 0.0 || timing.worker >= bmp::thread_count() ||
+            timing.tile.width != (timing.tile.x == 384 ? 16 : 48) || timing.tile.height != (timing.tile.y == 280 ? 20 : 40)) {
+          std::cerr << "Timing of tile " << timing.tile.x << ", " << timing.tile.y << " is wrong" << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+    }
+    bmp::set_thread_count(0);
+
+    // Kernels over the pixels of a tile see the rows of that tile only
+    bmp::TileScheduler scheduler(32, 32);
+    bmp::Bitmap image(expected.width(), expected.height());
+    scheduler.run(image, [](const bmp::Tile &tile, const bmp::PixelRows<bmp::Pixel> rows) {
+      for (const bmp::PixelRow<bmp::Pixel> row: rows)
+        for (std::int32_t i = 0; i < row.size(); ++i)
+          row[i] = mandelbrot(tile.x + i, row.y());
+    });
+    if (image != expected) {
+      std::cerr << "Tile rows address the wrong pixels" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    try {
+      bmp::TileScheduler empty(0, 16);
+      std::cerr << "Empty tiles were accepted" << std::endl;
+      return EXIT_FAILURE;
+    } catch (const bmp::Exception &) {
+    }
+
+    // Heat map of the time spent per tile: the hotspots are the tiles inside the set
+    double slowest = 0.0;
+    for (const bmp::TileTiming &timing: scheduler.timings())
+      slowest = std::max(slowest, timing.seconds);
+    bmp::Bitmap heat(image.width(), image.height());
+    for (const bmp::TileTiming &timing: scheduler.timings()) {
+      const auto level = static_cast<std::size_t>(999.0 * timing.seconds / std::max(slowest, 1e-12));
+      heat.fill_rect(timing.tile.x, timing.tile.y, timing.tile.width, timing.tile.height, hot_colormap[level]);
+    }
+    heat.blend(image.view(), 0, 0, bmp::BlendMode::Normal, 96);
+    heat.save(std::filesystem::path(BIN_DIR) / "tile_scheduler.bmp");
+
+    return EXIT_SUCCESS;
+  } catch (const bmp::Exception &e) {
+    std::cerr << "[BMP ERROR]: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -0,0 +1,46 @@
+#include "BitmapPlusPlus.hpp"
+#include <filesystem>
+#include <iostream>
+
+int main() {
+  try {
+    bmp::Bitmap image;
+    image.load(std::filesystem::path(ROOT_DIR) / "images" / "penguin.bmp");
+
+    // Normalization chain: flip, rotate and crop fused into one pass, streamed straight into the file
+    const bmp::TransformView view = image.transform().flip_h().rotate_90_right().crop(20, 10, 200, 150);
+    view.save(std::filesystem::path(BIN_DIR) / "penguin_normalized.bmp");
+
+    // The lazy chain must produce the same pixels as the eager one
+    const bmp::Bitmap eager = image.flip_h().rotate_90_right();
+    bmp::Bitmap expected(200, 150);
+    for (std::int32_t y = 0; y < expected.height(); ++y)
+      for (std::int32_t x = 0; x < expected.width(); ++x)
+        expected.set(x, y, eager.get(x + 20, y + 10));
+
+    bmp::Bitmap lazy(view.width(), view.height());
+    view.evaluate(lazy);
+    if (lazy != expected) {
+      std::cerr << "Fused transform does not match the eager transform chain" << std::endl;
+      return EXIT_FAILURE;
+    }
+    bmp::Bitmap streamed;
+    streamed.load(std::filesystem::path(BIN_DIR) / "penguin_normalized.bmp");
+    if (streamed != expected) {
+      std::cerr << "Streamed transform file does not match the eager transform chain" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    // Longer chains collapse to a single mapping as well
+    if (image.transform().rotate_90_left().flip_v().rotate_90_left().flip_h().rotate_90_right().to_bitmap() !=
+        image.rotate_90_left().flip_v().rotate_90_left().flip_h().rotate_90_right()) {
+      std::cerr << "Fused transform chain does not match the eager transform chain" << std::endl;
+      return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+  } catch (const bmp::Exception &e) {
+    std::cerr << "[BMP ERROR]: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
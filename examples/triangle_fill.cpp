@@ -0,0 +1,76 @@
+#include "BitmapPlusPlus.hpp"
+#include <filesystem>
+#include <iostream>
+#include <random>
+
+// Pixel (x, y) is covered when it is strictly inside, or on a top or left edge of the triangle
+static bool covered(std::int64_t x1, std::int64_t y1, std::int64_t x2, std::int64_t y2, std::int64_t x3,
+                    std::int64_t y3, const std::int64_t x, const std::int64_t y) {
+  if ((x2 - x1) * (y3 - y1) - (y2 - y1) * (x3 - x1) < 0) {
+    std::swap(x2, x3);
+    std::swap(y2, y3);
+  }
+  const std::int64_t xs[3] = {x1, x2, x3}, ys[3] = {y1, y2, y3};
+  for (int i = 0; i < 3; ++i) {
+    const std::int64_t a = ys[i] - ys[(i + 1) % 3], b = xs[(i + 1) % 3] - xs[i];
+    const std::int64_t e = a * (x - xs[i]) + b * (y - ys[i]);
+    const bool top_left = a > 0 || (a == 0 && b > 0);
+    if (e < 0 || (e == 0 && !top_left))
+      return false;
+  }
+  return true;
+}
+
+int main() {
+  try {
+    // Random triangles match a per pixel evaluation of the edge functions
+    std::mt19937 rng(33);
+    std::uniform_int_distribution<std::int32_t> coordinate(0, 63);
+    for (int i = 0; i < 500; ++i) {
+      const std::int32_t x1 = coordinate(rng), y1 = coordinate(rng), x2 = coordinate(rng), y2 = coordinate(rng);
+      const std::int32_t x3 = coordinate(rng), y3 = coordinate(rng);
+      bmp::Bitmap image(64, 64);
+      image.fill_triangle(x1, y1, x2, y2, x3, y3, bmp::White);
+      for (std::int32_t y = 0; y < 64; ++y) {
+        for (std::int32_t x = 0; x < 64; ++x) {
+          if ((image.get(x, y) == bmp::White) != covered(x1, y1, x2, y2, x3, y3, x, y)) {
+            std::cerr << "Triangle " << i << " differs at " << x << ", " << y << std::endl;
+            return EXIT_FAILURE;
+          }
+        }
+      }
+    }
+
+    // A fan of triangles around a shared center tiles the square without gaps or overlap
+    bmp::Bitmap counts(256, 256);
+    const std::int32_t fan[][2] = {{10, 10}, {245, 10}, {245, 245}, {10, 245}};
+    for (int i = 0; i < 4; ++i) {
+      bmp::Bitmap triangle(256, 256);
+      triangle.fill_triangle(128, 120, fan[i][0], fan[i][1], fan[(i + 1) % 4][0], fan[(i + 1) % 4][1], bmp::White);
+      for (std::int32_t y = 0; y < 256; ++y)
+        for (std::int32_t x = 0; x < 256; ++x)
+          if (triangle.get(x, y) == bmp::White)
+            counts.set(x, y, bmp::Pixel(0, 0, static_cast<std::uint8_t>(counts.get(x, y).b + 1)));
+    }
+    for (std::int32_t y = 0; y < 256; ++y) {
+      for (std::int32_t x = 0; x < 256; ++x) {
+        const int expected = (x >= 10 && x < 245 && y >= 10 && y < 245) ? 1 : 0;
+        if (counts.get(x, y).b != expected) {
+          std::cerr << "Pixel " << x << ", " << y << " covered " << +counts.get(x, y).b << " times" << std::endl;
+          return EXIT_FAILURE;
+        }
+      }
+    }
+
+    // Large triangles are rasterized in bands across the thread pool
+    bmp::Bitmap image(1024, 1024);
+    image.fill_triangle(512, 0, 0, 1023, 1023, 900, bmp::Crimson);
+    image.fill_triangle_clipped(-400, 100, 1500, 300, 200, 1400, bmp::Teal);
+    image.save(std::filesystem::path(BIN_DIR) / "triangle_fill.bmp");
+
+    return EXIT_SUCCESS;
+  } catch (const bmp::Exception &e) {
+    std::cerr << "[BMP ERROR]: " << e.what() << std::endl;
+    return EXIT_FAILURE;
+  }
+}
@@ -11,6 +11,36 @@
 #include <filesystem> // std::filesystem::path
 #include <stdexcept>  // std::runtime_error
 #include <utility>    // std::exchange
+#include <cmath>      // std::floor, std::sin
+#include <atomic>     // std::atomic
+#include <thread>     // std::thread
+#include <mutex>      // std::mutex
+#include <condition_variable> // std::condition_variable
+#include <functional> // std::function
+#include <exception>  // std::exception_ptr
+#include <limits>     // std::numeric_limits
+#include <string_view> // std::string_view
+#include <cassert>    // assert
+#include <iterator>   // std::forward_iterator_tag
+#include <chrono>     // std::chrono::steady_clock
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BPP_SSE2 1
+#include <emmintrin.h> // _mm_storeu_si128
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h> // _BitScanForward64
+#endif
+
+// Keeps rarely taken error paths, such as building exception messages, out of inlined hot functions
+#if defined(__GNUC__) || defined(__clang__)
+#define BPP_COLD __attribute__((noinline, cold))
+#elif defined(_MSC_VER)
+#define BPP_COLD __declspec(noinline)
+#else
+#define BPP_COLD
+#endif
 
 namespace bmp {
   // Magic number for Bitmap .bmp 24 bpp files (24/8 = 3 = rgb colors only)
@@ -107,551 +137,5732 @@ namespace bmp {
     }
   };
 
-  class Bitmap {
-  public:
-    Bitmap() noexcept : m_pixels(), m_width(0), m_height(0) {
-    }
-
-    explicit Bitmap(const std::string &filename) : m_pixels(), m_width(0), m_height(0) {
-      this->load(filename);
-    }
+  /**
+   * Resampling filters supported by Bitmap::resize
+   */
+  enum class ResizeFilter {
+    Nearest,  /* Nearest neighbour, no filtering */
+    Bilinear, /* Triangle filter, widened when downscaling */
+    Area,     /* Box filter averaging every covered source pixel */
+    Lanczos3  /* Windowed sinc with 3 lobes, sharpest */
+  };
 
-    Bitmap(const std::int32_t width, const std::int32_t height)
-      : m_pixels(static_cast<std::size_t>(width) * static_cast<std::size_t>(height)),
-        m_width(width),
-        m_height(height) {
-      if (width == 0 || height == 0)
-        throw Exception("Bitmap width and height must be > 0");
-    }
+  /**
+   * 2D affine transform in pixel coordinates mapping (x, y) to (a*x + b*y + c, d*x + e*y + f).
+   * Pixel (x, y) has its center at (x, y).
+   */
+  struct AffineTransform {
+    double a{1.0}, b{0.0}, c{0.0};
+    double d{0.0}, e{1.0}, f{0.0};
 
-    Bitmap(const Bitmap &other) = default; // Copy Constructor
+    [[nodiscard]] static constexpr AffineTransform identity() noexcept { return {}; }
 
-    Bitmap(Bitmap &&other) noexcept
-      : m_pixels(std::move(other.m_pixels)),
-        m_width(std::exchange(other.m_width, 0)),
-        m_height(std::exchange(other.m_height, 0)) {
+    [[nodiscard]] static constexpr AffineTransform translation(const double tx, const double ty) noexcept {
+      return {1.0, 0.0, tx, 0.0, 1.0, ty};
     }
 
-    virtual ~Bitmap() noexcept = default;
+    [[nodiscard]] static constexpr AffineTransform scaling(const double sx, const double sy) noexcept {
+      return {sx, 0.0, 0.0, 0.0, sy, 0.0};
+    }
 
-  public: /* Draw Primitives */
     /**
-     * Draw a line form (x1, y1) to (x2, y2)
+     * Clockwise rotation (y axis points down) by `degrees` around the origin
      */
-    void draw_line(std::int32_t x1, std::int32_t y1, std::int32_t x2, std::int32_t y2, const Pixel color) {
-      const std::int32_t dx = std::abs(x2 - x1);
-      const std::int32_t dy = std::abs(y2 - y1);
-      const std::int32_t sx = (x1 < x2) ? 1 : -1;
-      const std::int32_t sy = (y1 < y2) ? 1 : -1;
-      std::int32_t err = dx - dy;
-      while (true) {
-        m_pixels[IX(x1, y1)] = color;
-
-        if (x1 == x2 && y1 == y2) {
-          break;
-        }
-
-        int e2 = 2 * err;
-        if (e2 > -dy) {
-          err -= dy;
-          x1 += sx;
-        }
-        if (e2 < dx) {
-          err += dx;
-          y1 += sy;
-        }
-      }
+    [[nodiscard]] static AffineTransform rotation(const double degrees) noexcept {
+      constexpr double pi = 3.14159265358979323846;
+      const double radians = degrees * pi / 180.0;
+      const double cos = std::cos(radians);
+      const double sin = std::sin(radians);
+      return {cos, -sin, 0.0, sin, cos, 0.0};
     }
 
     /**
-     * Draw a filled rect
+     * Clockwise rotation by `degrees` around the point (cx, cy)
      */
-    void fill_rect(const std::int32_t x, const std::int32_t y, const std::int32_t width, const std::int32_t height,
-                   const Pixel color) {
-      if (!in_bounds(x, y) || !in_bounds(x + (width - 1), y + (height - 1)))
-        throw Exception(
-          "Bitmap::fill_rect(" + std::to_string(x) + ", " + std::to_string(y) + ", " + std::to_string(width) + ", " +
-          std::to_string(height) + "): x,y,w or h out of bounds");
-
-      for (std::int32_t dx = x; dx < x + width; ++dx) {
-        for (std::int32_t dy = y; dy < y + height; ++dy) {
-          m_pixels[IX(dx, dy)] = color;
-        }
-      }
+    [[nodiscard]] static AffineTransform rotation(const double degrees, const double cx, const double cy) noexcept {
+      return translation(cx, cy) * rotation(degrees) * translation(-cx, -cy);
     }
 
     /**
-     * Draw a rect (not filled, border only)
+     * Composition: (A * B) applies B first, then A
      */
-    void draw_rect(const std::int32_t x, const std::int32_t y, const std::int32_t width, const std::int32_t height,
-                   const Pixel color) {
-      if (!in_bounds(x, y) || !in_bounds(x + (width - 1), y + (height - 1)))
-        throw Exception(
-          "Bitmap::draw_rect(" + std::to_string(x) + ", " + std::to_string(y) + ", " + std::to_string(width) + ", " +
-          std::to_string(height) + "): x,y,w or h out of bounds");
-
-      for (std::int32_t dx = x; dx < x + width; ++dx) {
-        m_pixels[IX(dx, y)] = color;              // top
-        m_pixels[IX(dx, y + height - 1)] = color; // bottom
-      }
-      for (std::int32_t dy = y; dy < y + height; ++dy) {
-        m_pixels[IX(x, dy)] = color;             // left
-        m_pixels[IX(x + width - 1, dy)] = color; // right
-      }
+    [[nodiscard]] constexpr AffineTransform operator*(const AffineTransform &o) const noexcept {
+      return {a * o.a + b * o.d, a * o.b + b * o.e, a * o.c + b * o.f + c,
+              d * o.a + e * o.d, d * o.b + e * o.e, d * o.c + e * o.f + f};
     }
 
-
     /**
-     * Draw a triangle (not filled, border only)
+     * Returns the inverse transform
+     *   @throws bmp::Exception if the transform is singular
      */
-    void draw_triangle(const std::int32_t x1, const std::int32_t y1,
-                       const std::int32_t x2, const std::int32_t y2,
-                       const std::int32_t x3, const std::int32_t y3,
-                       const Pixel color) {
-      if (!in_bounds(x1, y1) || !in_bounds(x2, y2) || !in_bounds(x3, y3))
-        throw Exception("Bitmap::draw_triangle: One or more points are out of bounds");
-
-      draw_line(x1, y1, x2, y2, color);
-      draw_line(x2, y2, x3, y3, color);
-      draw_line(x3, y3, x1, y1, color);
+    [[nodiscard]] AffineTransform inverse() const {
+      const double det = a * e - b * d;
+      if (std::abs(det) < 1e-12)
+        throw Exception("AffineTransform::inverse: transform is not invertible");
+      const double inv = 1.0 / det;
+      return {e * inv, -b * inv, (b * f - e * c) * inv,
+              -d * inv, a * inv, (d * c - a * f) * inv};
     }
+  };
 
-    /**
-     * Draw a filled triangle
-     */
-    void fill_triangle(const std::int32_t x1, const std::int32_t y1,
-                       const std::int32_t x2, const std::int32_t y2,
-                       const std::int32_t x3, const std::int32_t y3,
-                       const Pixel color) {
-      if (!in_bounds(x1, y1) || !in_bounds(x2, y2) || !in_bounds(x3, y3))
-        throw Exception("Bitmap::fill_triangle: One or more points are out of bounds");
+  /**
+   * Blend modes used when compositing a source over a destination pixel, per channel with s the
+   * source and d the destination value in [0, 255]
+   */
+  enum class BlendMode {
+    Normal,    /* s (Porter-Duff source over) */
+    Add,       /* min(s + d, 255) */
+    Subtract,  /* max(d - s, 0) */
+    Multiply,  /* s * d / 255 */
+    Screen,    /* 255 - (255 - s) * (255 - d) / 255 */
+    Darken,    /* min(s, d) */
+    Lighten,   /* max(s, d) */
+    Difference /* |s - d| */
+  };
 
-      // Sort the vertices by y-coordinate (top to bottom)
-      std::vector<std::pair<std::int32_t, std::int32_t> > vertices = {
-        {x1, y1},
-        {x2, y2},
-        {x3, y3}};
-      std::sort(vertices.begin(), vertices.end(), [](const auto &a, const auto &b) {
-        return a.second < b.second;
-      });
+  /**
+   * Rules deciding which points are inside a polygon with several or self intersecting contours
+   */
+  enum class FillRule {
+    EvenOdd, /* Inside when a ray from the point crosses the contours an odd number of times */
+    NonZero  /* Inside when the contours wind around the point a non zero number of times */
+  };
+
+  /**
+   * Shape of a stroke where two of its segments meet
+   */
+  enum class LineJoin {
+    Miter, /* Outer edges extended until they meet, beveled when the miter limit is exceeded */
+    Bevel, /* Outer corners connected by a straight edge */
+    Round  /* Circular arc around the vertex */
+  };
 
-      const auto [x_top, y_top] = vertices[0];
-      const auto [x_mid, y_mid] = vertices[1];
-      const auto [x_bot, y_bot] = vertices[2];
+  /**
+   * Shape of a stroke at the ends of an open polyline
+   */
+  enum class LineCap {
+    Butt,   /* Stroke ends at the end point */
+    Square, /* Stroke extended by half its width past the end point */
+    Round   /* Half disc around the end point */
+  };
 
-      // Calculate the slopes of the left and right edges
-      const float slope_left = static_cast<float>(x_mid - x_top) / (y_mid - y_top);
-      const float slope_right = static_cast<float>(x_bot - x_top) / (y_bot - y_top);
+  /**
+   * How Bitmap::draw_polyline and its siblings outline a path
+   */
+  struct StrokeStyle {
+    float width{1.0f};
+    LineJoin join{LineJoin::Miter};
+    LineCap cap{LineCap::Butt};
+    /* Longest allowed ratio between the miter length and the stroke width, as in SVG */
+    float miter_limit{4.0f};
+  };
 
-      // Initialize the starting and ending x-coordinates for each scanline
-      std::vector<std::pair<std::int32_t, std::int32_t> > scanlines(y_mid - y_top + 1);
-      for (std::int32_t y = y_top; y <= y_mid; ++y) {
-        const auto x_start = static_cast<std::int32_t>(x_top + (y - y_top) * slope_left);
-        const auto x_end = static_cast<std::int32_t>(x_top + (y - y_top) * slope_right);
-        scanlines[y - y_top] = {x_start, x_end};
-      }
+  /**
+   * Neighbourhood through which flood_fill spreads
+   */
+  enum class Connectivity {
+    Four, /* Left, right, up and down neighbours */
+    Eight /* Diagonal neighbours as well */
+  };
 
-      // Fill the upper part of the triangle
-      for (std::int32_t y = y_top; y <= y_mid; ++y) {
-        const std::int32_t x_start = scanlines[y - y_top].first;
-        const std::int32_t x_end = scanlines[y - y_top].second;
-        draw_line(x_start, y, x_end, y, color);
-      }
+  /**
+   * Source rectangle of an atlas and the destination position it is copied to by Bitmap::blit
+   */
+  struct Sprite {
+    std::int32_t source_x{0};
+    std::int32_t source_y{0};
+    std::int32_t width{0};
+    std::int32_t height{0};
+    std::int32_t x{0};
+    std::int32_t y{0};
+  };
 
-      // Update the slope for the right edge of the triangle
-      const float new_slope_right = static_cast<float>(x_bot - x_mid) / (y_bot - y_mid);
+  /**
+   * Point with sub-pixel precision. Pixel (x, y) has its center at (x, y).
+   */
+  struct PointF {
+    float x{0.0f};
+    float y{0.0f};
+  };
 
-      // Update the x-coordinates for the scanlines in the lower part of the triangle
-      for (std::int32_t y = y_mid + 1; y <= y_bot; ++y) {
-        const auto x_start = static_cast<std::int32_t>(x_mid + (y - y_mid) * slope_left);
-        const auto x_end = static_cast<std::int32_t>(x_top + (y - y_top) * new_slope_right);
-        scanlines[y - y_top] = {x_start, x_end};
-      }
+  /**
+   * Horizontal run of `width` pixels starting at (x, y)
+   */
+  struct Span {
+    std::int32_t x{0};
+    std::int32_t y{0};
+    std::int32_t width{0};
+  };
 
-      // Fill the lower part of the triangle
-      for (std::int32_t y = y_mid + 1; y <= y_bot; ++y) {
-        const std::int32_t x_start = scanlines[y - y_top].first;
-        const std::int32_t x_end = scanlines[y - y_top].second;
-        draw_line(x_start, y, x_end, y, color);
-      }
+  /**
+   * Colors of a gradient along its position t in [0, 1]: `start` blended into `end`, or, when
+   * `colormap` is set, entry floor(t * colormap_size) of that table (such as the color maps of the
+   * fractal examples). Positions before 0 and past 1 take the color of the nearest end.
+   */
+  struct Gradient {
+    Pixel start{};
+    Pixel end{};
+    const Pixel *colormap{nullptr};
+    std::size_t colormap_size{0};
+  };
+
+  /**
+   * Escape time fractals drawn by FractalRenderer
+   */
+  enum class FractalType {
+    Mandelbrot, /* z -> z^2 + c from z = 0, with c the pixel */
+    Julia       /* z -> z^2 + c from z = the pixel, with c = (julia_x, julia_y) */
+  };
+
+  /**
+   * View, iteration limit and coloring of a fractal. Pixels are square: the image spans `width` along
+   * the real axis around (center_x, center_y), with the imaginary axis pointing up. Escaped points take
+   * the color of `colors` at their smooth iteration count divided by `color_period` (wrapping around),
+   * or by max_iterations when color_period is 0. Points that never escape take `inside`.
+   * The periodicity and interior checks stop iterating points found to be inside the set early.
+   */
+  struct FractalParams {
+    FractalType type{FractalType::Mandelbrot};
+    double center_x{-0.5};
+    double center_y{0.0};
+    double width{3.0};
+    double julia_x{-0.7};
+    double julia_y{0.27015};
+    std::uint32_t max_iterations{256};
+    Gradient colors{Pixel(0, 7, 100), Pixel(255, 255, 255)};
+    Pixel inside{};
+    double color_period{0.0};
+    bool periodicity_check{true}; /* Points whose orbit returns to a saved value are in a cycle */
+    bool interior_check{true};    /* Points of the main cardioid and period 2 bulb (Mandelbrot only) */
+  };
+
+  /**
+   * Reductions used to build each level of a Pyramid from the previous one
+   */
+  enum class PyramidFilter {
+    Box,    /* Average of each 2x2 block */
+    Nearest /* Top left pixel of each 2x2 block */
+  };
+
+  namespace detail {
+    /**
+     * Throws the exception of an accessor called with x,y out of bounds
+     */
+    [[noreturn]] BPP_COLD inline void throw_out_of_bounds(const char *function, const std::int32_t x, const std::int32_t y) {
+      throw Exception(std::string(function) + "(" + std::to_string(x) + ", " + std::to_string(y) + "): x,y out of bounds");
     }
 
     /**
-     * Draw a circle with a given center and radius
+     * Per thread scratch buffer which keeps its capacity between calls so hot paths do not allocate.
+     * Tag distinguishes buffers of the same type used at the same time.
      */
-    void draw_circle(const std::int32_t center_x, const std::int32_t center_y, const std::int32_t radius,
-                     const Pixel color) {
-      if (!in_bounds(center_x - radius, center_y - radius) || !in_bounds(center_x + radius, center_y + radius))
-        throw Exception("Bitmap::draw_circle: Circle exceeds bounds");
+    template<typename Tag, typename T>
+    std::vector<T> &scratch() {
+      thread_local std::vector<T> buffer;
+      return buffer;
+    }
+
+    /**
+     * Persistent pool of worker threads shared by every parallel algorithm of the library.
+     * Tasks are handed out one index at a time from an atomic counter (dynamic scheduling)
+     * and the calling thread takes part in the work. Calls made from inside a task, while
+     * another thread is already using the pool, or when the pool has no workers run serially
+     * on the calling thread.
+     */
+    class ThreadPool {
+    public:
+      static ThreadPool &instance() {
+        static ThreadPool pool;
+        return pool;
+      }
+
+      ThreadPool(const ThreadPool &) = delete;
+      ThreadPool &operator=(const ThreadPool &) = delete;
+
+      ~ThreadPool() noexcept {
+        stop();
+      }
 
-      std::int32_t x = radius;
-      std::int32_t y = 0;
-      std::int32_t err = 0;
+      /**
+       * Number of threads taking part in run(), including the calling thread
+       */
+      [[nodiscard]] std::size_t concurrency() const noexcept { return m_concurrency.load(std::memory_order_relaxed); }
 
-      while (x >= y) {
-        // Draw pixels in all octants
-        m_pixels[IX(center_x + x, center_y + y)] = color;
-        m_pixels[IX(center_x + y, center_y + x)] = color;
-        m_pixels[IX(center_x - y, center_y + x)] = color;
-        m_pixels[IX(center_x - x, center_y + y)] = color;
-        m_pixels[IX(center_x - x, center_y - y)] = color;
-        m_pixels[IX(center_x - y, center_y - x)] = color;
-        m_pixels[IX(center_x + y, center_y - x)] = color;
-        m_pixels[IX(center_x + x, center_y - y)] = color;
+      /**
+       * Replaces the workers so that `threads` threads take part in run(), the calling thread included.
+       * 1 leaves no workers, 0 starts one thread per hardware thread. Waits for a run() in progress on
+       * another thread to finish.
+       *   @throws bmp::Exception when called from inside a task
+       */
+      void resize(const std::size_t threads) {
+        if (inside_pool())
+          throw Exception("bmp::set_thread_count: cannot change the thread count from inside a parallel task");
+        std::lock_guard<std::mutex> dispatch(m_dispatch);
+        stop();
+        start(threads == 0 ? hardware_workers() : threads - 1);
+      }
 
-        // Update error and y for the next pixel
-        if (err <= 0) {
-          y += 1;
-          err += 2 * y + 1;
+      /**
+       * Calls task(i) for every i in [0, count) and blocks until all of them returned.
+       * The first exception thrown by a task is rethrown on the calling thread.
+       */
+      void run(const std::size_t count, const std::function<void(std::size_t)> &task) {
+        if (count == 0)
+          return;
+        if (count == 1 || inside_pool()) {
+          for (std::size_t i = 0; i < count; ++i) task(i);
+          return;
+        }
+        std::unique_lock<std::mutex> dispatch(m_dispatch, std::try_to_lock);
+        if (!dispatch.owns_lock() || m_workers.empty()) {
+          for (std::size_t i = 0; i < count; ++i) task(i);
+          return;
         }
 
-        // Update error and x for the next pixel
-        if (err > 0) {
-          x -= 1;
-          err -= 2 * x + 1;
+        {
+          std::lock_guard<std::mutex> lock(m_mutex);
+          m_task = &task;
+          m_count = count;
+          m_next.store(0, std::memory_order_relaxed);
+          m_error = nullptr;
+          m_active = m_workers.size();
+          ++m_generation;
         }
+        m_wake.notify_all();
+
+        inside_pool() = true;
+        work();
+        inside_pool() = false;
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_done.wait(lock, [this] { return m_active == 0; });
+        m_task = nullptr;
+        if (m_error)
+          std::rethrow_exception(std::exchange(m_error, nullptr));
       }
-    }
 
-    /**
-     * Fill a circle with a given center and radius
-     */
-    void fill_circle(const std::int32_t center_x, const std::int32_t center_y, const std::int32_t radius,
-                     const Pixel color) {
-      if (!in_bounds(center_x - radius, center_y - radius) || !in_bounds(center_x + radius, center_y + radius))
-        throw Exception("Bitmap::fill_circle: Circle exceeds bounds");
+    private:
+      ThreadPool() {
+        start(hardware_workers());
+      }
 
-      std::int32_t x = radius;
-      std::int32_t y = 0;
-      std::int32_t err = 0;
+      static std::size_t hardware_workers() noexcept {
+        const unsigned int hardware = std::thread::hardware_concurrency();
+        return hardware > 1 ? hardware - 1 : 0;
+      }
 
-      while (x >= y) {
-        // Fill scanlines in all octants
-        for (std::int32_t i = center_x - x; i <= center_x + x; ++i) {
-          m_pixels[IX(i, center_y + y)] = color;
-          m_pixels[IX(i, center_y - y)] = color;
-        }
+      void start(const std::size_t workers) {
+        m_stop = false;
+        m_workers.reserve(workers);
+        // New workers only wake up for runs started after them
+        for (std::size_t i = 0; i < workers; ++i)
+          m_workers.emplace_back([this, seen = m_generation] { worker_loop(seen); });
+        m_concurrency.store(workers + 1, std::memory_order_relaxed);
+      }
 
-        for (std::int32_t i = center_x - y; i <= center_x + y; ++i) {
-          m_pixels[IX(i, center_y + x)] = color;
-          m_pixels[IX(i, center_y - x)] = color;
+      void stop() noexcept {
+        {
+          std::lock_guard<std::mutex> lock(m_mutex);
+          m_stop = true;
         }
+        m_wake.notify_all();
+        for (std::thread &worker: m_workers)
+          worker.join();
+        m_workers.clear();
+        m_concurrency.store(1, std::memory_order_relaxed);
+      }
+
+      static bool &inside_pool() noexcept {
+        thread_local bool inside = false;
+        return inside;
+      }
 
-        // Update error and y for the next pixel
-        if (err <= 0) {
-          y += 1;
-          err += 2 * y + 1;
+      void worker_loop(std::uint64_t seen) {
+        inside_pool() = true;
+        while (true) {
+          {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&] { return m_stop || m_generation != seen; });
+            if (m_stop)
+              return;
+            seen = m_generation;
+          }
+          work();
+          {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (--m_active == 0)
+              m_done.notify_one();
+          }
         }
+      }
 
-        // Update error and x for the next pixel
-        if (err > 0) {
-          x -= 1;
-          err -= 2 * x + 1;
+      void work() {
+        for (std::size_t i = m_next.fetch_add(1, std::memory_order_relaxed); i < m_count;
+             i = m_next.fetch_add(1, std::memory_order_relaxed)) {
+          try {
+            (*m_task)(i);
+          } catch (...) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_error)
+              m_error = std::current_exception();
+          }
         }
       }
-    }
 
-  public: /* Accessors */
+    private:
+      std::vector<std::thread> m_workers;
+      std::atomic<std::size_t> m_concurrency{1};
+      std::mutex m_dispatch; // Held by the thread currently driving run() or resize()
+      std::mutex m_mutex;
+      std::condition_variable m_wake;
+      std::condition_variable m_done;
+      const std::function<void(std::size_t)> *m_task{nullptr};
+      std::size_t m_count{0};
+      std::atomic<std::size_t> m_next{0};
+      std::size_t m_active{0};
+      std::uint64_t m_generation{0};
+      std::exception_ptr m_error;
+      bool m_stop{false};
+    };
+
     /**
-     *	Get pixel at position x,y
+     * Writes `count` copies of `color` starting at `dst`. Longer spans repeat a 48 byte pattern
+     * (16 pixels, the smallest multiple of 3 bytes that is a whole number of 16 byte vectors)
+     * with three wide unaligned stores per iteration.
      */
-    Pixel &get(const std::int32_t x, const std::int32_t y) {
-      if (!in_bounds(x, y))
-        throw Exception("Bitmap::get(" + std::to_string(x) + ", " + std::to_string(y) + "): x,y out of bounds");
-      return m_pixels[IX(x, y)];
+    inline void fill_span(Pixel *dst, const std::size_t count, const Pixel color) noexcept {
+      if (count < 16) {
+        for (std::size_t i = 0; i < count; ++i) dst[i] = color;
+        return;
+      }
+      alignas(16) std::uint8_t pattern[48];
+      for (std::size_t i = 0; i < 16; ++i)
+        std::memcpy(pattern + i * sizeof(Pixel), &color, sizeof(Pixel));
+
+      auto *out = reinterpret_cast<std::uint8_t *>(dst);
+      const std::size_t blocks = count / 16;
+#ifdef BPP_SSE2
+      const __m128i p0 = _mm_load_si128(reinterpret_cast<const __m128i *>(pattern));
+      const __m128i p1 = _mm_load_si128(reinterpret_cast<const __m128i *>(pattern + 16));
+      const __m128i p2 = _mm_load_si128(reinterpret_cast<const __m128i *>(pattern + 32));
+      for (std::size_t b = 0; b < blocks; ++b, out += 48) {
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out), p0);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 16), p1);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 32), p2);
+      }
+#else
+      for (std::size_t b = 0; b < blocks; ++b, out += 48)
+        std::memcpy(out, pattern, sizeof(pattern));
+#endif
+      std::memcpy(out, pattern, (count % 16) * sizeof(Pixel));
     }
 
     /**
-     *	Get const pixel at position x,y
+     * x / 255 rounded to nearest, exact for every x in [0, 255 * 255]
      */
-    [[nodiscard]] const Pixel &get(const std::int32_t x, const std::int32_t y) const {
-      if (!in_bounds(x, y))
-        throw Exception("Bitmap::get(" + std::to_string(x) + ", " + std::to_string(y) + "): x,y out of bounds");
-      return m_pixels[IX(x, y)];
+    [[nodiscard]] constexpr std::uint8_t div255(const std::uint32_t x) noexcept {
+      return static_cast<std::uint8_t>((x + 128 + ((x + 128) >> 8)) >> 8);
     }
 
     /**
-     *	Returns the width of the Bitmap image
+     * Blends `src` over `dst` with an alpha in [0, 255]: alpha 0 keeps dst, 255 gives src
      */
-    [[nodiscard]] std::int32_t width() const noexcept { return m_width; }
+    [[nodiscard]] constexpr Pixel blend(const Pixel dst, const Pixel src, const std::uint8_t alpha) noexcept {
+      const std::uint32_t inverse = 255u - alpha;
+      return {div255(dst.r * inverse + src.r * alpha),
+              div255(dst.g * inverse + src.g * alpha),
+              div255(dst.b * inverse + src.b * alpha)};
+    }
 
+#ifdef BPP_SSE2
     /**
-     *	Returns the height of the Bitmap image
+     * (d * (255 - a) + f * a) / 255 with exact rounding for 16 byte lanes
      */
-    [[nodiscard]] std::int32_t height() const noexcept { return m_height; }
+    inline __m128i lerp_epu8(const __m128i d, const __m128i f, const __m128i a) noexcept {
+      const __m128i zero = _mm_setzero_si128();
+      const __m128i ones = _mm_set1_epi16(255);
+      const __m128i half = _mm_set1_epi16(128);
+      const auto lerp16 = [&](const __m128i d16, const __m128i f16, const __m128i a16) {
+        __m128i x = _mm_add_epi16(_mm_mullo_epi16(d16, _mm_sub_epi16(ones, a16)), _mm_mullo_epi16(f16, a16));
+        x = _mm_add_epi16(x, half);
+        return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+      };
+      const __m128i lo = lerp16(_mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi8(f, zero), _mm_unpacklo_epi8(a, zero));
+      const __m128i hi = lerp16(_mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi8(f, zero), _mm_unpackhi_epi8(a, zero));
+      return _mm_packus_epi16(lo, hi);
+    }
 
     /**
-     *	Clears Bitmap pixels with an rgb color
+     * a * b / 255 with exact rounding for 16 byte lanes
      */
-    void clear(const Pixel pixel = Black) {
-      std::fill(m_pixels.begin(), m_pixels.end(), pixel);
+    inline __m128i multiply_epu8(const __m128i a, const __m128i b) noexcept {
+      const __m128i zero = _mm_setzero_si128();
+      const __m128i half = _mm_set1_epi16(128);
+      const auto multiply16 = [&](const __m128i a16, const __m128i b16) {
+        const __m128i x = _mm_add_epi16(_mm_mullo_epi16(a16, b16), half);
+        return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+      };
+      return _mm_packus_epi16(multiply16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero)),
+                              multiply16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero)));
     }
+#endif
 
-  public: /* Operators */
-    const Pixel &operator[](const std::size_t i) const { return m_pixels[i]; }
-
-    Pixel &operator[](const std::size_t i) { return m_pixels[i]; }
-
-    bool operator!() const noexcept { return (m_pixels.empty()) || (m_width == 0) || (m_height == 0); }
-
-    explicit operator bool() const noexcept { return !(*this); }
+    /**
+     * Blends `color` over `count` pixels, pixel i with alpha coverage[i].
+     * The SSE2 path blends 16 pixels (48 bytes) per iteration with the same exact rounding as blend().
+     */
+    inline void blend_span(Pixel *dst, const std::uint8_t *coverage, const std::size_t count, const Pixel color) noexcept {
+      std::size_t i = 0;
+#ifdef BPP_SSE2
+      if (count >= 16) {
+        alignas(16) std::uint8_t pattern[48];
+        for (std::size_t k = 0; k < 16; ++k)
+          std::memcpy(pattern + k * sizeof(Pixel), &color, sizeof(Pixel));
+        for (; i + 16 <= count; i += 16) {
+          // Each group of 4 alphas becomes 3 words of r, g, b replicated alphas, built in registers
+          // rather than through byte stores that would stall the vector loads
+          std::uint32_t words[12];
+          for (std::size_t k = 0; k < 4; ++k) {
+            const std::uint32_t a0 = coverage[i + 4 * k], a1 = coverage[i + 4 * k + 1];
+            const std::uint32_t a2 = coverage[i + 4 * k + 2], a3 = coverage[i + 4 * k + 3];
+            words[3 * k] = a0 * 0x010101u | a1 << 24;
+            words[3 * k + 1] = a1 * 0x0101u | a2 * 0x010000u | a2 << 24;
+            words[3 * k + 2] = a2 | a3 * 0x01010100u;
+          }
+          auto *out = reinterpret_cast<std::uint8_t *>(dst + i);
+          for (std::size_t v = 0; v < 3; ++v) {
+            const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(out + 16 * v));
+            const __m128i s = _mm_load_si128(reinterpret_cast<const __m128i *>(pattern + 16 * v));
+            const __m128i a = _mm_set_epi32(static_cast<int>(words[4 * v + 3]), static_cast<int>(words[4 * v + 2]),
+                                            static_cast<int>(words[4 * v + 1]), static_cast<int>(words[4 * v]));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 16 * v), lerp_epu8(d, s, a));
+          }
+        }
+      }
+#endif
+      for (; i < count; ++i)
+        dst[i] = blend(dst[i], color, coverage[i]);
+    }
 
-    bool operator==(const Bitmap &image) const {
-      if (this == std::addressof(image)) {
-        return true;
+    /**
+     * Scales `count` coverage values by opacity / 255 in place, 16 at a time with SSE2
+     */
+    inline void scale_coverage(std::uint8_t *coverage, const std::size_t count, const std::uint8_t opacity) noexcept {
+      std::size_t i = 0;
+#ifdef BPP_SSE2
+      const __m128i scale = _mm_set1_epi8(static_cast<char>(opacity));
+      for (; i + 16 <= count; i += 16) {
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(coverage + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(coverage + i), multiply_epu8(c, scale));
       }
-      return (m_width == image.m_width) &&
-             (m_height == image.m_height) &&
-             (std::memcmp(m_pixels.data(), image.m_pixels.data(), sizeof(Pixel) * m_pixels.size()) == 0);
+#endif
+      for (; i < count; ++i)
+        coverage[i] = div255(static_cast<std::uint32_t>(coverage[i]) * opacity);
     }
 
-    bool operator!=(const Bitmap &image) const { return !(*this == image); }
+    /**
+     * Blend mode function of one channel
+     */
+    template<BlendMode Mode>
+    [[nodiscard]] constexpr std::uint8_t blend_channel(const std::uint8_t s, const std::uint8_t d) noexcept {
+      if constexpr (Mode == BlendMode::Normal) return s;
+      else if constexpr (Mode == BlendMode::Add) return static_cast<std::uint8_t>(std::min(s + d, 255));
+      else if constexpr (Mode == BlendMode::Subtract) return static_cast<std::uint8_t>(std::max(d - s, 0));
+      else if constexpr (Mode == BlendMode::Multiply) return div255(static_cast<std::uint32_t>(s) * d);
+      else if constexpr (Mode == BlendMode::Screen) return static_cast<std::uint8_t>(255 - div255(static_cast<std::uint32_t>(255 - s) * (255 - d)));
+      else if constexpr (Mode == BlendMode::Darken) return std::min(s, d);
+      else if constexpr (Mode == BlendMode::Lighten) return std::max(s, d);
+      else return static_cast<std::uint8_t>(s > d ? s - d : d - s);
+    }
 
-    Bitmap &operator=(const Bitmap &image) // Copy assignment operator
-    {
-      if (this != std::addressof(image)) {
-        m_width = image.m_width;
-        m_height = image.m_height;
-        m_pixels = image.m_pixels;
+#ifdef BPP_SSE2
+    /**
+     * Blend mode function of 16 byte lanes, identical to blend_channel
+     */
+    template<BlendMode Mode>
+    inline __m128i blend_channels(const __m128i s, const __m128i d) noexcept {
+      if constexpr (Mode == BlendMode::Normal) return s;
+      else if constexpr (Mode == BlendMode::Add) return _mm_adds_epu8(s, d);
+      else if constexpr (Mode == BlendMode::Subtract) return _mm_subs_epu8(d, s);
+      else if constexpr (Mode == BlendMode::Multiply) return multiply_epu8(s, d);
+      else if constexpr (Mode == BlendMode::Screen) {
+        const __m128i ones = _mm_set1_epi8(static_cast<char>(0xff));
+        return _mm_xor_si128(multiply_epu8(_mm_xor_si128(s, ones), _mm_xor_si128(d, ones)), ones);
       }
-      return *this;
+      else if constexpr (Mode == BlendMode::Darken) return _mm_min_epu8(s, d);
+      else if constexpr (Mode == BlendMode::Lighten) return _mm_max_epu8(s, d);
+      else return _mm_or_si128(_mm_subs_epu8(s, d), _mm_subs_epu8(d, s));
     }
+#endif
 
-    Bitmap &operator=(Bitmap &&image) noexcept {
-      if (this != std::addressof(image)) {
-        m_pixels = std::move(image.m_pixels);
-        m_width = std::exchange(image.m_width, 0);
-        m_height = std::exchange(image.m_height, 0);
+    /**
+     * Composites `count` source pixels over `dst` with the blend mode `Mode`. Pixel i is mixed with
+     * alpha[i] * opacity / 255, or with `opacity` alone when `alpha` is null.
+     */
+    template<BlendMode Mode>
+    void composite_span(Pixel *dst, const Pixel *src, const std::uint8_t *alpha, const std::uint8_t opacity,
+                        const std::size_t count) noexcept {
+      const auto alpha_at = [&](const std::size_t i) {
+        return alpha == nullptr ? opacity : (opacity == 255 ? alpha[i] : div255(static_cast<std::uint32_t>(alpha[i]) * opacity));
+      };
+      std::size_t i = 0;
+#ifdef BPP_SSE2
+      alignas(16) std::uint8_t alphas[48];
+      if (alpha == nullptr)
+        std::memset(alphas, opacity, sizeof(alphas));
+      for (; i + 16 <= count; i += 16) {
+        if (alpha != nullptr)
+          for (std::size_t k = 0; k < 16; ++k)
+            alphas[3 * k] = alphas[3 * k + 1] = alphas[3 * k + 2] = alpha_at(i + k);
+        auto *out = reinterpret_cast<std::uint8_t *>(dst + i);
+        const auto *in = reinterpret_cast<const std::uint8_t *>(src + i);
+        for (std::size_t v = 0; v < 48; v += 16) {
+          const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(out + v));
+          const __m128i s = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + v));
+          const __m128i a = _mm_load_si128(reinterpret_cast<const __m128i *>(alphas + v));
+          _mm_storeu_si128(reinterpret_cast<__m128i *>(out + v), lerp_epu8(d, blend_channels<Mode>(s, d), a));
+        }
+      }
+#endif
+      for (; i < count; ++i) {
+        const Pixel d = dst[i], s = src[i];
+        const Pixel mixed{blend_channel<Mode>(s.r, d.r), blend_channel<Mode>(s.g, d.g), blend_channel<Mode>(s.b, d.b)};
+        dst[i] = blend(d, mixed, alpha_at(i));
       }
-      return *this;
     }
 
-  public: /** foreach iterators access */
-    [[nodiscard]] std::vector<Pixel>::iterator begin() noexcept { return m_pixels.begin(); }
-
-    [[nodiscard]] std::vector<Pixel>::iterator end() noexcept { return m_pixels.end(); }
-
-    [[nodiscard]] std::vector<Pixel>::const_iterator cbegin() const noexcept { return m_pixels.cbegin(); }
+    /**
+     * Copies `count` pixels from `src` to `dst`, skipping pixels equal to `key`.
+     * The SSE2 path compares 16 pixels (48 bytes) at once: blocks without a key pixel are stored
+     * whole, fully transparent blocks are skipped and mixed blocks are merged with a byte mask.
+     */
+    inline void copy_keyed(Pixel *dst, const Pixel *src, const std::size_t count, const Pixel key) noexcept {
+      std::size_t i = 0;
+#ifdef BPP_SSE2
+      if (count >= 16) {
+        alignas(16) std::uint8_t pattern[48];
+        for (std::size_t k = 0; k < 16; ++k)
+          std::memcpy(pattern + k * sizeof(Pixel), &key, sizeof(Pixel));
+        const __m128i keys[3] = {_mm_load_si128(reinterpret_cast<const __m128i *>(pattern)),
+                                 _mm_load_si128(reinterpret_cast<const __m128i *>(pattern + 16)),
+                                 _mm_load_si128(reinterpret_cast<const __m128i *>(pattern + 32))};
+        const __m128i bits = _mm_set_epi8(-128, 64, 32, 16, 8, 4, 2, 1, -128, 64, 32, 16, 8, 4, 2, 1);
+        constexpr std::uint64_t first_bytes = 0x249249249249ull; // Bit 3k marks the first byte of pixel k
+        for (; i + 16 <= count; i += 16) {
+          const auto *in = reinterpret_cast<const std::uint8_t *>(src + i);
+          auto *out = reinterpret_cast<std::uint8_t *>(dst + i);
+          __m128i v[3];
+          std::uint64_t equal = 0;
+          for (int k = 0; k < 3; ++k) {
+            v[k] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + 16 * k));
+            equal |= static_cast<std::uint64_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v[k], keys[k]))) << (16 * k);
+          }
+          const std::uint64_t transparent = equal & (equal >> 1) & (equal >> 2) & first_bytes;
+          if (transparent == first_bytes)
+            continue;
+          if (transparent == 0) {
+            for (int k = 0; k < 3; ++k)
+              _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 16 * k), v[k]);
+            continue;
+          }
+          const std::uint64_t keep = ~(transparent | (transparent << 1) | (transparent << 2));
+          for (int k = 0; k < 3; ++k) {
+            const auto lanes = static_cast<std::uint16_t>(keep >> (16 * k));
+            const __m128i spread = _mm_unpacklo_epi64(_mm_set1_epi8(static_cast<char>(lanes & 0xff)),
+                                                      _mm_set1_epi8(static_cast<char>(lanes >> 8)));
+            const __m128i mask = _mm_cmpeq_epi8(_mm_and_si128(spread, bits), bits);
+            const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(out + 16 * k));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(out + 16 * k),
+                             _mm_or_si128(_mm_and_si128(mask, v[k]), _mm_andnot_si128(mask, d)));
+          }
+        }
+      }
+#endif
+      for (; i < count; ++i)
+        if (src[i] != key)
+          dst[i] = src[i];
+    }
 
-    [[nodiscard]] std::vector<Pixel>::const_iterator cend() const noexcept { return m_pixels.cend(); }
+    /**
+     * Non horizontal polygon edge covering scanlines [first, last), x(y) = x0 + (y - y0) * slope
+     */
+    struct PolygonEdge {
+      double x0, y0, slope;
+      std::int32_t first, last;
+      std::int32_t winding;
+    };
 
-    [[nodiscard]] std::vector<Pixel>::reverse_iterator rbegin() noexcept { return m_pixels.rbegin(); }
+    /**
+     * Edge crossing the current scanline at x
+     */
+    struct ActiveEdge {
+      double x;
+      std::int32_t winding;
+      std::uint32_t edge;
+    };
 
-    [[nodiscard]] std::vector<Pixel>::reverse_iterator rend() noexcept { return m_pixels.rend(); }
+    /* Scratch tags of the polygon edge tables */
+    struct PolygonEdges;
+    struct PolygonActiveEdges;
 
-    [[nodiscard]] std::vector<Pixel>::const_reverse_iterator crbegin() const noexcept { return m_pixels.crbegin(); }
+    /**
+     * Double precision point of a stroke piece
+     */
+    struct StrokePoint {
+      double x, y;
+    };
 
-    [[nodiscard]] std::vector<Pixel>::const_reverse_iterator crend() const noexcept { return m_pixels.crend(); }
+    /* Scratch tags of the deduplicated stroke vertices, contour sizes and segment directions, the piece
+       being built, the extent of a piece on each of its rows and the coverage mask of the stroke */
+    struct StrokeVertices;
+    struct StrokeContourSizes;
+    struct StrokeDirections;
+    struct StrokePiece;
+    struct StrokePieceBounds;
+    struct StrokeMask;
 
-  public: /* Modifiers */
     /**
-     *	Sets rgb color to pixel at position x,y
-     *   @throws bmp::Exception on error
+     * Index of the lowest set bit of a non zero word
      */
-    void set(const std::int32_t x, const std::int32_t y, const Pixel color) {
-      if (!in_bounds(x, y)) {
-        throw Exception("Bitmap::set(" + std::to_string(x) + ", " + std::to_string(y) + "): x,y out of bounds");
-      }
-      m_pixels[IX(x, y)] = color;
+    [[nodiscard]] inline std::int32_t count_trailing_zeros(const std::uint64_t word) noexcept {
+#if defined(__GNUC__) || defined(__clang__)
+      return __builtin_ctzll(word);
+#elif defined(_MSC_VER) && defined(_M_X64)
+      unsigned long index;
+      _BitScanForward64(&index, word);
+      return static_cast<std::int32_t>(index);
+#else
+      std::int32_t index = 0;
+      while (((word >> index) & 1u) == 0)
+        ++index;
+      return index;
+#endif
     }
 
-
     /**
-    *	Vertically flips the bitmap and returns the flipped version
-    *
-    */
-    [[nodiscard("Bitmap::flip_v() is immutable")]]
-    Bitmap flip_v() const {
-      Bitmap finished(m_width, m_height);
-      for (std::int32_t x = 0; x < m_width; ++x) {
-        for (std::int32_t y = 0; y < m_height; ++y) {
-          // Calculate the reverse y-index
-          finished.m_pixels[IX(x, y)] = m_pixels[IX(x, m_height - 1 - y)];
-        }
+     * Sets bits [x1, x2] of a row of 64 bit words
+     */
+    inline void set_bits(std::uint64_t *row, const std::int32_t x1, const std::int32_t x2) noexcept {
+      const std::int32_t first = x1 >> 6, last = x2 >> 6;
+      const std::uint64_t head = ~std::uint64_t{0} << (x1 & 63), tail = ~std::uint64_t{0} >> (63 - (x2 & 63));
+      if (first == last) {
+        row[first] |= head & tail;
+        return;
       }
-      return finished;
+      row[first] |= head;
+      std::fill(row + first + 1, row + last, ~std::uint64_t{0});
+      row[last] |= tail;
     }
 
     /**
-    *	Horizontally flips the bitmap and returns the flipped version
-    *
-    */
-    [[nodiscard("Bitmap::flip_h() is immutable")]]
-    Bitmap flip_h() const {
-      Bitmap finished(m_width, m_height);
-      for (std::int32_t y = 0; y < m_height; ++y) {
-        for (std::int32_t x = 0; x < m_width; ++x) {
-          // Calculate the reverse x-index
-          finished.m_pixels[IX(x, y)] = m_pixels[IX(m_width - 1 - x, y)];
+     * Calls run(x1, x2) for every maximal run [x1, x2] of set bits in words [first, last] of a row,
+     * clearing the words as it goes
+     */
+    template<typename Run>
+    void take_runs(std::uint64_t *row, const std::int32_t first, const std::int32_t last, Run &&run) {
+      std::int32_t run_x1 = 0, run_x2 = -2;
+      for (std::int32_t w = first; w <= last; ++w) {
+        std::uint64_t bits = row[w];
+        if (bits == 0)
+          continue;
+        row[w] = 0;
+        while (bits != 0) {
+          const std::int32_t start = count_trailing_zeros(bits);
+          const std::uint64_t rest = ~(bits >> start);
+          const std::int32_t length = rest == 0 ? 64 : count_trailing_zeros(rest);
+          const std::int32_t x1 = w * 64 + start, x2 = x1 + length - 1;
+          if (x1 == run_x2 + 1) {
+            run_x2 = x2;
+          } else {
+            if (run_x2 >= run_x1)
+              run(run_x1, run_x2);
+            run_x1 = x1, run_x2 = x2;
+          }
+          bits = start + length >= 64 ? 0 : bits & (~std::uint64_t{0} << (start + length));
         }
       }
-      return finished;
+      if (run_x2 >= run_x1)
+        run(run_x1, run_x2);
     }
 
     /**
-    *	Rotates the bitmap to the right and returns the rotated version
-    *
-    */
-    [[nodiscard("Bitmap::rotate_90_left() is immutable")]]
-    Bitmap rotate_90_left() const {
-      Bitmap finished(m_height, m_width); // Swap dimensions
+     * Splits the stroke of the polyline through `vertices` (no two consecutive ones equal) into
+     * convex pieces whose union is the stroke, calling piece(points, count) for each: a quadrilateral
+     * per segment, a join on the outer side of every interior vertex and a cap at each open end.
+     * Pieces entirely outside [0, width) x [0, height) are skipped.
+     */
+    template<typename Piece>
+    void stroke_pieces(const PointF *vertices, const std::size_t n, bool closed, const StrokeStyle &style,
+                       const std::int32_t width, const std::int32_t height, Piece &&piece) {
+      constexpr double pi = 3.14159265358979323846;
+      const double half = static_cast<double>(style.width) * 0.5;
+      if (!(half > 0.0) || n == 0)
+        return;
+      if (n < 3)
+        closed = false;
+
+      const auto at = [&](const std::size_t i) { return StrokePoint{vertices[i].x, vertices[i].y}; };
+      const auto next = [&](const std::size_t i) { return i + 1 == n ? 0 : i + 1; };
+      const auto visible = [&](const double x0, const double y0, const double x1, const double y1) {
+        return x1 >= -1.0 && y1 >= -1.0 && x0 <= width && y0 <= height;
+      };
+
+      std::vector<StrokePoint> &points = scratch<StrokePiece, StrokePoint>();
+      // Arcs are flattened so that chords stay within a quarter pixel of the circle
+      const double step = half > 0.25 ? std::max(std::acos(1.0 - 0.25 / half), pi / 128.0) : pi / 4.0;
+      // Points of the arc starting at center + half * from (a unit vector), rotated step by step
+      const auto arc = [&](const StrokePoint center, const StrokePoint from, const double sweep) {
+        const std::int32_t steps = std::max(static_cast<std::int32_t>(std::ceil(std::abs(sweep) / step)), 1);
+        const double cos = std::cos(sweep / steps), sin = std::sin(sweep / steps);
+        StrokePoint radius{from.x * half, from.y * half};
+        for (std::int32_t k = 0; k <= steps; ++k) {
+          points.push_back({center.x + radius.x, center.y + radius.y});
+          radius = {radius.x * cos - radius.y * sin, radius.x * sin + radius.y * cos};
+        }
+      };
+      const auto disc = [&](const StrokePoint center) {
+        if (!visible(center.x - half, center.y - half, center.x + half, center.y + half))
+          return;
+        points.clear();
+        arc(center, {1.0, 0.0}, 2.0 * pi);
+        piece(points.data(), points.size() - 1);
+      };
 
-      for (std::int32_t y = 0; y < m_height; ++y) {
-        const std::int32_t y_offset = y * m_width; // Precompute row start index
-        for (std::int32_t x = 0; x < m_width; ++x) {
-          // Original pixel at (x, y) moves to (y, m_width - 1 - x)
-          finished.m_pixels[(m_width - 1 - x) * m_height + y] = m_pixels[y_offset + x];
+      if (n == 1) {
+        const StrokePoint c = at(0);
+        if (style.cap == LineCap::Round) {
+          disc(c);
+        } else if (style.cap == LineCap::Square) {
+          const StrokePoint square[] = {{c.x - half, c.y - half}, {c.x + half, c.y - half},
+                                        {c.x + half, c.y + half}, {c.x - half, c.y + half}};
+          piece(square, 4);
         }
+        return;
       }
 
-      return finished;
+      // Unit direction of every segment, shared by the segment and the joins at both of its ends
+      const std::size_t segments = closed ? n : n - 1;
+      std::vector<StrokePoint> &directions = scratch<StrokeDirections, StrokePoint>();
+      directions.resize(segments);
+      for (std::size_t i = 0; i < segments; ++i) {
+        const StrokePoint a = at(i), b = at(next(i));
+        const double dx = b.x - a.x, dy = b.y - a.y, length = std::sqrt(dx * dx + dy * dy);
+        directions[i] = {dx / length, dy / length};
+      }
+
+      for (std::size_t i = 0; i < segments; ++i) {
+        StrokePoint a = at(i), b = at(next(i));
+        const StrokePoint d = directions[i];
+        if (!closed && style.cap == LineCap::Square) {
+          if (i == 0)
+            a = {a.x - d.x * half, a.y - d.y * half};
+          if (i + 1 == segments)
+            b = {b.x + d.x * half, b.y + d.y * half};
+        }
+        if (!visible(std::min(a.x, b.x) - half, std::min(a.y, b.y) - half, std::max(a.x, b.x) + half, std::max(a.y, b.y) + half))
+          continue;
+        const StrokePoint normal{-d.y * half, d.x * half};
+        const StrokePoint quad[] = {{a.x + normal.x, a.y + normal.y}, {b.x + normal.x, b.y + normal.y},
+                                    {b.x - normal.x, b.y - normal.y}, {a.x - normal.x, a.y - normal.y}};
+        piece(quad, 4);
+      }
+
+      // Joins fill the wedge between the outer corners of consecutive segments
+      const double reach = half * std::max(1.0, style.join == LineJoin::Miter ? static_cast<double>(style.miter_limit) : 1.0);
+      for (std::size_t i = closed ? 0 : 1; i < (closed ? n : n - 1); ++i) {
+        const StrokePoint p = at(i);
+        if (!visible(p.x - reach, p.y - reach, p.x + reach, p.y + reach))
+          continue;
+        const StrokePoint da = directions[i == 0 ? n - 1 : i - 1], db = directions[i];
+        const double cross = da.x * db.y - da.y * db.x, dot = da.x * db.x + da.y * db.y;
+        if (cross == 0.0 && dot > 0.0)
+          continue;
+        // The outer side is opposite to the direction the path turns to
+        const double side = cross > 0.0 ? -1.0 : 1.0;
+        const StrokePoint na{-da.y * side, da.x * side}, nb{-db.y * side, db.x * side};
+        points.clear();
+        points.push_back(p);
+        if (style.join == LineJoin::Round) {
+          arc(p, na, std::atan2(na.x * nb.y - na.y * nb.x, na.x * nb.x + na.y * nb.y));
+        } else {
+          points.push_back({p.x + na.x * half, p.y + na.y * half});
+          const StrokePoint sum{na.x + nb.x, na.y + nb.y};
+          const double length2 = sum.x * sum.x + sum.y * sum.y;
+          if (style.join == LineJoin::Miter && length2 > 0.0 && 2.0 <= style.miter_limit * std::sqrt(length2))
+            points.push_back({p.x + sum.x * 2.0 * half / length2, p.y + sum.y * 2.0 * half / length2});
+          points.push_back({p.x + nb.x * half, p.y + nb.y * half});
+        }
+        piece(points.data(), points.size());
+      }
+
+      if (!closed && style.cap == LineCap::Round) {
+        disc(at(0));
+        disc(at(n - 1));
+      }
     }
 
     /**
-    *	Rotates the bitmap to the left and returns the rotated version
-    *
-    */
-    [[nodiscard("Bitmap::rotate_90_right() is immutable")]]
-    Bitmap rotate_90_right() const {
-      Bitmap finished(m_height, m_width); // Swap dimensions
-      for (std::int32_t y = 0; y < m_height; ++y) {
-        const std::int32_t y_offset = y * m_width; // Precompute row start index
-        for (std::int32_t x = 0; x < m_width; ++x) {
-          finished.m_pixels[x * m_height + (m_height - 1 - y)] = m_pixels[y_offset + x];
-        }
+     * ceil(x) clamped to [low, high], avoiding the library call std::ceil compiles to without SSE4.1
+     */
+    [[nodiscard]] inline std::int32_t clamped_ceil(const double x, const std::int32_t low, const std::int32_t high) noexcept {
+      if (!(x > low))
+        return low;
+      if (x >= high)
+        return high;
+      const auto truncated = static_cast<std::int32_t>(x);
+      return truncated + (x > truncated ? 1 : 0);
+    }
+
+    /**
+     * Rows [first, last) whose pixel centers a convex piece covers, clipped to [0, height)
+     */
+    [[nodiscard]] inline std::pair<std::int32_t, std::int32_t> piece_rows(const StrokePoint *points, const std::size_t count,
+                                                                          const std::int32_t height) noexcept {
+      double top = points[0].y, bottom = points[0].y;
+      for (std::size_t i = 1; i < count; ++i) {
+        top = std::min(top, points[i].y);
+        bottom = std::max(bottom, points[i].y);
       }
+      return {clamped_ceil(top, 0, height), clamped_ceil(bottom, 0, height)};
+    }
 
-      return finished;
+    /**
+     * Number of chords keeping a curve whose second derivative never exceeds `curvature` in length
+     * within `tolerance` of its chords: the error of n uniform steps is at most curvature / (8 n^2)
+     */
+    [[nodiscard]] inline std::int32_t flattening_steps(const double curvature, const double tolerance) noexcept {
+      const double steps = std::ceil(std::sqrt(curvature / (8.0 * std::max(tolerance, 1e-3))));
+      return steps >= 1.0 && steps <= 65536.0 ? static_cast<std::int32_t>(steps) : (steps > 1.0 ? 65536 : 1);
     }
 
     /**
-     *	Saves Bitmap pixels into a file
-     *   @throws bmp::Exception on error
+     * Appends the quadratic Bezier curve from p0 through control p1 to p2, without p0, evaluated by
+     * forward differencing with steps chosen so that no chord strays more than `tolerance` from it
      */
-    void save(const std::filesystem::path &filename) const {
-      // Calculate row and bitmap size
-      const std::int32_t row_size = m_width * 3 + m_width % 4;
-      const std::uint32_t bitmap_size = row_size * m_height;
+    inline void flatten_quadratic(const PointF p0, const PointF p1, const PointF p2, const float tolerance,
+                                  std::vector<PointF> &out) {
+      // B(t) = a t^2 + b t + p0
+      const double ax = p0.x - 2.0 * p1.x + p2.x, ay = p0.y - 2.0 * p1.y + p2.y;
+      const double bx = 2.0 * (p1.x - p0.x), by = 2.0 * (p1.y - p0.y);
+      const std::int32_t steps = flattening_steps(2.0 * std::sqrt(ax * ax + ay * ay), tolerance);
+      const double h = 1.0 / steps;
+      double x = p0.x, y = p0.y;
+      double dx = ax * h * h + bx * h, dy = ay * h * h + by * h;
+      const double ddx = 2.0 * ax * h * h, ddy = 2.0 * ay * h * h;
+      for (std::int32_t i = 1; i < steps; ++i) {
+        x += dx, y += dy;
+        dx += ddx, dy += ddy;
+        out.push_back({static_cast<float>(x), static_cast<float>(y)});
+      }
+      out.push_back(p2);
+    }
 
-      // Construct bitmap header
-      BitmapHeader header{};
-      /* Bitmap file header structure */
-      header.magic = BITMAP_BUFFER_MAGIC;
-      header.file_size = bitmap_size + sizeof(BitmapHeader);
-      header.reserved1 = 0;
-      header.reserved2 = 0;
-      header.offset_bits = sizeof(BitmapHeader);
-      /* Bitmap file info structure */
-      header.size = 40;
-      header.width = m_width;
-      header.height = m_height;
-      header.planes = 1;
-      header.bits_per_pixel = sizeof(Pixel) * 8; // 24bpp
-      header.compression = 0;
-      header.size_image = bitmap_size;
-      header.x_pixels_per_meter = 0;
-      header.y_pixels_per_meter = 0;
-      header.clr_used = 0;
-      header.clr_important = 0;
+    /**
+     * Appends the cubic Bezier curve from p0 through controls p1 and p2 to p3, without p0, evaluated
+     * by forward differencing with steps chosen so that no chord strays more than `tolerance` from it
+     */
+    inline void flatten_cubic(const PointF p0, const PointF p1, const PointF p2, const PointF p3, const float tolerance,
+                              std::vector<PointF> &out) {
+      // B''(t) interpolates linearly between 6 (p0 - 2 p1 + p2) and 6 (p1 - 2 p2 + p3)
+      const double d0 = std::hypot(p0.x - 2.0 * p1.x + p2.x, p0.y - 2.0 * p1.y + p2.y);
+      const double d1 = std::hypot(p1.x - 2.0 * p2.x + p3.x, p1.y - 2.0 * p2.y + p3.y);
+      const std::int32_t steps = flattening_steps(6.0 * std::max(d0, d1), tolerance);
 
-      // Save bitmap to output file
-      if (std::ofstream ofs{filename, std::ios::binary}; ofs.good()) {
-        // Write Header
-        ofs.write(reinterpret_cast<const char *>(&header), sizeof(BitmapHeader));
-        if (!ofs.good()) {
-          throw Exception("Bitmap::save(\"" + filename.string() + "\"): Failed to write bitmap header to file.");
+      // B(t) = a t^3 + b t^2 + c t + p0
+      const double ax = -p0.x + 3.0 * (p1.x - p2.x) + p3.x, ay = -p0.y + 3.0 * (p1.y - p2.y) + p3.y;
+      const double bx = 3.0 * (p0.x - 2.0 * p1.x + p2.x), by = 3.0 * (p0.y - 2.0 * p1.y + p2.y);
+      const double cx = 3.0 * (p1.x - p0.x), cy = 3.0 * (p1.y - p0.y);
+      const double h = 1.0 / steps, h2 = h * h, h3 = h2 * h;
+      double x = p0.x, y = p0.y;
+      double dx = ax * h3 + bx * h2 + cx * h, dy = ay * h3 + by * h2 + cy * h;
+      double ddx = 6.0 * ax * h3 + 2.0 * bx * h2, ddy = 6.0 * ay * h3 + 2.0 * by * h2;
+      const double dddx = 6.0 * ax * h3, dddy = 6.0 * ay * h3;
+      for (std::int32_t i = 1; i < steps; ++i) {
+        x += dx, y += dy;
+        dx += ddx, dy += ddy;
+        ddx += dddx, ddy += dddy;
+        out.push_back({static_cast<float>(x), static_cast<float>(y)});
+      }
+      out.push_back(p3);
+    }
+
+    /**
+     * Point at `angle` radians on the ellipse with radii (rx, ry) around center, rotated by the angle
+     * whose cosine and sine are given
+     */
+    [[nodiscard]] inline PointF ellipse_point(const PointF center, const double rx, const double ry, const double angle,
+                                              const double cos, const double sin) noexcept {
+      const double x = rx * std::cos(angle), y = ry * std::sin(angle);
+      return {static_cast<float>(center.x + x * cos - y * sin), static_cast<float>(center.y + x * sin + y * cos)};
+    }
+
+    /**
+     * Appends the elliptical arc around center from angle `start` over `sweep` radians (positive is
+     * clockwise with y down), without its first point. The ellipse is rotated by `rotation` radians.
+     */
+    inline void flatten_arc(const PointF center, const double rx, const double ry, const double start, const double sweep,
+                            const double rotation, const float tolerance, std::vector<PointF> &out) {
+      // A chord spanning angle a of a circle of radius r strays r (1 - cos(a / 2)) from it
+      const double radius = std::max(std::abs(rx), std::abs(ry));
+      const double ratio = 1.0 - std::max(static_cast<double>(tolerance), 1e-3) / std::max(radius, 1e-9);
+      const double max_angle = ratio > 0.0 ? 2.0 * std::acos(ratio) : 1.5707963267948966;
+      const double count = std::ceil(std::abs(sweep) / max_angle);
+      const std::int32_t steps = count >= 1.0 && count <= 65536.0 ? static_cast<std::int32_t>(count) : (count > 1.0 ? 65536 : 1);
+
+      // Rotate the unit vector (cos t, sin t) by a fixed step instead of evaluating sin and cos per point
+      const double step_cos = std::cos(sweep / steps), step_sin = std::sin(sweep / steps);
+      const double cos = std::cos(rotation), sin = std::sin(rotation);
+      double ux = std::cos(start), uy = std::sin(start);
+      for (std::int32_t i = 1; i < steps; ++i) {
+        const double x = ux * step_cos - uy * step_sin;
+        uy = ux * step_sin + uy * step_cos;
+        ux = x;
+        const double ex = rx * ux, ey = ry * uy;
+        out.push_back({static_cast<float>(center.x + ex * cos - ey * sin), static_cast<float>(center.y + ex * sin + ey * cos)});
+      }
+      out.push_back(ellipse_point(center, rx, ry, start + sweep, cos, sin));
+    }
+
+    /**
+     * Pixel packed into an integer so that it compares with a single instruction
+     */
+    [[nodiscard]] constexpr std::uint32_t pack(const Pixel &pixel) noexcept {
+      return static_cast<std::uint32_t>(pixel.r) | (static_cast<std::uint32_t>(pixel.g) << 8) |
+             (static_cast<std::uint32_t>(pixel.b) << 16);
+    }
+
+    /**
+     * Pixel of a value made by pack()
+     */
+    [[nodiscard]] constexpr Pixel unpack(const std::uint32_t packed) noexcept {
+      return {static_cast<std::uint8_t>(packed), static_cast<std::uint8_t>(packed >> 8), static_cast<std::uint8_t>(packed >> 16)};
+    }
+
+    /* Number of table entries blending the two colors of a gradient without a colormap */
+    static constexpr std::int32_t GRADIENT_RAMP_SIZE = 256;
+
+    /* Scratch tag of the color table of a gradient */
+    struct GradientTable;
+
+    /**
+     * Color table of `gradient`, every entry a color packed with pack(). Blended ramps have
+     * GRADIENT_RAMP_SIZE entries, so that every entry differs from its neighbours by at most one
+     * per channel.
+     *   @throws bmp::Exception when the colormap has no entries or more than 2^24
+     */
+    inline const std::vector<std::uint32_t> &gradient_table(const Gradient &gradient) {
+      std::vector<std::uint32_t> &table = scratch<GradientTable, std::uint32_t>();
+      if (gradient.colormap != nullptr) {
+        if (gradient.colormap_size == 0 || gradient.colormap_size > (std::size_t{1} << 24))
+          throw Exception("Gradient colormap has " + std::to_string(gradient.colormap_size) +
+                          " entries, expected 1 to 16777216");
+        table.resize(gradient.colormap_size);
+        for (std::size_t i = 0; i < gradient.colormap_size; ++i)
+          table[i] = pack(gradient.colormap[i]);
+        return table;
+      }
+      table.resize(GRADIENT_RAMP_SIZE);
+      const Pixel a = gradient.start, b = gradient.end;
+      for (std::uint32_t i = 0; i < static_cast<std::uint32_t>(GRADIENT_RAMP_SIZE); ++i) {
+        const std::uint32_t inverse = 255u - i;
+        table[i] = pack(Pixel(div255(a.r * inverse + b.r * i), div255(a.g * inverse + b.g * i), div255(a.b * inverse + b.b * i)));
+      }
+      return table;
+    }
+
+    /**
+     * Position u of pixel centers along a gradient, counted in color table entries: u = offset + x * ax + y * ay
+     * for linear gradients and u = scale * |(x, y) - (cx, cy)| for radial ones. Pixel (x, y) takes table entry
+     * floor(u) clamped to the table.
+     */
+    struct GradientGeometry {
+      bool radial{false};
+      double offset{0.0}, ax{0.0}, ay{0.0};
+      double cx{0.0}, cy{0.0}, scale{0.0};
+    };
+
+    /**
+     * Linear gradient running from `from` (t = 0) to `to` (t = 1) over a table of `size` entries.
+     * Every pixel takes the end color when both points coincide.
+     */
+    [[nodiscard]] inline GradientGeometry linear_gradient(const PointF from, const PointF to, const std::int32_t size) noexcept {
+      GradientGeometry geometry;
+      const double dx = static_cast<double>(to.x) - from.x, dy = static_cast<double>(to.y) - from.y;
+      const double length2 = dx * dx + dy * dy;
+      if (length2 == 0.0) {
+        geometry.offset = size;
+        return geometry;
+      }
+      geometry.ax = dx * size / length2;
+      geometry.ay = dy * size / length2;
+      geometry.offset = -(from.x * geometry.ax + from.y * geometry.ay);
+      return geometry;
+    }
+
+    /**
+     * Radial gradient from `center` (t = 0) to the circle of `radius` around it (t = 1) over a table of
+     * `size` entries. Every pixel takes the end color when the radius is not positive.
+     */
+    [[nodiscard]] inline GradientGeometry radial_gradient(const PointF center, const float radius, const std::int32_t size) noexcept {
+      GradientGeometry geometry;
+      if (!(radius > 0.0f)) {
+        geometry.offset = size;
+        return geometry;
+      }
+      geometry.radial = true;
+      geometry.cx = center.x;
+      geometry.cy = center.y;
+      geometry.scale = size / static_cast<double>(radius);
+      return geometry;
+    }
+
+    /**
+     * Writes table[index[i]] to pixel i of a 16 pixel block with overlapping 4 byte stores, each one's
+     * spare byte overwritten by the next. This beats packing the colors into vectors, whose inserts cost
+     * more than the stores they save.
+     */
+    inline void store_indexed_block(Pixel *dst, const std::uint32_t *table, const std::int32_t *index) noexcept {
+      auto *out = reinterpret_cast<std::uint8_t *>(dst);
+      for (std::size_t k = 0; k < 15; ++k)
+        std::memcpy(out + k * sizeof(Pixel), table + index[k], sizeof(std::uint32_t));
+      std::memcpy(out + 15 * sizeof(Pixel), table + index[15], sizeof(Pixel));
+    }
+
+    /**
+     * Colors pixels [x1, x2] of row y, `row` pointing at pixel 0 of that row, with a gradient and its color
+     * table of `size` entries. The runs before and past the gradient are constant and written with fill_span.
+     * Along the ramp between them linear gradients step a 32.32 fixed point position and radial ones take
+     * four square roots at a time, and the colors are stored 16 pixels at a time.
+     */
+    inline void shade_gradient_row(Pixel *row, const std::int32_t x1, const std::int32_t x2, const std::int32_t y,
+                                   const GradientGeometry &geometry, const std::uint32_t *table, const std::int32_t size) noexcept {
+      const std::int32_t count = x2 - x1 + 1;
+      if (count <= 0)
+        return;
+      const Pixel first = unpack(table[0]), last = unpack(table[size - 1]);
+      Pixel *dst = row + x1;
+
+      // Pixels [ramp_first, ramp_last) lie inside the gradient, those before take `before` and those after `after`
+      std::int32_t ramp_first = 0, ramp_last = 0;
+      Pixel before = last, after = last;
+      double u0 = 0.0, du = 0.0;
+      if (geometry.radial) {
+        const double dy = y - geometry.cy, reach = size / geometry.scale;
+        if (dy * dy < reach * reach) {
+          const double half = std::sqrt(reach * reach - dy * dy);
+          ramp_first = -clamped_ceil(x1 - geometry.cx + half, -count, 0);
+          ramp_last = clamped_ceil(geometry.cx + half - x1, ramp_first, count);
         }
+      } else {
+        u0 = geometry.offset + geometry.ax * x1 + geometry.ay * y;
+        du = geometry.ax;
+        if (du == 0.0) {
+          Pixel color = u0 < 0.0 ? first : last;
+          if (u0 >= 0.0 && u0 < size)
+            color = unpack(table[static_cast<std::int32_t>(u0)]);
+          fill_span(dst, static_cast<std::size_t>(count), color);
+          return;
+        }
+        // u crosses 0 and size at these offsets from x1, the ramp lies between them
+        const double at_start = -u0 / du, at_end = (size - u0) / du;
+        ramp_first = -clamped_ceil(-std::min(at_start, at_end), -count, 0);
+        ramp_last = clamped_ceil(std::max(at_start, at_end), ramp_first, count);
+        before = du > 0.0 ? first : last;
+        after = du > 0.0 ? last : first;
+      }
+      fill_span(dst, static_cast<std::size_t>(ramp_first), before);
+      fill_span(dst + ramp_last, static_cast<std::size_t>(count - ramp_last), after);
 
-        // Write Pixels
-        std::vector<std::uint8_t> line(row_size);
-        for (std::int32_t y = m_height - 1; y >= 0; --y) {
-          std::size_t i = 0;
-          for (std::int32_t x = 0; x < m_width; ++x) {
-            const Pixel &color = m_pixels[IX(x, y)];
-            line[i++] = color.b;
-            line[i++] = color.g;
-            line[i++] = color.r;
+      // Indices of the ramp, 16 at a time, then stored as colors
+      alignas(16) std::int32_t index[16];
+      const std::int32_t top = size - 1;
+      std::int32_t i = ramp_first;
+      if (geometry.radial) {
+        const float cx = static_cast<float>(geometry.cx), dy = static_cast<float>(y - geometry.cy);
+        const float scale = static_cast<float>(geometry.scale);
+#ifdef BPP_SSE2
+        const __m128 center = _mm_set1_ps(cx), dy2 = _mm_set1_ps(dy * dy), factor = _mm_set1_ps(scale);
+        const __m128 limit = _mm_set1_ps(static_cast<float>(top)), four = _mm_set1_ps(4.0f);
+#endif
+        while (i < ramp_last) {
+          const std::int32_t block = std::min(16, ramp_last - i);
+          const float x = static_cast<float>(x1 + i);
+#ifdef BPP_SSE2
+          // Pixel x coordinates are exact integers in float, so stepping them accumulates no error
+          __m128 xs = _mm_setr_ps(x, x + 1.0f, x + 2.0f, x + 3.0f);
+          for (std::int32_t k = 0; k < 16; k += 4, xs = _mm_add_ps(xs, four)) {
+            const __m128 dx = _mm_sub_ps(xs, center);
+            const __m128 u = _mm_mul_ps(_mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(dx, dx), dy2)), factor);
+            _mm_store_si128(reinterpret_cast<__m128i *>(index + k), _mm_cvttps_epi32(_mm_min_ps(u, limit)));
           }
-          ofs.write(reinterpret_cast<const char *>(line.data()), line.size());
-          if (!ofs.good()) {
-            throw Exception("Bitmap::save(\"" + filename.string() + "\"): Failed to write bitmap pixels to file.");
+#else
+          for (std::int32_t k = 0; k < block; ++k) {
+            const float dx = x + static_cast<float>(k) - cx;
+            index[k] = static_cast<std::int32_t>(std::min(std::sqrt(dx * dx + dy * dy) * scale, static_cast<float>(top)));
           }
+#endif
+          if (block == 16) {
+            store_indexed_block(dst + i, table, index);
+          } else {
+            for (std::int32_t k = 0; k < block; ++k)
+              dst[i + k] = unpack(table[index[k]]);
+          }
+          i += block;
         }
-      } else
-        throw Exception("Bitmap::save(\"" + filename.string() + "\"): Failed to open file.");
+        return;
+      }
+
+      // Positions are anchored on columns that are multiples of 16, so a pixel gets the same color whatever span
+      // it is shaded with. Ramps steeper than 2^16 entries per pixel cover a couple of pixels at most and are
+      // positioned in double instead.
+      constexpr double ONE = 4294967296.0;
+      const double row_u = geometry.offset + geometry.ay * y;
+      const bool fixed = std::abs(du) < 65536.0;
+      const std::int64_t step = fixed ? static_cast<std::int64_t>(du * ONE) : 0;
+      const std::int64_t limit = (static_cast<std::int64_t>(size) << 32) - 1;
+      while (i < ramp_last) {
+        const std::int32_t x = x1 + i, anchor = x & ~15;
+        const std::int32_t block = std::min(16 - (x - anchor), ramp_last - i);
+        if (fixed) {
+          const std::int64_t position = static_cast<std::int64_t>((row_u + du * anchor) * ONE) + (x - anchor) * step;
+          const std::int64_t end = position + (block - 1) * step;
+          if (std::min(position, end) >= 0 && std::max(position, end) <= limit) {
+            for (std::int32_t k = 0; k < block; ++k)
+              index[k] = static_cast<std::int32_t>((position + k * step) >> 32);
+          } else {
+            for (std::int32_t k = 0; k < block; ++k)
+              index[k] = static_cast<std::int32_t>(std::clamp<std::int64_t>((position + k * step) >> 32, 0, top));
+          }
+        } else {
+          for (std::int32_t k = 0; k < block; ++k)
+            index[k] = static_cast<std::int32_t>(std::clamp(row_u + du * (x + k), 0.0, static_cast<double>(top)));
+        }
+        if (block == 16) {
+          store_indexed_block(dst + i, table, index);
+        } else {
+          for (std::int32_t k = 0; k < block; ++k)
+            dst[i + k] = unpack(table[index[k]]);
+        }
+        i += block;
+      }
     }
 
     /**
-     *	Loads Bitmap from file
-     *   @throws bmp::Exception on error
+     * Row segment [x1, x2] of row y waiting to be scanned by flood_fill
      */
-    void load(const std::filesystem::path &filename) {
-      m_pixels.clear();
+    struct FillSpan {
+      std::int32_t x1, x2, y;
+    };
 
-      if (std::ifstream ifs{filename, std::ios::binary}; ifs.good()) {
-        // Read Header
-        std::unique_ptr<BitmapHeader> header(new BitmapHeader());
-        ifs.read(reinterpret_cast<char *>(header.get()), sizeof(BitmapHeader));
+    /* Scratch tags of the flood fill span stack and visited mask */
+    struct FloodFillSpans;
+    struct FloodFillVisited;
 
-        // Check if Bitmap file is valid
-        if (header->magic != BITMAP_BUFFER_MAGIC) {
-          throw Exception("Bitmap::load(\"" + filename.string() + "\"): Unrecognized file format.");
+    /* Scratch tag of the copy made when a bitmap blits from itself */
+    struct BlitSource;
+
+    /* Scratch tag of the copy made when a bitmap is tiled with a view of its own pixels */
+    struct PatternTile;
+
+    /* Scratch tags of the glyph indices of a text line and of the row below every label in a text batch */
+    struct TextGlyphCodes;
+    struct TextLabelBottoms;
+
+    /**
+     * Converts a coverage fraction (clamped to [0, 1]) to an alpha in [0, 255]
+     */
+    [[nodiscard]] inline std::uint8_t coverage_alpha(const float coverage) noexcept {
+      return static_cast<std::uint8_t>(std::min(std::max(coverage, 0.0f), 1.0f) * 255.0f + 0.5f);
+    }
+
+    /**
+     * Adds the signed area of segment (x0, y0)-(x1, y1), y0 < y1, to a coverage accumulation buffer
+     * of rows of `stride` cells. After a running sum along each row, every cell holds the signed
+     * coverage of its pixel (the accumulation scheme of font-rs and stb_truetype).
+     */
+    inline void accumulate_segment(float *accumulation, const std::size_t stride, const float x0, const float y0,
+                                   const float x1, const float y1, const float direction) noexcept {
+      const float dxdy = (x1 - x0) / (y1 - y0);
+      float x = x0;
+      const auto row_first = static_cast<std::int32_t>(std::floor(y0));
+      const auto row_last = static_cast<std::int32_t>(std::ceil(y1));
+      for (std::int32_t y = row_first; y < row_last; ++y) {
+        float *row = accumulation + static_cast<std::size_t>(y) * stride;
+        const float dy = std::min(static_cast<float>(y + 1), y1) - std::max(static_cast<float>(y), y0);
+        const float x_next = x + dxdy * dy;
+        const float d = dy * direction;
+        const float left = std::max(std::min(x, x_next), 0.0f);
+        const float right = std::max(x, x_next);
+        const float left_floor = std::floor(left);
+        const auto left_index = static_cast<std::int32_t>(left_floor);
+        const auto right_index = static_cast<std::int32_t>(std::ceil(right));
+        if (right_index <= left_index + 1) {
+          const float mid = 0.5f * (x + x_next) - left_floor;
+          row[left_index] += d - d * mid;
+          row[left_index + 1] += d * mid;
+        } else {
+          const float inverse_width = 1.0f / (right - left);
+          const float left_fraction = left - left_floor;
+          const float area_first = 0.5f * inverse_width * (1.0f - left_fraction) * (1.0f - left_fraction);
+          const float right_fraction = right - static_cast<float>(right_index) + 1.0f;
+          const float area_last = 0.5f * inverse_width * right_fraction * right_fraction;
+          row[left_index] += d * area_first;
+          if (right_index == left_index + 2) {
+            row[left_index + 1] += d * (1.0f - area_first - area_last);
+          } else {
+            const float area_second = inverse_width * (1.5f - left_fraction);
+            row[left_index + 1] += d * (area_second - area_first);
+            for (std::int32_t xi = left_index + 2; xi < right_index - 1; ++xi)
+              row[xi] += d * inverse_width;
+            const float area_before_last = area_second + static_cast<float>(right_index - left_index - 3) * inverse_width;
+            row[right_index - 1] += d * (1.0f - area_before_last - area_last);
+          }
+          row[right_index] += d * area_last;
         }
-        // Check if the Bitmap file has 24 bits per pixel (for now supporting only 24bpp bitmaps)
-        if (header->bits_per_pixel != 24) {
-          throw Exception("Bitmap::load(\"" + filename.string() + "\"): Only 24 bits per pixel bitmaps supported.");
+        x = x_next;
+      }
+    }
+
+    /**
+     * Clips polygon edge (x0, y0)-(x1, y1) to a `width` x `rows` accumulation buffer and accumulates it.
+     * Parts left of the buffer are projected onto its left border so they still cover everything to
+     * their right; parts right of it are dropped.
+     */
+    inline void accumulate_edge(float *accumulation, const std::size_t stride, const float width, const float rows,
+                                float x0, float y0, float x1, float y1) noexcept {
+      if (y0 == y1)
+        return;
+      float direction = 1.0f;
+      if (y0 > y1) {
+        std::swap(x0, x1);
+        std::swap(y0, y1);
+        direction = -1.0f;
+      }
+      if (y1 <= 0.0f || y0 >= rows)
+        return;
+      const float dxdy = (x1 - x0) / (y1 - y0);
+      if (y0 < 0.0f) {
+        x0 -= y0 * dxdy;
+        y0 = 0.0f;
+      }
+      if (y1 > rows) {
+        x1 -= (y1 - rows) * dxdy;
+        y1 = rows;
+      }
+
+      // Split at the crossings of the left and right borders
+      float splits[4] = {y0, y1, y1, y1};
+      std::size_t count = 1;
+      for (const float border: {0.0f, width}) {
+        if ((x0 < border) != (x1 < border) && x0 != x1) {
+          const float y = y0 + (border - x0) / dxdy;
+          if (y > y0 && y < y1)
+            splits[count++] = y;
         }
+      }
+      splits[count] = y1;
+      if (count == 3 && splits[1] > splits[2])
+        std::swap(splits[1], splits[2]);
 
-        // Seek the beginning of the pixels data
-        // Note: We can't just assume we're there right after we read the BitmapHeader
-        // Because some editors like Gimp might put extra information after the header.
-        // Thanks to @seeliger-ec
-        ifs.seekg(header->offset_bits);
+      for (std::size_t i = 0; i < count; ++i) {
+        const float top = splits[i], bottom = splits[i + 1];
+        if (bottom <= top)
+          continue;
+        const float x_top = x0 + (top - y0) * dxdy;
+        const float x_bottom = x0 + (bottom - y0) * dxdy;
+        const float middle = 0.5f * (x_top + x_bottom);
+        if (middle >= width)
+          continue;
+        if (middle <= 0.0f)
+          accumulate_segment(accumulation, stride, 0.0f, top, 0.0f, bottom, direction);
+        else
+          accumulate_segment(accumulation, stride, std::min(std::max(x_top, 0.0f), width), top,
+                             std::min(std::max(x_bottom, 0.0f), width), bottom, direction);
+      }
+    }
 
-        // Set width & height
-        m_width = header->width;
-        m_height = header->height;
+    /* Scratch tags of the polygon coverage buffers */
+    struct CoverageAccumulation;
+    struct CoverageRow;
 
-        // Resize pixels size
-        m_pixels.resize(static_cast<std::size_t>(m_width) * static_cast<std::size_t>(m_height), Black);
+    /**
+     * Half open clip rectangle [x0, x1) x [y0, y1) used by the clipping rasterizers
+     */
+    struct ClipRect {
+      std::int32_t x0, y0, x1, y1;
 
-        // Read Bitmap pixels
-        const std::int32_t row_size = m_width * 3 + m_width % 4;
-        std::vector<std::uint8_t> line(row_size);
-        for (std::int32_t y = m_height - 1; y >= 0; --y) {
-          ifs.read(reinterpret_cast<char *>(line.data()), line.size());
-          if (!ifs.good())
-            throw Exception("Bitmap::load(\"" + filename.string() + "\"): Failed to read bitmap pixels from file.");
-          std::size_t i = 0;
-          for (std::int32_t x = 0; x < m_width; ++x) {
-            Pixel color{};
-            color.b = line[i++];
-            color.g = line[i++];
-            color.r = line[i++];
-            m_pixels[IX(x, y)] = color;
-          }
+      [[nodiscard]] constexpr bool contains(const std::int32_t x, const std::int32_t y) const noexcept {
+        return x >= x0 && x < x1 && y >= y0 && y < y1;
+      }
+    };
+
+    /**
+     * Integer division rounding towards negative infinity, `b` must be > 0
+     */
+    [[nodiscard]] constexpr std::int64_t floor_div(const std::int64_t a, const std::int64_t b) noexcept {
+      return a / b - ((a % b != 0) && (a < 0) ? 1 : 0);
+    }
+
+    /**
+     * Integer division rounding towards positive infinity, `b` must be > 0
+     */
+    [[nodiscard]] constexpr std::int64_t ceil_div(const std::int64_t a, const std::int64_t b) noexcept {
+      return -floor_div(-a, b);
+    }
+
+    /**
+     * Remainder of floor_div, in [0, b)
+     */
+    [[nodiscard]] constexpr std::int64_t floor_mod(const std::int64_t a, const std::int64_t b) noexcept {
+      return a - floor_div(a, b) * b;
+    }
+
+    /**
+     * Whether a * b <= c * d, compared exactly on the full 128 bit products
+     */
+    [[nodiscard]] inline bool product_less_equal(const std::uint64_t a, const std::uint64_t b, const std::uint64_t c,
+                                                 const std::uint64_t d) noexcept {
+#ifdef __SIZEOF_INT128__
+      __extension__ typedef unsigned __int128 wide;
+      return static_cast<wide>(a) * b <= static_cast<wide>(c) * d;
+#else
+      // Schoolbook product of 32 bit halves
+      const auto multiply = [](const std::uint64_t x, const std::uint64_t y, std::uint64_t &high, std::uint64_t &low) {
+        const std::uint64_t ll = (x & 0xffffffffu) * (y & 0xffffffffu), lh = (x & 0xffffffffu) * (y >> 32);
+        const std::uint64_t hl = (x >> 32) * (y & 0xffffffffu), hh = (x >> 32) * (y >> 32);
+        const std::uint64_t middle = (ll >> 32) + (lh & 0xffffffffu) + (hl & 0xffffffffu);
+        low = (middle << 32) | (ll & 0xffffffffu);
+        high = hh + (lh >> 32) + (hl >> 32) + (middle >> 32);
+      };
+      std::uint64_t left_high, left_low, right_high, right_low;
+      multiply(a, b, left_high, left_low);
+      multiply(c, d, right_high, right_low);
+      return left_high < right_high || (left_high == right_high && left_low <= right_low);
+#endif
+    }
+
+    /**
+     * Half width of row `dy` (0..radius_y) of the filled ellipse: the largest h in [0, radius_x] with
+     * h^2 / (radius_x + 1/2)^2 + dy^2 / (radius_y + 1/2)^2 <= 1. Scaled to integers the test needs up to
+     * 128 bits, so it is estimated in double precision and settled with exact products.
+     */
+    [[nodiscard]] inline std::int64_t ellipse_half_width(const std::int64_t radius_x, const std::int64_t radius_y,
+                                                         const std::int64_t dy) noexcept {
+      // (2h * b)^2 <= a^2 * (b^2 - (2 dy)^2) with a = 2 rx + 1, b = 2 ry + 1; every factor fits 64 bits
+      const auto a = static_cast<std::uint64_t>(2 * radius_x + 1);
+      const auto b = static_cast<std::uint64_t>(2 * radius_y + 1);
+      const std::uint64_t rows = b * b - 4 * static_cast<std::uint64_t>(dy) * static_cast<std::uint64_t>(dy);
+      const auto inside = [&](const std::int64_t h) {
+        const std::uint64_t width = 2 * static_cast<std::uint64_t>(h) * b;
+        return product_less_equal(width, width, a * a, rows);
+      };
+      const double estimate = static_cast<double>(a) * std::sqrt(static_cast<double>(rows)) / (2.0 * static_cast<double>(b));
+      std::int64_t h = std::clamp(static_cast<std::int64_t>(estimate), std::int64_t{0}, radius_x);
+      while (h < radius_x && inside(h + 1)) ++h;
+      while (h > 0 && !inside(h)) --h;
+      return h;
+    }
+
+    /**
+     * Triangle set up as three integer edge functions E(x, y) = a * x + b * y + c, oriented so
+     * that interior pixels have E >= 0 on every edge. Pixels exactly on an edge belong to the
+     * triangle only for top and left edges (top-left fill rule), so triangles sharing an edge
+     * never cover a pixel twice and never leave a gap.
+     */
+    class TriangleEdges {
+    public:
+      TriangleEdges(const std::int32_t x1, const std::int32_t y1, const std::int32_t x2, const std::int32_t y2,
+                    const std::int32_t x3, const std::int32_t y3) noexcept
+        : m_top(std::min({y1, y2, y3})), m_bottom(std::max({y1, y2, y3})),
+          m_left(std::min({x1, x2, x3})), m_right(std::max({x1, x2, x3})) {
+        const std::int64_t area = (static_cast<std::int64_t>(x2) - x1) * (static_cast<std::int64_t>(y3) - y1) -
+                                  (static_cast<std::int64_t>(y2) - y1) * (static_cast<std::int64_t>(x3) - x1);
+        m_empty = area == 0;
+        if (area > 0) {
+          setup(0, x1, y1, x2, y2);
+          setup(1, x2, y2, x3, y3);
+          setup(2, x3, y3, x1, y1);
+        } else {
+          setup(0, x1, y1, x3, y3);
+          setup(1, x3, y3, x2, y2);
+          setup(2, x2, y2, x1, y1);
         }
-      } else
-        throw Exception("Bitmap::load(\"" + filename.string() + "\"): Failed to load bitmap pixels from file.");
+      }
+
+      [[nodiscard]] bool empty() const noexcept { return m_empty; }
+      [[nodiscard]] std::int32_t top() const noexcept { return m_top; }
+      [[nodiscard]] std::int32_t bottom() const noexcept { return m_bottom; }
+      [[nodiscard]] std::int32_t left() const noexcept { return m_left; }
+      [[nodiscard]] std::int32_t right() const noexcept { return m_right; }
+
+      /**
+       * Solves the three edge inequalities of row y for x. The covered pixels are [first, last],
+       * which is empty when first > last.
+       */
+      void span(const std::int32_t y, std::int32_t &first, std::int32_t &last) const noexcept {
+        std::int64_t lo = m_left, hi = m_right;
+        for (const Edge &edge: m_edges) {
+          // a * x >= bound
+          const std::int64_t bound = -(edge.b * y + edge.c);
+          if (edge.a > 0)
+            lo = std::max(lo, ceil_div(bound, edge.a));
+          else if (edge.a < 0)
+            hi = std::min(hi, floor_div(-bound, -edge.a));
+          else if (bound > 0)
+            hi = lo - 1;
+        }
+        first = static_cast<std::int32_t>(lo);
+        last = static_cast<std::int32_t>(hi);
+      }
+
+    private:
+      struct Edge {
+        std::int64_t a, b, c;
+      };
+
+      void setup(const std::size_t i, const std::int32_t xa, const std::int32_t ya, const std::int32_t xb,
+                 const std::int32_t yb) noexcept {
+        Edge &edge = m_edges[i];
+        edge.a = static_cast<std::int64_t>(ya) - yb;
+        edge.b = static_cast<std::int64_t>(xb) - xa;
+        edge.c = -(edge.a * xa + edge.b * ya);
+        // Left edges have the interior to their right, top edges are horizontal with the interior below
+        const bool top_left = edge.a > 0 || (edge.a == 0 && edge.b > 0);
+        if (!top_left)
+          edge.c -= 1;
+      }
+
+      Edge m_edges[3]{};
+      std::int32_t m_top, m_bottom, m_left, m_right;
+      bool m_empty = false;
+    };
+
+    /* Visible bounding box area above which a triangle is rasterized in bands on the thread pool */
+    static constexpr std::int64_t PARALLEL_TRIANGLE_AREA = 1 << 17;
+
+    /* Edge length in pixels of the screen tiles a DisplayList is binned into */
+    static constexpr std::int32_t DISPLAY_LIST_TILE = 64;
+
+    /* Scratch tags of the display list bins */
+    struct DisplayListTileStarts;
+    struct DisplayListTileCommands;
+    struct DisplayListTileCursors;
+
+    /**
+     * Interleaves the bits of x and y (x in the even bits), so that sorting by the code walks a grid in Z order
+     */
+    [[nodiscard]] inline std::uint64_t morton_code(const std::uint32_t x, const std::uint32_t y) noexcept {
+      const auto spread = [](std::uint64_t v) {
+        v = (v | (v << 16)) & 0x0000FFFF0000FFFFull;
+        v = (v | (v << 8)) & 0x00FF00FF00FF00FFull;
+        v = (v | (v << 4)) & 0x0F0F0F0F0F0F0F0Full;
+        v = (v | (v << 2)) & 0x3333333333333333ull;
+        return (v | (v << 1)) & 0x5555555555555555ull;
+      };
+      return spread(x) | (spread(y) << 1);
     }
 
-  private: /* Utils */
     /**
-     *	Converts 2D x,y coords into 1D index
+     * Largest integer whose square is <= value, `value` must be >= 0
      */
-    [[nodiscard]] constexpr std::size_t IX(const std::int32_t x, const std::int32_t y) const noexcept {
-      return static_cast<std::size_t>(x) + static_cast<std::size_t>(m_width) * static_cast<std::size_t>(y);
+    [[nodiscard]] inline std::int64_t isqrt(const std::int64_t value) noexcept {
+      auto root = static_cast<std::int64_t>(std::sqrt(static_cast<double>(value)));
+      while (root * root > value) --root;
+      while ((root + 1) * (root + 1) <= value) ++root;
+      return root;
+    }
+
+    /*
+     * The midpoint circle walk starts at (radius, 0), steps y up while err <= 0 and x down while err > 0,
+     * and keeps err = x^2 + y^2 + 2y - radius^2. It therefore leaves row y at the largest x with err <= 0 and
+     * column x at the largest y with err <= 0, so any part of it can be found without walking there.
+     */
+
+    /**
+     * Largest x with err(x, y) <= 0, the last x the walk plots on row y, or -1 when there is none
+     */
+    [[nodiscard]] inline std::int64_t midpoint_row_end(const std::int64_t radius, const std::int64_t y) noexcept {
+      const std::int64_t value = radius * radius - y * (y + 2);
+      return value < 0 ? -1 : isqrt(value);
     }
+
     /**
-     *	Returns true if x,y coords are within boundaries
+     * Largest y with err(x, y) <= 0, the last y the walk plots in column x (0..radius)
      */
-    [[nodiscard]] constexpr bool in_bounds(const std::int32_t x, const std::int32_t y) const noexcept {
-      return (x >= 0) && (x < m_width) && (y >= 0) && (y < m_height);
+    [[nodiscard]] inline std::int64_t midpoint_column_end(const std::int64_t radius, const std::int64_t x) noexcept {
+      return isqrt(radius * radius - x * x + 1) - 1;
     }
 
-  private:
-    std::vector<Pixel> m_pixels;
-    std::int32_t m_width;
-    std::int32_t m_height;
+    /**
+     * Half width of the scanline at vertical offset dy (0..radius) of the filled midpoint circle: the widest
+     * point the walk or its mirror across the diagonal plots on that row, so every row is written once.
+     */
+    [[nodiscard]] inline std::int64_t circle_half_width(const std::int64_t radius, const std::int64_t dy) noexcept {
+      // Up to the diagonal the row holds a single state of the walk, past it the row is column dy mirrored
+      return dy * (dy + 1) <= radius * radius / 2 ? midpoint_row_end(radius, dy) : midpoint_column_end(radius, dy);
+    }
+
+    /**
+     * Number of rows processed per task so that each band touches roughly 32K pixels
+     */
+    [[nodiscard]] inline std::int32_t rows_per_band(const std::int32_t width) noexcept {
+      return std::max<std::int32_t>(1, (1 << 15) / std::max<std::int32_t>(1, width));
+    }
+
+    /**
+     * Splits rows [begin, end) into bands of `band` rows and calls function(band_begin, band_end)
+     * for each of them on the thread pool.
+     */
+    template<typename Function>
+    void parallel_rows(const std::int32_t begin, const std::int32_t end, const std::int32_t band, Function &&function) {
+      if (end <= begin)
+        return;
+      const std::int32_t bands = (end - begin + band - 1) / band;
+      ThreadPool::instance().run(static_cast<std::size_t>(bands), [&](const std::size_t i) {
+        const std::int32_t first = begin + static_cast<std::int32_t>(i) * band;
+        function(first, std::min(first + band, end));
+      });
+    }
+
+    /**
+     * Band height for per pixel callbacks of unknown, possibly uneven cost: at most rows_per_band(width),
+     * and small enough to give every thread of the pool about 8 bands to balance the load with.
+     */
+    [[nodiscard]] inline std::int32_t balanced_band(const std::int32_t width, const std::int32_t height) {
+      const auto bands = static_cast<std::int64_t>(8 * ThreadPool::instance().concurrency());
+      const auto band = static_cast<std::int32_t>((std::max<std::int64_t>(height, 1) + bands - 1) / bands);
+      return std::min(rows_per_band(width), band);
+    }
+
+    /* Fixed point precision of the resampling coefficients */
+    static constexpr int RESIZE_PRECISION_BITS = 14;
+
+    /**
+     * Separable filter coefficients for one axis: for every output position the first
+     * source index, the number of taps and `taps` fixed point weights summing to 1.0.
+     */
+    struct ResizeCoefficients {
+      std::vector<std::int32_t> first;
+      std::vector<std::int32_t> count;
+      std::vector<std::int16_t> weights;
+      std::int32_t taps{0};
+    };
+
+    /**
+     * Per thread tables and intermediate rows reused across Bitmap::resize calls
+     */
+    struct ResizeScratch {
+      ResizeCoefficients horizontal;
+      ResizeCoefficients vertical;
+      std::vector<Pixel> rows;
+      std::vector<std::int32_t> columns;
+
+      static ResizeScratch &local() {
+        thread_local ResizeScratch scratch;
+        return scratch;
+      }
+    };
+
+    [[nodiscard]] inline double resize_filter_support(const ResizeFilter filter) noexcept {
+      switch (filter) {
+        case ResizeFilter::Area: return 0.5;
+        case ResizeFilter::Lanczos3: return 3.0;
+        default: return 1.0;
+      }
+    }
+
+    [[nodiscard]] inline double resize_filter_weight(const ResizeFilter filter, const double x) noexcept {
+      switch (filter) {
+        case ResizeFilter::Area:
+          return (x > -0.5 && x <= 0.5) ? 1.0 : 0.0;
+        case ResizeFilter::Lanczos3: {
+          if (x == 0.0)
+            return 1.0;
+          if (x <= -3.0 || x >= 3.0)
+            return 0.0;
+          constexpr double pi = 3.14159265358979323846;
+          const double px = pi * x;
+          return 3.0 * std::sin(px) * std::sin(px / 3.0) / (px * px);
+        }
+        default: {
+          const double ax = std::abs(x);
+          return ax < 1.0 ? 1.0 - ax : 0.0;
+        }
+      }
+    }
+
+    /**
+     * Precomputes the coefficient table mapping `in_size` source samples onto `out_size` samples
+     */
+    inline void compute_resize_coefficients(ResizeCoefficients &table, const std::int32_t in_size,
+                                            const std::int32_t out_size, const ResizeFilter filter) {
+      const double scale = static_cast<double>(in_size) / out_size;
+      const double filter_scale = std::max(scale, 1.0);
+      const double support = resize_filter_support(filter) * filter_scale;
+      const std::int32_t taps = static_cast<std::int32_t>(std::ceil(support)) * 2 + 1;
+
+      table.taps = taps;
+      table.first.resize(out_size);
+      table.count.resize(out_size);
+      table.weights.assign(static_cast<std::size_t>(out_size) * taps, 0);
+
+      std::vector<double> &weights = scratch<ResizeCoefficients, double>();
+      weights.resize(taps);
+      constexpr std::int32_t one = 1 << RESIZE_PRECISION_BITS;
+
+      for (std::int32_t out = 0; out < out_size; ++out) {
+        const double center = (out + 0.5) * scale;
+        const std::int32_t first = std::max(static_cast<std::int32_t>(std::floor(center - support + 0.5)), 0);
+        const std::int32_t last = std::min(static_cast<std::int32_t>(std::floor(center + support + 0.5)), in_size);
+        const std::int32_t count = std::min(last - first, taps);
+
+        double total = 0.0;
+        for (std::int32_t i = 0; i < count; ++i) {
+          weights[i] = resize_filter_weight(filter, (first + i - center + 0.5) / filter_scale);
+          total += weights[i];
+        }
+
+        // Quantize, then push the rounding error into the largest tap so flat areas stay exact
+        std::int16_t *dst = table.weights.data() + static_cast<std::size_t>(out) * taps;
+        std::int32_t sum = 0, largest = 0;
+        for (std::int32_t i = 0; i < count; ++i) {
+          const double w = total != 0.0 ? weights[i] / total : 0.0;
+          dst[i] = static_cast<std::int16_t>(std::lround(w * one));
+          sum += dst[i];
+          if (dst[i] > dst[largest])
+            largest = i;
+        }
+        if (count > 0)
+          dst[largest] = static_cast<std::int16_t>(dst[largest] + (one - sum));
+
+        table.first[out] = first;
+        table.count[out] = count;
+      }
+    }
+
+    [[nodiscard]] inline std::uint8_t clamp_fixed(const std::int32_t value) noexcept {
+      const std::int32_t v = (value + (1 << (RESIZE_PRECISION_BITS - 1))) >> RESIZE_PRECISION_BITS;
+      return static_cast<std::uint8_t>(v < 0 ? 0 : (v > 255 ? 255 : v));
+    }
+
+    /**
+     * Horizontal pass: filters one row of `src` into `dst` using `table`
+     */
+    inline void resample_row(const Pixel *src, Pixel *dst, const std::int32_t out_width,
+                             const ResizeCoefficients &table) {
+      for (std::int32_t x = 0; x < out_width; ++x) {
+        const Pixel *s = src + table.first[x];
+        const std::int16_t *k = table.weights.data() + static_cast<std::size_t>(x) * table.taps;
+        const std::int32_t count = table.count[x];
+        std::int32_t r = 0, g = 0, b = 0;
+        for (std::int32_t i = 0; i < count; ++i) {
+          r += s[i].r * k[i];
+          g += s[i].g * k[i];
+          b += s[i].b * k[i];
+        }
+        dst[x] = Pixel(clamp_fixed(r), clamp_fixed(g), clamp_fixed(b));
+      }
+    }
+
+    /**
+     * Vertical pass: blends `count` consecutive rows of `rows` (each `channels` bytes long)
+     * into `dst`. Works on whole rows at once so the inner loop is a contiguous multiply-add.
+     */
+    inline void resample_column(const std::uint8_t *rows, const std::size_t channels, const std::int16_t *k,
+                                const std::int32_t count, std::uint8_t *dst) {
+      std::vector<std::int32_t> &acc = scratch<ResizeCoefficients, std::int32_t>();
+      acc.assign(channels, 0);
+      std::int32_t *a = acc.data();
+      for (std::int32_t i = 0; i < count; ++i) {
+        const std::uint8_t *row = rows + static_cast<std::size_t>(i) * channels;
+        const std::int32_t w = k[i];
+        for (std::size_t c = 0; c < channels; ++c)
+          a[c] += row[c] * w;
+      }
+      for (std::size_t c = 0; c < channels; ++c)
+        dst[c] = clamp_fixed(a[c]);
+    }
+
+    /* Fractional bits of the fixed point source coordinates stepped along a warped scanline */
+    static constexpr int WARP_FRACTION_BITS = 24;
+
+    /**
+     * Returns the sub-range of [first, last) where lo <= start + x * step < hi,
+     * solved analytically and then corrected against the exact fixed point positions.
+     */
+    inline void clip_scanline(const std::int64_t start, const std::int64_t step, const std::int64_t lo,
+                              const std::int64_t hi, std::int32_t &first, std::int32_t &last) noexcept {
+      const auto inside = [&](const std::int32_t x) {
+        const std::int64_t p = start + x * step;
+        return p >= lo && p < hi;
+      };
+      if (step == 0) {
+        if (start < lo || start >= hi)
+          last = first;
+        return;
+      }
+      const double t0 = (static_cast<double>(lo) - static_cast<double>(start)) / static_cast<double>(step);
+      const double t1 = (static_cast<double>(hi) - static_cast<double>(start)) / static_cast<double>(step);
+      const double enter = std::max<double>(std::min(t0, t1), first);
+      const double leave = std::min<double>(std::max(t0, t1) + 1.0, last);
+      if (enter >= leave) {
+        last = first;
+        return;
+      }
+      std::int32_t a = static_cast<std::int32_t>(std::ceil(enter));
+      std::int32_t b = static_cast<std::int32_t>(std::ceil(leave));
+      while (a < b && !inside(a)) ++a;
+      while (a > first && inside(a - 1)) --a;
+      while (b > a && !inside(b - 1)) --b;
+      while (b < last && inside(b)) ++b;
+      first = a;
+      last = std::max(a, b);
+    }
+
+    [[nodiscard]] inline Pixel bilinear(const Pixel &p00, const Pixel &p01, const Pixel &p10, const Pixel &p11,
+                                        const std::uint32_t fx, const std::uint32_t fy) noexcept {
+      const auto lerp = [&](const std::uint8_t c00, const std::uint8_t c01, const std::uint8_t c10, const std::uint8_t c11) {
+        const std::uint32_t top = c00 * (256 - fx) + c01 * fx;
+        const std::uint32_t bottom = c10 * (256 - fx) + c11 * fx;
+        return static_cast<std::uint8_t>((top * (256 - fy) + bottom * fy + (1u << 15)) >> 16);
+      };
+      return Pixel(lerp(p00.r, p01.r, p10.r, p11.r), lerp(p00.g, p01.g, p10.g, p11.g), lerp(p00.b, p01.b, p10.b, p11.b));
+    }
+
+    /**
+     * Renders one destination scanline of an affine warp. (sx, sy) are the fixed point source
+     * coordinates of the first pixel, stepped by (step_x, step_y) per destination pixel.
+     */
+    inline void warp_scanline(const Pixel *src, const std::int32_t src_width, const std::int32_t src_height,
+                              Pixel *dst, const std::int32_t dst_width, const std::int64_t sx, const std::int64_t sy,
+                              const std::int64_t step_x, const std::int64_t step_y, const Pixel background) {
+      constexpr std::int64_t one = std::int64_t{1} << WARP_FRACTION_BITS;
+      constexpr std::int64_t half = one / 2;
+
+      // Pixels whose sample lies on the source footprint
+      std::int32_t outer_first = 0, outer_last = dst_width;
+      clip_scanline(sx, step_x, -half, src_width * one - half, outer_first, outer_last);
+      clip_scanline(sy, step_y, -half, src_height * one - half, outer_first, outer_last);
+
+      // Pixels whose four bilinear taps are all inside the source
+      std::int32_t inner_first = outer_first, inner_last = outer_last;
+      clip_scanline(sx, step_x, 0, (src_width - 1) * one, inner_first, inner_last);
+      clip_scanline(sy, step_y, 0, (src_height - 1) * one, inner_first, inner_last);
+      if (inner_first >= inner_last)
+        inner_first = inner_last = outer_last;
+
+      const auto clamped = [&](const std::int32_t x) {
+        const std::int64_t px = sx + x * step_x;
+        const std::int64_t py = sy + x * step_y;
+        const std::int64_t fx = px >> WARP_FRACTION_BITS;
+        const std::int64_t fy = py >> WARP_FRACTION_BITS;
+        const auto cx0 = static_cast<std::int32_t>(std::clamp<std::int64_t>(fx, 0, src_width - 1));
+        const auto cx1 = static_cast<std::int32_t>(std::clamp<std::int64_t>(fx + 1, 0, src_width - 1));
+        const auto cy0 = static_cast<std::size_t>(std::clamp<std::int64_t>(fy, 0, src_height - 1)) * src_width;
+        const auto cy1 = static_cast<std::size_t>(std::clamp<std::int64_t>(fy + 1, 0, src_height - 1)) * src_width;
+        dst[x] = bilinear(src[cy0 + cx0], src[cy0 + cx1], src[cy1 + cx0], src[cy1 + cx1],
+                          static_cast<std::uint32_t>((px >> (WARP_FRACTION_BITS - 8)) & 0xff),
+                          static_cast<std::uint32_t>((py >> (WARP_FRACTION_BITS - 8)) & 0xff));
+      };
+
+      std::fill(dst, dst + outer_first, background);
+      for (std::int32_t x = outer_first; x < inner_first; ++x) clamped(x);
+
+      std::int64_t px = sx + inner_first * step_x;
+      std::int64_t py = sy + inner_first * step_y;
+      for (std::int32_t x = inner_first; x < inner_last; ++x, px += step_x, py += step_y) {
+        const Pixel *p = src + static_cast<std::size_t>(py >> WARP_FRACTION_BITS) * src_width + (px >> WARP_FRACTION_BITS);
+        dst[x] = bilinear(p[0], p[1], p[src_width], p[src_width + 1],
+                          static_cast<std::uint32_t>((px >> (WARP_FRACTION_BITS - 8)) & 0xff),
+                          static_cast<std::uint32_t>((py >> (WARP_FRACTION_BITS - 8)) & 0xff));
+      }
+
+      for (std::int32_t x = inner_last; x < outer_last; ++x) clamped(x);
+      std::fill(dst + outer_last, dst + dst_width, background);
+    }
+
+    /**
+     * Integer index mapping built from flips, quarter turns and crops: output pixel (x, y)
+     * reads source pixel (origin_x + x * ux + y * vx, origin_y + x * uy + y * vy).
+     */
+    struct PixelMapping {
+      std::int32_t width{0}, height{0};
+      std::int32_t origin_x{0}, origin_y{0};
+      std::int32_t ux{1}, uy{0};
+      std::int32_t vx{0}, vy{1};
+
+      [[nodiscard]] static constexpr PixelMapping identity(const std::int32_t width, const std::int32_t height) noexcept {
+        return {width, height, 0, 0, 1, 0, 0, 1};
+      }
+
+      [[nodiscard]] constexpr PixelMapping flipped_h() const noexcept {
+        return {width, height, origin_x + (width - 1) * ux, origin_y + (width - 1) * uy, -ux, -uy, vx, vy};
+      }
+
+      [[nodiscard]] constexpr PixelMapping flipped_v() const noexcept {
+        return {width, height, origin_x + (height - 1) * vx, origin_y + (height - 1) * vy, ux, uy, -vx, -vy};
+      }
+
+      [[nodiscard]] constexpr PixelMapping rotated_right() const noexcept {
+        return {height, width, origin_x + (height - 1) * vx, origin_y + (height - 1) * vy, -vx, -vy, ux, uy};
+      }
+
+      [[nodiscard]] constexpr PixelMapping rotated_left() const noexcept {
+        return {height, width, origin_x + (width - 1) * ux, origin_y + (width - 1) * uy, vx, vy, -ux, -uy};
+      }
+
+      [[nodiscard]] constexpr PixelMapping cropped(const std::int32_t x, const std::int32_t y,
+                                                   const std::int32_t w, const std::int32_t h) const noexcept {
+        return {w, h, origin_x + x * ux + y * vx, origin_y + x * uy + y * vy, ux, uy, vx, vy};
+      }
+    };
+
+    /* Side of the square tiles used when the mapping transposes rows and columns */
+    static constexpr std::int32_t REMAP_TILE = 32;
+
+    /**
+     * Writes output rows [first, last) of `mapping` applied to `src` (rows of `src_width` pixels)
+     * into `dst`, whose first row is output row `first`. Row preserving mappings copy whole rows,
+     * transposing mappings walk REMAP_TILE x REMAP_TILE tiles so both sides stay in cache.
+     */
+    inline void remap_rows(const Pixel *src, const std::int32_t src_width, const PixelMapping &mapping,
+                           const std::int32_t first, const std::int32_t last, Pixel *dst) {
+      const std::ptrdiff_t step_x = static_cast<std::ptrdiff_t>(mapping.uy) * src_width + mapping.ux;
+      const std::ptrdiff_t step_y = static_cast<std::ptrdiff_t>(mapping.vy) * src_width + mapping.vx;
+      const std::ptrdiff_t origin = static_cast<std::ptrdiff_t>(mapping.origin_y) * src_width + mapping.origin_x;
+      const std::int32_t width = mapping.width;
+
+      if (step_x == 1 || step_x == -1) {
+        for (std::int32_t y = first; y < last; ++y) {
+          const Pixel *row = src + origin + y * step_y;
+          Pixel *out = dst + static_cast<std::size_t>(y - first) * width;
+          if (step_x == 1)
+            std::copy(row, row + width, out);
+          else
+            std::reverse_copy(row - (width - 1), row + 1, out);
+        }
+        return;
+      }
+
+      for (std::int32_t ty = first; ty < last; ty += REMAP_TILE) {
+        const std::int32_t ty_end = std::min(ty + REMAP_TILE, last);
+        for (std::int32_t tx = 0; tx < width; tx += REMAP_TILE) {
+          const std::int32_t tx_end = std::min(tx + REMAP_TILE, width);
+          for (std::int32_t x = tx; x < tx_end; ++x) {
+            const Pixel *column = src + origin + x * step_x;
+            Pixel *out = dst + x;
+            for (std::int32_t y = ty; y < ty_end; ++y)
+              out[static_cast<std::size_t>(y - first) * width] = column[y * step_y];
+          }
+        }
+      }
+    }
+
+    /**
+     * Writes a 24bpp bitmap file of width x height pixels, fetching rows bottom to top
+     * through `fetch_row(y)` which returns a pointer to the `width` pixels of row y.
+     *   @throws bmp::Exception on error
+     */
+    template<typename FetchRow>
+    void write_bitmap(const std::filesystem::path &filename, const std::int32_t width, const std::int32_t height,
+                      FetchRow &&fetch_row, const char *caller) {
+      // Calculate row and bitmap size
+      const std::int32_t row_size = width * 3 + width % 4;
+      const std::uint32_t bitmap_size = row_size * height;
+
+      // Construct bitmap header
+      BitmapHeader header{};
+      /* Bitmap file header structure */
+      header.magic = BITMAP_BUFFER_MAGIC;
+      header.file_size = bitmap_size + sizeof(BitmapHeader);
+      header.reserved1 = 0;
+      header.reserved2 = 0;
+      header.offset_bits = sizeof(BitmapHeader);
+      /* Bitmap file info structure */
+      header.size = 40;
+      header.width = width;
+      header.height = height;
+      header.planes = 1;
+      header.bits_per_pixel = sizeof(Pixel) * 8; // 24bpp
+      header.compression = 0;
+      header.size_image = bitmap_size;
+      header.x_pixels_per_meter = 0;
+      header.y_pixels_per_meter = 0;
+      header.clr_used = 0;
+      header.clr_important = 0;
+
+      // Save bitmap to output file
+      if (std::ofstream ofs{filename, std::ios::binary}; ofs.good()) {
+        // Write Header
+        ofs.write(reinterpret_cast<const char *>(&header), sizeof(BitmapHeader));
+        if (!ofs.good()) {
+          throw Exception(std::string(caller) + "(\"" + filename.string() + "\"): Failed to write bitmap header to file.");
+        }
+
+        // Write Pixels
+        std::vector<std::uint8_t> line(row_size);
+        for (std::int32_t y = height - 1; y >= 0; --y) {
+          const Pixel *row = fetch_row(y);
+          std::size_t i = 0;
+          for (std::int32_t x = 0; x < width; ++x) {
+            const Pixel &color = row[x];
+            line[i++] = color.b;
+            line[i++] = color.g;
+            line[i++] = color.r;
+          }
+          ofs.write(reinterpret_cast<const char *>(line.data()), line.size());
+          if (!ofs.good()) {
+            throw Exception(std::string(caller) + "(\"" + filename.string() + "\"): Failed to write bitmap pixels to file.");
+          }
+        }
+      } else
+        throw Exception(std::string(caller) + "(\"" + filename.string() + "\"): Failed to open file.");
+    }
+
+#ifdef BPP_SSE2
+    /**
+     * 2x2 box averages of two source rows into 16 output bytes: five pixels and the first channel of a sixth.
+     * Reads 35 bytes of each row. Both rows are loaded at byte offsets 0 and 3, so every byte is summed with the
+     * same channel of its right neighbour in 16 bit lanes, rounded and packed. Source bytes 6k..6k+2 then hold
+     * output pixel k, and the gaps between those triples are closed with masked byte shifts.
+     */
+    inline void reduce_block(const std::uint8_t *top, const std::uint8_t *bottom, std::uint8_t *out) noexcept {
+      const __m128i zero = _mm_setzero_si128();
+      const __m128i two = _mm_set1_epi16(2);
+      __m128i averages[2];
+      for (std::size_t h = 0; h < 2; ++h) {
+        const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(top + 16 * h));
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(top + 16 * h + sizeof(Pixel)));
+        const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bottom + 16 * h));
+        const __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i *>(bottom + 16 * h + sizeof(Pixel)));
+        const __m128i lo = _mm_add_epi16(_mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero)),
+                                         _mm_add_epi16(_mm_unpacklo_epi8(c, zero), _mm_unpacklo_epi8(d, zero)));
+        const __m128i hi = _mm_add_epi16(_mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero)),
+                                         _mm_add_epi16(_mm_unpackhi_epi8(c, zero), _mm_unpackhi_epi8(d, zero)));
+        averages[h] = _mm_packus_epi16(_mm_srli_epi16(_mm_add_epi16(lo, two), 2), _mm_srli_epi16(_mm_add_epi16(hi, two), 2));
+      }
+
+      // Triple k (source bytes 6k..6k+2) moves down by 3k bytes; triples 3 to 5 come from the second register
+      const __m128i triple = _mm_setr_epi8(-1, -1, -1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0);
+      const __m128i first = averages[0], second = averages[1];
+      __m128i packed = _mm_and_si128(first, triple);
+      packed = _mm_or_si128(packed, _mm_srli_si128(_mm_and_si128(first, _mm_slli_si128(triple, 6)), 3));
+      packed = _mm_or_si128(packed, _mm_srli_si128(_mm_and_si128(first, _mm_slli_si128(triple, 12)), 6));
+      packed = _mm_or_si128(packed, _mm_slli_si128(_mm_and_si128(second, _mm_slli_si128(triple, 2)), 7));
+      packed = _mm_or_si128(packed, _mm_slli_si128(_mm_and_si128(second, _mm_slli_si128(triple, 8)), 4));
+      packed = _mm_or_si128(packed, _mm_slli_si128(_mm_and_si128(second, _mm_slli_si128(triple, 14)), 1));
+      _mm_storeu_si128(reinterpret_cast<__m128i *>(out), packed);
+    }
+#endif
+
+    /**
+     * Halves rows [first, last) of a `width` x `height` level into `dst` (rows of max(1, width / 2) pixels).
+     * The 2x2 box average is computed in a single pass over both source rows, with SSE2 five output pixels
+     * at a time and the remaining pixels of each row one by one.
+     */
+    inline void reduce_rows(const Pixel *src, const std::int32_t width, const std::int32_t height, Pixel *dst,
+                            const std::int32_t first, const std::int32_t last, const PyramidFilter filter) {
+      const std::int32_t out_width = std::max(1, width / 2);
+      const std::size_t right = width > 1 ? sizeof(Pixel) : 0;
+      for (std::int32_t y = first; y < last; ++y) {
+        const std::int32_t sy = std::min(2 * y, height - 1);
+        const auto *top = reinterpret_cast<const std::uint8_t *>(src + static_cast<std::size_t>(sy) * width);
+        auto *out = reinterpret_cast<std::uint8_t *>(dst + static_cast<std::size_t>(y) * out_width);
+        if (filter == PyramidFilter::Nearest) {
+          for (std::int32_t x = 0; x < out_width; ++x)
+            std::memcpy(out + x * sizeof(Pixel), top + 2 * x * sizeof(Pixel), sizeof(Pixel));
+          continue;
+        }
+        const std::size_t down = (sy + 1 < height ? static_cast<std::size_t>(width) : 0) * sizeof(Pixel);
+        const std::uint8_t *bottom = top + down;
+        std::int32_t x = 0;
+#ifdef BPP_SSE2
+        // Each block writes one byte past its five pixels, so a sixth output pixel must exist
+        for (; x + 6 <= out_width; x += 5)
+          reduce_block(top + 2 * static_cast<std::size_t>(x) * sizeof(Pixel), bottom + 2 * static_cast<std::size_t>(x) * sizeof(Pixel),
+                       out + static_cast<std::size_t>(x) * sizeof(Pixel));
+#endif
+        for (; x < out_width; ++x) {
+          const std::size_t i = 2 * static_cast<std::size_t>(x) * sizeof(Pixel);
+          for (std::size_t c = 0; c < sizeof(Pixel); ++c)
+            out[x * sizeof(Pixel) + c] = static_cast<std::uint8_t>((top[i + c] + top[i + right + c] + bottom[i + c] + bottom[i + right + c] + 2) >> 2);
+        }
+      }
+    }
+
+    /* Squared radius past which an orbit has escaped; large so that the smooth iteration count is accurate */
+    static constexpr double FRACTAL_BAILOUT = 65536.0;
+
+    /* log2(FRACTAL_BAILOUT) */
+    static constexpr double FRACTAL_BAILOUT_LOG2 = 16.0;
+
+    /* Pixels iterated together by the escape time kernel, as two independent pairs of SSE2 lanes. Wider groups
+       lose more to lanes waiting for the slowest pixel than they gain in latency hiding. */
+    static constexpr std::int32_t FRACTAL_LANES = 4;
+
+    /* Palette entries per iteration of the smooth iteration count */
+    static constexpr std::uint32_t FRACTAL_SUBSTEPS = 16;
+
+    /* Spacing of the grid lines computed first by FractalRenderer::render_progressive */
+    static constexpr std::int32_t FRACTAL_GRID = 64;
+
+    /* Cells with fewer interior rows or columns than this are computed instead of subdivided */
+    static constexpr std::int32_t FRACTAL_MIN_CELL = 8;
+
+    /* Largest FractalParams::max_iterations, which keeps the palette below 2^24 entries */
+    static constexpr std::uint32_t FRACTAL_MAX_ITERATIONS = 1u << 20;
+
+    /* Mantissa bits indexing the table of fast_log2 */
+    static constexpr int FAST_LOG2_BITS = 10;
+
+    /**
+     * log2(v) for a finite v > 0, from its exponent bits and a table over the top mantissa bits, within 0.001
+     */
+    [[nodiscard]] inline double fast_log2(const double v) noexcept {
+      struct Table {
+        float values[1 << FAST_LOG2_BITS];
+
+        Table() noexcept {
+          for (int i = 0; i < (1 << FAST_LOG2_BITS); ++i)
+            values[i] = static_cast<float>(std::log2(1.0 + (i + 0.5) / (1 << FAST_LOG2_BITS)));
+        }
+      };
+      static const Table table;
+      std::uint64_t bits;
+      std::memcpy(&bits, &v, sizeof(bits));
+      const auto exponent = static_cast<std::int32_t>((bits >> 52) & 0x7FF) - 1023;
+      return exponent + table.values[(bits >> (52 - FAST_LOG2_BITS)) & ((1u << FAST_LOG2_BITS) - 1)];
+    }
+
+    /**
+     * Everything the escape time kernel needs: pixel (x, y) is the point (x0 + x * step, y0 - y * step)
+     * and an orbit escaped after n iterations with a squared radius m takes palette entry
+     * (n + 1 - log2(log2(m) / log2(FRACTAL_BAILOUT))) * FRACTAL_SUBSTEPS
+     */
+    struct FractalSetup {
+      double x0{0.0}, y0{0.0}, step{0.0};
+      bool julia{false};
+      double cr{0.0}, ci{0.0};
+      std::uint32_t max_iterations{0};
+      bool periodicity_check{false};
+      bool interior_check{false};
+      double epsilon{0.0}; // Distance under which an orbit is considered back at its saved value
+      const std::uint32_t *palette{nullptr};
+      std::uint32_t palette_size{0};
+      std::uint32_t inside{0};
+    };
+
+    /**
+     * Color of an orbit from its iteration count and squared radius at escape
+     */
+    [[nodiscard]] inline std::uint32_t fractal_color(const FractalSetup &setup, const double count, const double radius2) noexcept {
+      const double smooth = count + 1.0 - fast_log2(fast_log2(radius2) * (1.0 / FRACTAL_BAILOUT_LOG2));
+      const auto entry = static_cast<std::int64_t>(smooth * FRACTAL_SUBSTEPS);
+      return setup.palette[std::clamp<std::int64_t>(entry, 0, setup.palette_size - 1)];
+    }
+
+    /**
+     * Packed colors of the FRACTAL_LANES points (cr[i], ci[i]). The points iterate in lock step until every
+     * one of them escaped, was found inside the set or reached max_iterations. The periodicity check
+     * compares every orbit with its value saved at iterations 2, 4, 8, ... (Brent's cycle detection).
+     */
+    inline void escape_lanes(const FractalSetup &setup, const double *cr, const double *ci, std::uint32_t *colors) noexcept {
+      constexpr int lanes = FRACTAL_LANES;
+      double counts[lanes] = {}, radii2[lanes] = {};
+      int pending = 0, inside_lanes = 0; // Bit j set for lane j
+#ifdef BPP_SSE2
+      constexpr int pairs = lanes / 2;
+      const __m128d bailout = _mm_set1_pd(FRACTAL_BAILOUT), epsilon = _mm_set1_pd(setup.epsilon), sign = _mm_set1_pd(-0.0);
+      __m128d zr[pairs], zi[pairs], kr[pairs], ki[pairs], sr[pairs], si[pairs];
+      for (int h = 0; h < pairs; ++h) {
+        const __m128d pr = _mm_loadu_pd(cr + 2 * h), pi = _mm_loadu_pd(ci + 2 * h);
+        zr[h] = setup.julia ? pr : _mm_setzero_pd();
+        zi[h] = setup.julia ? pi : _mm_setzero_pd();
+        kr[h] = setup.julia ? _mm_set1_pd(setup.cr) : pr;
+        ki[h] = setup.julia ? _mm_set1_pd(setup.ci) : pi;
+        sr[h] = zr[h];
+        si[h] = zi[h];
+        if (setup.interior_check && !setup.julia) {
+          const __m128d xq = _mm_sub_pd(pr, _mm_set1_pd(0.25)), i2 = _mm_mul_pd(pi, pi);
+          const __m128d q = _mm_add_pd(_mm_mul_pd(xq, xq), i2);
+          const __m128d cardioid = _mm_cmple_pd(_mm_mul_pd(q, _mm_add_pd(q, xq)), _mm_mul_pd(_mm_set1_pd(0.25), i2));
+          const __m128d x1 = _mm_add_pd(pr, _mm_set1_pd(1.0));
+          const __m128d bulb = _mm_cmple_pd(_mm_add_pd(_mm_mul_pd(x1, x1), i2), _mm_set1_pd(1.0 / 16.0));
+          inside_lanes |= _mm_movemask_pd(_mm_or_pd(cardioid, bulb)) << (2 * h);
+        }
+      }
+      pending = ((1 << lanes) - 1) & ~inside_lanes;
+
+      // Lanes that left keep iterating, their events are masked out by `pending`
+      for (std::uint32_t i = 1, save = 2; pending != 0 && i <= setup.max_iterations; ++i) {
+        __m128d radius2[pairs];
+        int events = 0;
+        for (int h = 0; h < pairs; ++h) {
+          const __m128d ri = _mm_mul_pd(zr[h], zi[h]);
+          zr[h] = _mm_add_pd(_mm_sub_pd(_mm_mul_pd(zr[h], zr[h]), _mm_mul_pd(zi[h], zi[h])), kr[h]);
+          zi[h] = _mm_add_pd(_mm_add_pd(ri, ri), ki[h]);
+          radius2[h] = _mm_add_pd(_mm_mul_pd(zr[h], zr[h]), _mm_mul_pd(zi[h], zi[h]));
+          __m128d event = _mm_cmpgt_pd(radius2[h], bailout);
+          if (setup.periodicity_check) {
+            const __m128d distance = _mm_add_pd(_mm_andnot_pd(sign, _mm_sub_pd(zr[h], sr[h])), _mm_andnot_pd(sign, _mm_sub_pd(zi[h], si[h])));
+            event = _mm_or_pd(event, _mm_cmplt_pd(distance, epsilon));
+          }
+          events |= _mm_movemask_pd(event) << (2 * h);
+        }
+        events &= pending;
+        if (events != 0) {
+          // Rare: some lanes escaped or closed a cycle
+          alignas(16) double radius[lanes];
+          for (int h = 0; h < pairs; ++h)
+            _mm_store_pd(radius + 2 * h, radius2[h]);
+          for (int j = 0; j < lanes; ++j) {
+            if ((events >> j & 1) == 0)
+              continue;
+            if (radius[j] > FRACTAL_BAILOUT) {
+              counts[j] = i;
+              radii2[j] = radius[j];
+            } else {
+              inside_lanes |= 1 << j;
+            }
+          }
+          pending &= ~events;
+        }
+        if (setup.periodicity_check && i == save) {
+          std::copy(zr, zr + pairs, sr);
+          std::copy(zi, zi + pairs, si);
+          save *= 2;
+        }
+      }
+#else
+      double zr[lanes], zi[lanes], kr[lanes], ki[lanes], sr[lanes], si[lanes];
+      for (int j = 0; j < lanes; ++j) {
+        zr[j] = setup.julia ? cr[j] : 0.0;
+        zi[j] = setup.julia ? ci[j] : 0.0;
+        kr[j] = setup.julia ? setup.cr : cr[j];
+        ki[j] = setup.julia ? setup.ci : ci[j];
+        sr[j] = zr[j];
+        si[j] = zi[j];
+        bool interior = false;
+        if (setup.interior_check && !setup.julia) {
+          const double xq = cr[j] - 0.25, i2 = ci[j] * ci[j], q = xq * xq + i2;
+          interior = q * (q + xq) <= 0.25 * i2 || (cr[j] + 1.0) * (cr[j] + 1.0) + i2 <= 1.0 / 16.0;
+        }
+        (interior ? inside_lanes : pending) |= 1 << j;
+      }
+      for (std::uint32_t i = 1, save = 2; pending != 0 && i <= setup.max_iterations; ++i) {
+        for (int j = 0; j < lanes; ++j) {
+          if ((pending >> j & 1) == 0)
+            continue;
+          const double ri = zr[j] * zi[j];
+          zr[j] = zr[j] * zr[j] - zi[j] * zi[j] + kr[j];
+          zi[j] = ri + ri + ki[j];
+          const double radius2 = zr[j] * zr[j] + zi[j] * zi[j];
+          if (radius2 > FRACTAL_BAILOUT) {
+            counts[j] = i;
+            radii2[j] = radius2;
+            pending &= ~(1 << j);
+          } else if (setup.periodicity_check && std::abs(zr[j] - sr[j]) + std::abs(zi[j] - si[j]) < setup.epsilon) {
+            inside_lanes |= 1 << j;
+            pending &= ~(1 << j);
+          }
+        }
+        if (setup.periodicity_check && i == save) {
+          std::copy(zr, zr + lanes, sr);
+          std::copy(zi, zi + lanes, si);
+          save *= 2;
+        }
+      }
+#endif
+      // Orbits still running after max_iterations count as inside
+      inside_lanes |= pending;
+      for (int j = 0; j < lanes; ++j)
+        colors[j] = (inside_lanes >> j & 1) != 0 ? setup.inside : fractal_color(setup, counts[j], radii2[j]);
+    }
+
+    /**
+     * Shades `count` pixels starting at (x, y) and stepping by (dx, dy), writing pixel i to out[i * stride]
+     */
+    inline void shade_fractal_line(const FractalSetup &setup, const std::int32_t x, const std::int32_t y, const std::int32_t dx,
+                                   const std::int32_t dy, const std::int32_t count, Pixel *out, const std::ptrdiff_t stride) noexcept {
+      alignas(16) double cr[FRACTAL_LANES], ci[FRACTAL_LANES];
+      std::uint32_t colors[FRACTAL_LANES];
+      for (std::int32_t i = 0; i < count; i += FRACTAL_LANES) {
+        // The last group repeats its last pixel in the unused lanes
+        const std::int32_t lanes = std::min(FRACTAL_LANES, count - i);
+        for (std::int32_t j = 0; j < FRACTAL_LANES; ++j) {
+          const std::int32_t k = i + std::min(j, lanes - 1);
+          cr[j] = setup.x0 + static_cast<double>(x + k * dx) * setup.step;
+          ci[j] = setup.y0 - static_cast<double>(y + k * dy) * setup.step;
+        }
+        escape_lanes(setup, cr, ci, colors);
+        for (std::int32_t j = 0; j < lanes; ++j)
+          out[(i + j) * stride] = unpack(colors[j]);
+      }
+    }
+  }
+
+  /**
+   * Sets the number of threads the parallel algorithms of the library run on, the calling thread included.
+   * 1 makes them serial, 0 restores the default of one thread per hardware thread.
+   *   @throws bmp::Exception when called from inside a parallel task
+   */
+  inline void set_thread_count(const std::size_t threads) {
+    detail::ThreadPool::instance().resize(threads);
+  }
+
+  /**
+   * Returns the number of threads the parallel algorithms of the library run on, the calling thread included
+   */
+  [[nodiscard]] inline std::size_t thread_count() {
+    return detail::ThreadPool::instance().concurrency();
+  }
+
+  /**
+   * One row of pixels, contiguous in memory, usable in range-for loops and standard algorithms
+   */
+  template<typename T>
+  class PixelRow {
+  public:
+    constexpr PixelRow(T *pixels, const std::int32_t width, const std::int32_t y) noexcept
+      : m_pixels(pixels), m_width(width), m_y(y) {
+    }
+
+    [[nodiscard]] constexpr T *begin() const noexcept { return m_pixels; }
+
+    [[nodiscard]] constexpr T *end() const noexcept { return m_pixels + m_width; }
+
+    [[nodiscard]] constexpr T *data() const noexcept { return m_pixels; }
+
+    [[nodiscard]] constexpr std::int32_t size() const noexcept { return m_width; }
+
+    /**
+     *	Returns the index of the row in its bitmap
+     */
+    [[nodiscard]] constexpr std::int32_t y() const noexcept { return m_y; }
+
+    /**
+     *	Pixel x of the row, bounds checked by assertions only
+     */
+    T &operator[](const std::int32_t x) const noexcept {
+      assert(x >= 0 && x < m_width && "PixelRow: x out of bounds");
+      return m_pixels[x];
+    }
+
+  private:
+    T *m_pixels;
+    std::int32_t m_width;
+    std::int32_t m_y;
+  };
+
+  /**
+   * Rows [first, last) of a bitmap or view, iterated as PixelRow values:
+   *
+   *	for (bmp::PixelRow<bmp::Pixel> row: image.rows())
+   *	  for (bmp::Pixel &pixel: row) ...
+   */
+  template<typename T>
+  class PixelRows {
+  public:
+    class iterator {
+    public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = PixelRow<T>;
+      using difference_type = std::ptrdiff_t;
+      using pointer = void;
+      using reference = PixelRow<T>;
+
+      constexpr iterator(T *pixels, const std::ptrdiff_t stride, const std::int32_t width, const std::int32_t y) noexcept
+        : m_pixels(pixels), m_stride(stride), m_width(width), m_y(y) {
+      }
+
+      constexpr PixelRow<T> operator*() const noexcept { return {m_pixels, m_width, m_y}; }
+
+      iterator &operator++() noexcept {
+        m_pixels += m_stride;
+        ++m_y;
+        return *this;
+      }
+
+      iterator operator++(int) noexcept {
+        iterator previous = *this;
+        ++*this;
+        return previous;
+      }
+
+      constexpr bool operator==(const iterator &other) const noexcept { return m_y == other.m_y; }
+
+      constexpr bool operator!=(const iterator &other) const noexcept { return m_y != other.m_y; }
+
+    private:
+      T *m_pixels;
+      std::ptrdiff_t m_stride;
+      std::int32_t m_width;
+      std::int32_t m_y;
+    };
+
+    /**
+     *	`first_row` points at the first pixel of row `first`, rows are `stride` pixels apart
+     */
+    constexpr PixelRows(T *first_row, const std::ptrdiff_t stride, const std::int32_t width, const std::int32_t first,
+                        const std::int32_t last) noexcept
+      : m_first_row(first_row), m_stride(stride), m_width(width), m_first(first), m_last(last) {
+    }
+
+    [[nodiscard]] constexpr iterator begin() const noexcept { return {m_first_row, m_stride, m_width, m_first}; }
+
+    // Only the row index of the end iterator is compared, so it does not point past the pixels
+    [[nodiscard]] constexpr iterator end() const noexcept { return {m_first_row, m_stride, m_width, m_last}; }
+
+    [[nodiscard]] constexpr std::int32_t size() const noexcept { return m_last - m_first; }
+
+  private:
+    T *m_first_row;
+    std::ptrdiff_t m_stride;
+    std::int32_t m_width;
+    std::int32_t m_first;
+    std::int32_t m_last;
+  };
+
+  /**
+   * Non owning, read only view of width x height pixels stored row by row, `stride` pixels apart.
+   * The viewed pixels must outlive the view.
+   */
+  class BitmapView {
+  public:
+    constexpr BitmapView() noexcept = default;
+
+    constexpr BitmapView(const Pixel *pixels, const std::int32_t width, const std::int32_t height,
+                         const std::int32_t stride) noexcept
+      : m_pixels(pixels), m_width(width), m_height(height), m_stride(stride) {
+    }
+
+    /**
+     *	Returns the width x height sub-view at x,y
+     *   @throws bmp::Exception on error
+     */
+    [[nodiscard]] BitmapView sub_view(const std::int32_t x, const std::int32_t y, const std::int32_t width,
+                                      const std::int32_t height) const {
+      if (x < 0 || y < 0 || width <= 0 || height <= 0 || x + width > m_width || y + height > m_height)
+        throw Exception(
+          "BitmapView::sub_view(" + std::to_string(x) + ", " + std::to_string(y) + ", " + std::to_string(width) + ", " +
+          std::to_string(height) + "): x,y,w or h out of bounds");
+      return {row(y) + x, width, height, m_stride};
+    }
+
+    /**
+     *	Returns a pointer to the first pixel of row y
+     */
+    [[nodiscard]] const Pixel *row(const std::int32_t y) const noexcept {
+      return m_pixels + static_cast<std::ptrdiff_t>(y) * m_stride;
+    }
+
+    /**
+     *	Returns the rows of the view, to iterate over
+     */
+    [[nodiscard]] PixelRows<const Pixel> rows() const noexcept { return {m_pixels, m_stride, m_width, 0, m_height}; }
+
+    /**
+     *	Get const pixel at position x,y
+     *   @throws bmp::Exception on error
+     */
+    [[nodiscard]] const Pixel &get(const std::int32_t x, const std::int32_t y) const {
+      if (x < 0 || y < 0 || x >= m_width || y >= m_height)
+        throw Exception("BitmapView::get(" + std::to_string(x) + ", " + std::to_string(y) + "): x,y out of bounds");
+      return row(y)[x];
+    }
+
+    [[nodiscard]] std::int32_t width() const noexcept { return m_width; }
+
+    [[nodiscard]] std::int32_t height() const noexcept { return m_height; }
+
+    [[nodiscard]] std::int32_t stride() const noexcept { return m_stride; }
+
+    bool operator!() const noexcept { return (m_pixels == nullptr) || (m_width <= 0) || (m_height <= 0); }
+
+    explicit operator bool() const noexcept { return !(*this); }
+
+    /**
+     *	Saves the viewed pixels into a file
+     *   @throws bmp::Exception on error
+     */
+    void save(const std::filesystem::path &filename) const {
+      detail::write_bitmap(filename, m_width, m_height, [this](const std::int32_t y) { return row(y); }, "BitmapView::save");
+    }
+
+  private:
+    const Pixel *m_pixels{nullptr};
+    std::int32_t m_width{0};
+    std::int32_t m_height{0};
+    std::int32_t m_stride{0};
+  };
+
+  /**
+   * Monospaced bitmap font cut from an atlas of equally sized cells laid out row by row, the first
+   * cell holding `first_char`. Glyph ink is bright on a dark background: the brightest channel of
+   * each atlas pixel is its coverage, so anti-aliased atlases blend smoothly. Every glyph is cached
+   * as a coverage mask together with the extent of the ink on each of its rows.
+   */
+  class Font {
+  public:
+    Font() noexcept = default;
+
+    /**
+     *	Builds the glyph cache from `atlas`
+     *   @throws bmp::Exception on error
+     */
+    Font(const BitmapView &atlas, const std::int32_t glyph_width, const std::int32_t glyph_height,
+         const char first_char = ' ')
+      : m_glyph_width(glyph_width), m_glyph_height(glyph_height), m_first(static_cast<unsigned char>(first_char)) {
+      if (!atlas || glyph_width <= 0 || glyph_height <= 0 || atlas.width() < glyph_width || atlas.height() < glyph_height)
+        throw Exception("Font: atlas is empty or smaller than one " + std::to_string(glyph_width) + "x" +
+                        std::to_string(glyph_height) + " glyph");
+
+      const std::int32_t columns = atlas.width() / glyph_width;
+      const std::int32_t rows = atlas.height() / glyph_height;
+      m_count = std::min(columns * rows, 256 - static_cast<std::int32_t>(m_first));
+      const std::size_t area = static_cast<std::size_t>(glyph_width) * glyph_height;
+      m_coverage.resize(area * static_cast<std::size_t>(m_count));
+      m_ink.resize(static_cast<std::size_t>(m_count) * glyph_height);
+      for (std::int32_t g = 0; g < m_count; ++g) {
+        const BitmapView cell = atlas.sub_view((g % columns) * glyph_width, (g / columns) * glyph_height,
+                                               glyph_width, glyph_height);
+        for (std::int32_t y = 0; y < glyph_height; ++y) {
+          std::uint8_t *coverage = m_coverage.data() + g * area + static_cast<std::size_t>(y) * glyph_width;
+          InkSpan &ink = m_ink[static_cast<std::size_t>(g) * glyph_height + y];
+          ink = {glyph_width, 0};
+          for (std::int32_t x = 0; x < glyph_width; ++x) {
+            const Pixel &pixel = cell.row(y)[x];
+            coverage[x] = std::max({pixel.r, pixel.g, pixel.b});
+            if (coverage[x] != 0) {
+              ink.first = std::min(ink.first, x);
+              ink.last = x + 1;
+            }
+          }
+        }
+      }
+    }
+
+    /**
+     *	Loads the atlas from a BMP file
+     *   @throws bmp::Exception on error
+     */
+    [[nodiscard]] static Font load(const std::filesystem::path &filename, std::int32_t glyph_width,
+                                   std::int32_t glyph_height, char first_char = ' ');
+
+    [[nodiscard]] std::int32_t glyph_width() const noexcept { return m_glyph_width; }
+
+    [[nodiscard]] std::int32_t glyph_height() const noexcept { return m_glyph_height; }
+
+    /**
+     *	Returns whether the font has a glyph for `c`
+     */
+    [[nodiscard]] bool has_glyph(const char c) const noexcept {
+      const auto code = static_cast<std::int32_t>(static_cast<unsigned char>(c)) - m_first;
+      return code >= 0 && code < m_count;
+    }
+
+    /**
+     *	Returns the glyph_width x glyph_height coverage mask of `c`, or nullptr when the font has no glyph for it
+     */
+    [[nodiscard]] const std::uint8_t *glyph(const char c) const noexcept {
+      if (!has_glyph(c))
+        return nullptr;
+      const auto code = static_cast<std::size_t>(static_cast<unsigned char>(c) - m_first);
+      return m_coverage.data() + code * static_cast<std::size_t>(m_glyph_width) * m_glyph_height;
+    }
+
+    /**
+     *	Returns the width in pixels of the longest line of `text`
+     */
+    [[nodiscard]] std::int32_t text_width(const std::string_view text) const noexcept {
+      std::int32_t longest = 0, line = 0;
+      for (const char c: text) {
+        line = c == '\n' ? 0 : line + 1;
+        longest = std::max(longest, line);
+      }
+      return longest * m_glyph_width;
+    }
+
+    /**
+     *	Returns the height in pixels of `text`, one glyph height per line
+     */
+    [[nodiscard]] std::int32_t text_height(const std::string_view text) const noexcept {
+      if (text.empty())
+        return 0;
+      return static_cast<std::int32_t>(std::count(text.begin(), text.end(), '\n') + 1) * m_glyph_height;
+    }
+
+    bool operator!() const noexcept { return m_count == 0; }
+
+  private:
+    /* Columns [first, last) of a glyph row holding ink */
+    struct InkSpan {
+      std::int32_t first, last;
+    };
+
+    std::vector<std::uint8_t> m_coverage;
+    std::vector<InkSpan> m_ink;
+    std::int32_t m_glyph_width{0};
+    std::int32_t m_glyph_height{0};
+    std::int32_t m_first{0};
+    std::int32_t m_count{0};
+
+    friend class Bitmap;
+  };
+
+  /**
+   * One string drawn by the batched Bitmap::draw_text. The text is not copied, it must outlive the call.
+   */
+  struct TextLabel {
+    std::int32_t x{0};
+    std::int32_t y{0};
+    std::string_view text;
+    Pixel color;
+    std::uint8_t opacity{255};
+  };
+
+  /**
+   * Contours made of lines, quadratic and cubic Bezier curves and elliptical arcs, drawn with
+   * Bitmap::fill_path and Bitmap::draw_path. Curves are flattened into points as they are added, so
+   * that no chord is further than `tolerance` pixels from the exact curve. clear() keeps the
+   * capacity, so a path rebuilt every frame does not allocate once it has grown.
+   *
+   * Angles are in degrees, positive angles turning clockwise since the y axis points down.
+   */
+  class Path {
+  public:
+    explicit Path(const float tolerance = 0.25f) noexcept : m_tolerance(tolerance) {
+    }
+
+    /**
+     *	Starts a new contour at `point`
+     */
+    Path &move_to(const PointF point) {
+      m_sizes.push_back(1);
+      m_closed.push_back(0);
+      m_points.push_back(point);
+      m_open = true;
+      return *this;
+    }
+
+    /**
+     *	Adds a straight segment from the current point to `point`
+     */
+    Path &line_to(const PointF point) {
+      if (m_sizes.empty())
+        return move_to(point);
+      begin(point);
+      return append([&] { m_points.push_back(point); });
+    }
+
+    /**
+     *	Adds a quadratic Bezier curve from the current point through `control` to `to`
+     */
+    Path &quad_to(const PointF control, const PointF to) {
+      begin(control);
+      const PointF from = m_points.back();
+      return append([&] { detail::flatten_quadratic(from, control, to, m_tolerance, m_points); });
+    }
+
+    /**
+     *	Adds a cubic Bezier curve from the current point through `control1` and `control2` to `to`
+     */
+    Path &cubic_to(const PointF control1, const PointF control2, const PointF to) {
+      begin(control1);
+      const PointF from = m_points.back();
+      return append([&] { detail::flatten_cubic(from, control1, control2, to, m_tolerance, m_points); });
+    }
+
+    /**
+     *	Adds the arc of the ellipse with radii (rx, ry) around `center`, rotated by `rotation` degrees,
+     *	from angle `start` over `sweep` degrees. A straight segment joins the current point to the
+     *	start of the arc, which starts a new contour when there is no current point.
+     */
+    Path &arc(const PointF center, const float rx, const float ry, const float start, const float sweep,
+              const float rotation = 0.0f) {
+      constexpr double radians = 3.14159265358979323846 / 180.0;
+      const double theta = rotation * radians;
+      const PointF first = detail::ellipse_point(center, rx, ry, start * radians, std::cos(theta), std::sin(theta));
+      begin(first);
+      if (m_points.back().x != first.x || m_points.back().y != first.y)
+        line_to(first);
+      return append([&] {
+        detail::flatten_arc(center, rx, ry, start * radians, sweep * radians, theta, m_tolerance, m_points);
+      });
+    }
+
+    /**
+     *	Closes the current contour back to its first point. The next segment starts a new contour there.
+     */
+    Path &close() noexcept {
+      if (m_open) {
+        m_closed.back() = 1;
+        m_open = false;
+      }
+      return *this;
+    }
+
+    /**
+     *	Removes every contour, keeping the allocated capacity
+     */
+    void clear() noexcept {
+      m_points.clear();
+      m_sizes.clear();
+      m_closed.clear();
+      m_open = false;
+    }
+
+    [[nodiscard]] float tolerance() const noexcept { return m_tolerance; }
+
+    void set_tolerance(const float tolerance) noexcept { m_tolerance = tolerance; }
+
+    /**
+     *	Returns the flattened points of all contours, one contour after another
+     */
+    [[nodiscard]] const std::vector<PointF> &points() const noexcept { return m_points; }
+
+    /**
+     *	Returns the number of points of each contour
+     */
+    [[nodiscard]] const std::vector<std::size_t> &contour_sizes() const noexcept { return m_sizes; }
+
+    /**
+     *	Returns whether contour i was closed with close()
+     */
+    [[nodiscard]] bool closed(const std::size_t contour) const noexcept { return m_closed[contour] != 0; }
+
+    [[nodiscard]] bool empty() const noexcept { return m_points.empty(); }
+
+  private:
+    /* Starts a contour at `point` unless one is open, reopening after close() at the closed contour's start */
+    void begin(const PointF point) {
+      if (m_open)
+        return;
+      move_to(m_sizes.empty() ? point : m_points[m_points.size() - m_sizes.back()]);
+    }
+
+    /* Runs `flatten`, which appends points to m_points, and counts them in the current contour */
+    template<typename Flatten>
+    Path &append(Flatten &&flatten) {
+      const std::size_t before = m_points.size();
+      flatten();
+      m_sizes.back() += m_points.size() - before;
+      return *this;
+    }
+
+    std::vector<PointF> m_points;
+    std::vector<std::size_t> m_sizes;
+    std::vector<std::uint8_t> m_closed;
+    float m_tolerance;
+    bool m_open{false};
+
+    friend class Bitmap;
+  };
+
+  class TransformView;
+  class DisplayList;
+
+  class Bitmap {
+  public:
+    Bitmap() noexcept : m_pixels(), m_width(0), m_height(0) {
+    }
+
+    explicit Bitmap(const std::string &filename) : m_pixels(), m_width(0), m_height(0) {
+      this->load(filename);
+    }
+
+    Bitmap(const std::int32_t width, const std::int32_t height)
+      : m_pixels(static_cast<std::size_t>(width) * static_cast<std::size_t>(height)),
+        m_width(width),
+        m_height(height) {
+      if (width == 0 || height == 0)
+        throw Exception("Bitmap width and height must be > 0");
+    }
+
+    /**
+     *	Copies the pixels of a view into a new bitmap
+     */
+    explicit Bitmap(const BitmapView &view)
+      : Bitmap(view.width(), view.height()) {
+      for (std::int32_t y = 0; y < m_height; ++y)
+        std::copy(view.row(y), view.row(y) + m_width, m_pixels.begin() + IX(0, y));
+    }
+
+    Bitmap(const Bitmap &other) = default; // Copy Constructor
+
+    Bitmap(Bitmap &&other) noexcept
+      : m_pixels(std::move(other.m_pixels)),
+        m_width(std::exchange(other.m_width, 0)),
+        m_height(std::exchange(other.m_height, 0)) {
+    }
+
+    virtual ~Bitmap() noexcept = default;
+
+  public: /* Draw Primitives */
+    /**
+     * Draw a line form (x1, y1) to (x2, y2). Parts of the line outside the bitmap are clipped.
+     */
+    void draw_line(const std::int32_t x1, const std::int32_t y1, const std::int32_t x2, const std::int32_t y2, const Pixel color) {
+      draw_line_in(x1, y1, x2, y2, color, bounds());
+    }
+
+    /**
+     * Draw a filled rect
+     */
+    void fill_rect(const std::int32_t x, const std::int32_t y, const std::int32_t width, const std::int32_t height,
+                   const Pixel color) {
+      if (!in_bounds(x, y) || !in_bounds(x + (width - 1), y + (height - 1)))
+        throw Exception(
+          "Bitmap::fill_rect(" + std::to_string(x) + ", " + std::to_string(y) + ", " + std::to_string(width) + ", " +
+          std::to_string(height) + "): x,y,w or h out of bounds");
+
+      fill_rect_in(x, y, width, height, color, bounds());
+    }
+
+    /**
+     * Draw a rect (not filled, border only)
+     */
+    void draw_rect(const std::int32_t x, const std::int32_t y, const std::int32_t width, const std::int32_t height,
+                   const Pixel color) {
+      if (!in_bounds(x, y) || !in_bounds(x + (width - 1), y + (height - 1)))
+        throw Exception(
+          "Bitmap::draw_rect(" + std::to_string(x) + ", " + std::to_string(y) + ", " + std::to_string(width) + ", " +
+          std::to_string(height) + "): x,y,w or h out of bounds");
+
+      draw_rect_in(x, y, width, height, color, bounds());
+    }
+
+
+    /**
+     * Draw a triangle (not filled, border only)
+     */
+    void draw_triangle(const std::int32_t x1, const std::int32_t y1,
+                       const std::int32_t x2, const std::int32_t y2,
+                       const std::int32_t x3, const std::int32_t y3,
+                       const Pixel color) {
+      if (!in_bounds(x1, y1) || !in_bounds(x2, y2) || !in_bounds(x3, y3))
+        throw Exception("Bitmap::draw_triangle: One or more points are out of bounds");
+
+      draw_triangle_in(x1, y1, x2, y2, x3, y3, color, bounds());
+    }
+
+    /**
+     * Draw a filled triangle. Pixels on the bottom and right edges follow the top-left fill rule,
+     * so adjacent triangles sharing an edge fill it exactly once. Degenerate triangles cover no pixels.
+     */
+    void fill_triangle(const std::int32_t x1, const std::int32_t y1,
+                       const std::int32_t x2, const std::int32_t y2,
+                       const std::int32_t x3, const std::int32_t y3,
+                       const Pixel color) {
+      if (!in_bounds(x1, y1) || !in_bounds(x2, y2) || !in_bounds(x3, y3))
+        throw Exception("Bitmap::fill_triangle: One or more points are out of bounds");
+
+      fill_triangle_in(x1, y1, x2, y2, x3, y3, color, bounds());
+    }
+
+    /**
+     * Draw a circle with a given center and radius
+     */
+    void draw_circle(const std::int32_t center_x, const std::int32_t center_y, const std::int32_t radius,
+                     const Pixel color) {
+      if (!in_bounds(center_x - radius, center_y - radius) || !in_bounds(center_x + radius, center_y + radius))
+        throw Exception("Bitmap::draw_circle: Circle exceeds bounds");
+
+      draw_circle_in(center_x, center_y, radius, color, bounds());
+    }
+
+    /**
+     * Fill a circle with a given center and radius
+     */
+    void fill_circle(const std::int32_t center_x, const std::int32_t center_y, const std::int32_t radius,
+                     const Pixel color) {
+      if (!in_bounds(center_x - radius, center_y - radius) || !in_bounds(center_x + radius, center_y + radius))
+        throw Exception("Bitmap::fill_circle: Circle exceeds bounds");
+
+      fill_circle_in(center_x, center_y, radius, color, bounds());
+    }
+
+    /**
+     * Fill an axis aligned ellipse with a given center and x, y radii
+     */
+    void fill_ellipse(const std::int32_t center_x, const std::int32_t center_y, const std::int32_t radius_x,
+                      const std::int32_t radius_y, const Pixel color) {
+      if (radius_x < 0 || radius_y < 0)
+        throw Exception("Bitmap::fill_ellipse: Radii must be >= 0");
+      if (!in_bounds(center_x - radius_x, center_y - radius_y) || !in_bounds(center_x + radius_x, center_y + radius_y))
+        throw Exception("Bitmap::fill_ellipse: Ellipse exceeds bounds");
+
+      fill_ellipse_in(center_x, center_y, radius_x, radius_y, color, bounds());
+    }
+
+    /**
+     * Fill a ring between two concentric circles. Pixels of the inner circle of `inner_radius` are left untouched.
+     */
+    void fill_annulus(const std::int32_t center_x, const std::int32_t center_y, const std::int32_t inner_radius,
+                      const std::int32_t outer_radius, const Pixel color) {
+      if (inner_radius < 0 || inner_radius > outer_radius)
+        throw Exception("Bitmap::fill_annulus: Radii must satisfy 0 <= inner_radius <= outer_radius");
+      if (!in_bounds(center_x - outer_radius, center_y - outer_radius) || !in_bounds(center_x + outer_radius, center_y + outer_radius))
+        throw Exception("Bitmap::fill_annulus: Annulus exceeds bounds");
+
+      fill_annulus_in(center_x, center_y, inner_radius, outer_radius, color, bounds());
+    }
+
+  public: /* Clipped Draw Primitives */
+    /**
+     * Draw the visible part of a filled rect, never throws on out-of-bounds coordinates
+     */
+    void fill_rect_clipped(const std::int32_t x, const std::int32_t y, const std::int32_t width, const std::int32_t height,
+                           const Pixel color) noexcept {
+      fill_rect_in(x, y, width, height, color, bounds());
+    }
+
+    /**
+     * Draw the visible part of a rect border, never throws on out-of-bounds coordinates
+     */
+    void draw_rect_clipped(const std::int32_t x, const std::int32_t y, const std::int32_t width, const std::int32_t height,
+                           const Pixel color) noexcept {
+      draw_rect_in(x, y, width, height, color, bounds());
+    }
+
+    /**
+     * Draw the visible part of a triangle border, never throws on out-of-bounds coordinates
+     */
+    void draw_triangle_clipped(const std::int32_t x1, const std::int32_t y1,
+                               const std::int32_t x2, const std::int32_t y2,
+                               const std::int32_t x3, const std::int32_t y3,
+                               const Pixel color) noexcept {
+      draw_triangle_in(x1, y1, x2, y2, x3, y3, color, bounds());
+    }
+
+    /**
+     * Draw the visible part of a filled triangle, never throws on out-of-bounds coordinates
+     */
+    void fill_triangle_clipped(const std::int32_t x1, const std::int32_t y1,
+                               const std::int32_t x2, const std::int32_t y2,
+                               const std::int32_t x3, const std::int32_t y3,
+                               const Pixel color) {
+      fill_triangle_in(x1, y1, x2, y2, x3, y3, color, bounds());
+    }
+
+    /**
+     * Draw the visible part of a circle, never throws on out-of-bounds coordinates
+     */
+    void draw_circle_clipped(const std::int32_t center_x, const std::int32_t center_y, const std::int32_t radius,
+                             const Pixel color) noexcept {
+      draw_circle_in(center_x, center_y, radius, color, bounds());
+    }
+
+    /**
+     * Draw the visible part of a filled circle, never throws on out-of-bounds coordinates
+     */
+    void fill_circle_clipped(const std::int32_t center_x, const std::int32_t center_y, const std::int32_t radius,
+                             const Pixel color) noexcept {
+      fill_circle_in(center_x, center_y, radius, color, bounds());
+    }
+
+    /**
+     * Draw the visible part of a filled ellipse, never throws on out-of-bounds coordinates. Negative radii draw nothing.
+     */
+    void fill_ellipse_clipped(const std::int32_t center_x, const std::int32_t center_y, const std::int32_t radius_x,
+                              const std::int32_t radius_y, const Pixel color) noexcept {
+      fill_ellipse_in(center_x, center_y, radius_x, radius_y, color, bounds());
+    }
+
+    /**
+     * Draw the visible part of a filled ring, never throws on out-of-bounds coordinates. Invalid radii draw nothing.
+     */
+    void fill_annulus_clipped(const std::int32_t center_x, const std::int32_t center_y, const std::int32_t inner_radius,
+                              const std::int32_t outer_radius, const Pixel color) noexcept {
+      fill_annulus_in(center_x, center_y, inner_radius, outer_radius, color, bounds());
+    }
+
+  public: /* Batched Draw Primitives */
+    /**
+     * Fill `count` rects given as structure of arrays, rect i using colors[i].
+     * The whole batch is bounds checked once, rects reaching outside the bitmap are clipped.
+     */
+    void fill_rects(const std::int32_t *x, const std::int32_t *y, const std::int32_t *width,
+                    const std::int32_t *height, const Pixel *colors, const std::size_t count) noexcept {
+      fill_rects_batch(x, y, width, height, colors, 1, count);
+    }
+
+    /**
+     * Fill `count` rects given as structure of arrays, all in the same color
+     */
+    void fill_rects(const std::int32_t *x, const std::int32_t *y, const std::int32_t *width,
+                    const std::int32_t *height, const Pixel color, const std::size_t count) noexcept {
+      fill_rects_batch(x, y, width, height, &color, 0, count);
+    }
+
+    /**
+     * Fill `count` circles given as structure of arrays, circle i using colors[i].
+     * The whole batch is bounds checked once, circles reaching outside the bitmap are clipped.
+     */
+    void fill_circles(const std::int32_t *center_x, const std::int32_t *center_y, const std::int32_t *radius,
+                      const Pixel *colors, const std::size_t count) noexcept {
+      fill_circles_batch(center_x, center_y, radius, colors, 1, count);
+    }
+
+    /**
+     * Fill `count` circles given as structure of arrays, all in the same color
+     */
+    void fill_circles(const std::int32_t *center_x, const std::int32_t *center_y, const std::int32_t *radius,
+                      const Pixel color, const std::size_t count) noexcept {
+      fill_circles_batch(center_x, center_y, radius, &color, 0, count);
+    }
+
+    /**
+     * Draw `count` lines from (x1[i], y1[i]) to (x2[i], y2[i]), line i using colors[i].
+     * The whole batch is bounds checked once, lines reaching outside the bitmap are clipped.
+     */
+    void draw_lines(const std::int32_t *x1, const std::int32_t *y1, const std::int32_t *x2, const std::int32_t *y2,
+                    const Pixel *colors, const std::size_t count) noexcept {
+      draw_lines_batch(x1, y1, x2, y2, colors, 1, count);
+    }
+
+    /**
+     * Draw `count` lines given as structure of arrays, all in the same color
+     */
+    void draw_lines(const std::int32_t *x1, const std::int32_t *y1, const std::int32_t *x2, const std::int32_t *y2,
+                    const Pixel color, const std::size_t count) noexcept {
+      draw_lines_batch(x1, y1, x2, y2, &color, 0, count);
+    }
+
+  public: /* Polygons */
+    /**
+     * Fill a polygon given by `count` vertices (closed automatically). Concave and self intersecting
+     * polygons are filled according to `rule`. Parts outside the bitmap are clipped.
+     */
+    void fill_polygon(const PointF *points, const std::size_t count, const Pixel color,
+                      const FillRule rule = FillRule::NonZero) {
+      fill_polygon(points, &count, 1, color, rule);
+    }
+
+    /**
+     * Fill a polygon made of `contours` closed contours stored one after another in `points`,
+     * contour i having contour_sizes[i] vertices. Holes are contours wound against the outline
+     * (NonZero) or simply nested inside it (EvenOdd).
+     *
+     * Pixel (x, y) is filled when its center is inside; centers exactly on a left or top edge are
+     * inside and on a right or bottom edge outside, so polygons sharing an edge never overlap.
+     */
+    void fill_polygon(const PointF *points, const std::size_t *contour_sizes, const std::size_t contours,
+                      const Pixel color, const FillRule rule = FillRule::NonZero) {
+      polygon_spans(points, contour_sizes, contours, rule, [&](const std::int32_t x1, const std::int32_t x2, const std::int32_t y) {
+        fill_row(x1, x2, y, color);
+      });
+    }
+
+  public: /* Strokes */
+    /**
+     * Stroke the open polyline through `count` points with the width, joins and caps of `style`.
+     * Pixels whose centers lie inside the stroke are filled, each written exactly once, also where
+     * the polyline crosses itself. Parts outside the bitmap are clipped.
+     */
+    void draw_polyline(const PointF *points, const std::size_t count, const Pixel color, const StrokeStyle &style = {}) {
+      const std::uint8_t open = 0;
+      stroke(points, &count, &open, 1, color, style);
+    }
+
+    /**
+     * Stroke the closed polygon through `count` points, joining the last vertex back to the first
+     */
+    void draw_polygon(const PointF *points, const std::size_t count, const Pixel color, const StrokeStyle &style = {}) {
+      const std::uint8_t closed = 1;
+      stroke(points, &count, &closed, 1, color, style);
+    }
+
+    /**
+     * Draw a line of any width from `from` to `to` with the caps of `style`
+     */
+    void draw_line(const PointF from, const PointF to, const Pixel color, const StrokeStyle &style) {
+      const PointF points[2] = {from, to};
+      const std::size_t count = 2;
+      const std::uint8_t open = 0;
+      stroke(points, &count, &open, 1, color, style);
+    }
+
+  public: /* Paths */
+    /**
+     * Fill the area enclosed by every contour of `path`, open contours being closed implicitly
+     */
+    void fill_path(const Path &path, const Pixel color, const FillRule rule = FillRule::NonZero) {
+      if (!path.empty())
+        fill_polygon(path.m_points.data(), path.m_sizes.data(), path.m_sizes.size(), color, rule);
+    }
+
+    /**
+     * Stroke every contour of `path` with `style`. Contours are stroked together, so pixels where
+     * they overlap are still written once.
+     */
+    void draw_path(const Path &path, const Pixel color, const StrokeStyle &style = {}) {
+      if (!path.empty())
+        stroke(path.m_points.data(), path.m_sizes.data(), path.m_closed.data(), path.m_sizes.size(), color, style);
+    }
+
+  public: /* Gradients */
+    /**
+     * Fill the whole bitmap with the linear gradient running from `from` (t = 0) to `to` (t = 1), constant
+     * along lines perpendicular to it. Bands of rows are shaded in parallel.
+     *   @throws bmp::Exception when the colormap of `gradient` is empty
+     */
+    void fill_linear_gradient(const PointF from, const PointF to, const Gradient &gradient) {
+      const std::vector<std::uint32_t> &table = detail::gradient_table(gradient);
+      shade_rect(0, m_width - 1, 0, m_height, detail::linear_gradient(from, to, static_cast<std::int32_t>(table.size())), table);
+    }
+
+    /**
+     * Fill a rect with a linear gradient, positioned in bitmap coordinates like the rect itself
+     *   @throws bmp::Exception when the rect is out of bounds or the colormap of `gradient` is empty
+     */
+    void fill_linear_gradient(const std::int32_t x, const std::int32_t y, const std::int32_t width, const std::int32_t height,
+                              const PointF from, const PointF to, const Gradient &gradient) {
+      if (!in_bounds(x, y) || !in_bounds(x + (width - 1), y + (height - 1)))
+        throw Exception(
+          "Bitmap::fill_linear_gradient(" + std::to_string(x) + ", " + std::to_string(y) + ", " + std::to_string(width) + ", " +
+          std::to_string(height) + "): x,y,w or h out of bounds");
+      const std::vector<std::uint32_t> &table = detail::gradient_table(gradient);
+      shade_rect(x, x + width - 1, y, y + height, detail::linear_gradient(from, to, static_cast<std::int32_t>(table.size())), table);
+    }
+
+    /**
+     * Fill `count` spans with a linear gradient. Parts of the spans outside the bitmap are clipped.
+     */
+    void fill_linear_gradient(const Span *spans, const std::size_t count, const PointF from, const PointF to,
+                              const Gradient &gradient) {
+      const std::vector<std::uint32_t> &table = detail::gradient_table(gradient);
+      shade_spans(spans, count, detail::linear_gradient(from, to, static_cast<std::int32_t>(table.size())), table);
+    }
+
+    /**
+     * Fill a polygon with a linear gradient, covering the same pixels as fill_polygon
+     */
+    void fill_linear_gradient(const PointF *points, const std::size_t count, const PointF from, const PointF to,
+                              const Gradient &gradient, const FillRule rule = FillRule::NonZero) {
+      const std::vector<std::uint32_t> &table = detail::gradient_table(gradient);
+      shade_polygon(points, count, rule, detail::linear_gradient(from, to, static_cast<std::int32_t>(table.size())), table);
+    }
+
+    /**
+     * Fill the whole bitmap with the radial gradient running from `center` (t = 0) to the circle of `radius`
+     * around it (t = 1). Bands of rows are shaded in parallel.
+     *   @throws bmp::Exception when the colormap of `gradient` is empty
+     */
+    void fill_radial_gradient(const PointF center, const float radius, const Gradient &gradient) {
+      const std::vector<std::uint32_t> &table = detail::gradient_table(gradient);
+      shade_rect(0, m_width - 1, 0, m_height, detail::radial_gradient(center, radius, static_cast<std::int32_t>(table.size())), table);
+    }
+
+    /**
+     * Fill a rect with a radial gradient, positioned in bitmap coordinates like the rect itself
+     *   @throws bmp::Exception when the rect is out of bounds or the colormap of `gradient` is empty
+     */
+    void fill_radial_gradient(const std::int32_t x, const std::int32_t y, const std::int32_t width, const std::int32_t height,
+                              const PointF center, const float radius, const Gradient &gradient) {
+      if (!in_bounds(x, y) || !in_bounds(x + (width - 1), y + (height - 1)))
+        throw Exception(
+          "Bitmap::fill_radial_gradient(" + std::to_string(x) + ", " + std::to_string(y) + ", " + std::to_string(width) + ", " +
+          std::to_string(height) + "): x,y,w or h out of bounds");
+      const std::vector<std::uint32_t> &table = detail::gradient_table(gradient);
+      shade_rect(x, x + width - 1, y, y + height, detail::radial_gradient(center, radius, static_cast<std::int32_t>(table.size())), table);
+    }
+
+    /**
+     * Fill `count` spans with a radial gradient. Parts of the spans outside the bitmap are clipped.
+     */
+    void fill_radial_gradient(const Span *spans, const std::size_t count, const PointF center, const float radius,
+                              const Gradient &gradient) {
+      const std::vector<std::uint32_t> &table = detail::gradient_table(gradient);
+      shade_spans(spans, count, detail::radial_gradient(center, radius, static_cast<std::int32_t>(table.size())), table);
+    }
+
+    /**
+     * Fill a polygon with a radial gradient, covering the same pixels as fill_polygon
+     */
+    void fill_radial_gradient(const PointF *points, const std::size_t count, const PointF center, const float radius,
+                              const Gradient &gradient, const FillRule rule = FillRule::NonZero) {
+      const std::vector<std::uint32_t> &table = detail::gradient_table(gradient);
+      shade_polygon(points, count, rule, detail::radial_gradient(center, radius, static_cast<std::int32_t>(table.size())), table);
+    }
+
+  public: /* Patterns */
+    /**
+     * Tile the whole bitmap with `tile`, its pixel (0, 0) landing on (origin_x, origin_y) and repeating in
+     * every direction. The first period of each row is copied from the tile and doubled across the row with
+     * memcpy, then whole periods of rows are doubled the same way, so large fills cost about a memory copy.
+     * `tile` may view this bitmap.
+     *   @throws bmp::Exception when the tile is empty
+     */
+    void fill_pattern(const BitmapView &tile, const std::int32_t origin_x = 0, const std::int32_t origin_y = 0) {
+      fill_pattern_in(0, 0, m_width, m_height, tile, origin_x, origin_y, "Bitmap::fill_pattern");
+    }
+
+    void fill_pattern(const Bitmap &tile, const std::int32_t origin_x = 0, const std::int32_t origin_y = 0) {
+      fill_pattern(tile.view(), origin_x, origin_y);
+    }
+
+    /**
+     * Tile a rect with `tile`, positioned in bitmap coordinates like the rect itself
+     *   @throws bmp::Exception when the rect is out of bounds or the tile is empty
+     */
+    void fill_pattern(const std::int32_t x, const std::int32_t y, const std::int32_t width, const std::int32_t height,
+                      const BitmapView &tile, const std::int32_t origin_x = 0, const std::int32_t origin_y = 0) {
+      if (!in_bounds(x, y) || !in_bounds(x + (width - 1), y + (height - 1)))
+        throw Exception(
+          "Bitmap::fill_pattern(" + std::to_string(x) + ", " + std::to_string(y) + ", " + std::to_string(width) + ", " +
+          std::to_string(height) + "): x,y,w or h out of bounds");
+      fill_pattern_in(x, y, width, height, tile, origin_x, origin_y, "Bitmap::fill_pattern");
+    }
+
+    void fill_pattern(const std::int32_t x, const std::int32_t y, const std::int32_t width, const std::int32_t height,
+                      const Bitmap &tile, const std::int32_t origin_x = 0, const std::int32_t origin_y = 0) {
+      fill_pattern(x, y, width, height, tile.view(), origin_x, origin_y);
+    }
+
+    /**
+     * Fill the whole bitmap with a checkerboard of cell_width x cell_height cells, the cell whose top left
+     * corner is (origin_x, origin_y) colored `first` and its neighbours `second`. Rows are built and doubled
+     * like fill_pattern does.
+     *   @throws bmp::Exception when a cell dimension is not positive
+     */
+    void fill_checkerboard(const std::int32_t cell_width, const std::int32_t cell_height, const Pixel first, const Pixel second,
+                           const std::int32_t origin_x = 0, const std::int32_t origin_y = 0) {
+      if (cell_width <= 0 || cell_height <= 0)
+        throw Exception("Bitmap::fill_checkerboard(" + std::to_string(cell_width) + ", " + std::to_string(cell_height) +
+                        "): cell width and height must be positive");
+      fill_periodic(0, 0, m_width, m_height, 2 * static_cast<std::int64_t>(cell_width), 2 * static_cast<std::int64_t>(cell_height),
+                    origin_x, origin_y, [&](Pixel *dst, const std::int32_t count, const std::int64_t row, const std::int64_t phase) {
+        // Runs of cells alternating colors, starting part way through the cell at `phase`
+        std::int64_t cell = phase / cell_width + row / cell_height;
+        std::int32_t done = 0, run = cell_width - static_cast<std::int32_t>(phase % cell_width);
+        while (done < count) {
+          run = std::min(run, count - done);
+          detail::fill_span(dst + done, static_cast<std::size_t>(run), (cell & 1) == 0 ? first : second);
+          done += run;
+          run = cell_width;
+          ++cell;
+        }
+      });
+    }
+
+  public: /* Region Filling */
+    /**
+     *	Fills the region of pixels equal to pixel (x, y) that is connected to it with `color`.
+     *	Returns the number of pixels filled.
+     *   @throws bmp::Exception on error
+     */
+    std::size_t flood_fill(const std::int32_t x, const std::int32_t y, const Pixel color,
+                           const Connectivity connectivity = Connectivity::Four) {
+      if (!in_bounds(x, y))
+        throw Exception("Bitmap::flood_fill(" + std::to_string(x) + ", " + std::to_string(y) + "): x,y out of bounds");
+
+      const std::uint32_t seed = detail::pack(m_pixels[IX(x, y)]);
+      if (seed == detail::pack(color))
+        return 0;
+      return flood(x, y, color, connectivity,
+                   [&](const std::size_t i) { return detail::pack(m_pixels[i]) == seed; },
+                   [](std::size_t, std::size_t) {});
+    }
+
+    /**
+     *	Fills the region connected to pixel (x, y) whose pixels differ from it by at most `tolerance`
+     *	in every channel with `color`. Returns the number of pixels filled.
+     *   @throws bmp::Exception on error
+     */
+    std::size_t flood_fill(const std::int32_t x, const std::int32_t y, const Pixel color, const std::uint8_t tolerance,
+                           const Connectivity connectivity = Connectivity::Four) {
+      if (!in_bounds(x, y))
+        throw Exception("Bitmap::flood_fill(" + std::to_string(x) + ", " + std::to_string(y) + "): x,y out of bounds");
+
+      // Filled pixels may still be within tolerance of the seed, so they are tracked in a bit mask
+      std::vector<std::uint64_t> &visited = detail::scratch<detail::FloodFillVisited, std::uint64_t>();
+      visited.assign((m_pixels.size() + 63) / 64, 0);
+      const Pixel seed = m_pixels[IX(x, y)];
+      const auto near = [&](const std::uint8_t a, const std::uint8_t b) { return (a > b ? a - b : b - a) <= tolerance; };
+      return flood(x, y, color, connectivity,
+                   [&](const std::size_t i) {
+                     const Pixel &pixel = m_pixels[i];
+                     return !((visited[i / 64] >> (i % 64)) & 1u) &&
+                            near(pixel.r, seed.r) && near(pixel.g, seed.g) && near(pixel.b, seed.b);
+                   },
+                   [&](const std::size_t first, const std::size_t last) {
+                     for (std::size_t i = first; i <= last; ++i)
+                       visited[i / 64] |= std::uint64_t{1} << (i % 64);
+                   });
+    }
+
+  public: /* Text */
+    /**
+     * Draw `text` with the top left corner of its first glyph at (x, y), blending glyph coverage with
+     * `color` at `opacity`. '\n' starts a new line, characters without a glyph leave a blank cell.
+     * Parts outside the bitmap are clipped.
+     */
+    void draw_text(const Font &font, const std::int32_t x, const std::int32_t y, const std::string_view text,
+                   const Pixel color, const std::uint8_t opacity = 255) {
+      draw_text_in(font, x, y, text, color, opacity, bounds());
+    }
+
+    /**
+     * Draw `count` labels in order. The bitmap is split into row bands rendered in parallel, each band
+     * drawing the rows of every label that crosses it, so overlapping labels keep their order.
+     */
+    void draw_text(const Font &font, const TextLabel *labels, const std::size_t count) {
+      if (count == 0 || !font)
+        return;
+      std::vector<std::int64_t> &bottoms = detail::scratch<detail::TextLabelBottoms, std::int64_t>();
+      bottoms.resize(count);
+      for (std::size_t i = 0; i < count; ++i)
+        bottoms[i] = static_cast<std::int64_t>(labels[i].y) + font.text_height(labels[i].text);
+
+      const auto band = [&](const std::int32_t first, const std::int32_t last) {
+        const detail::ClipRect clip{0, first, m_width, last};
+        for (std::size_t i = 0; i < count; ++i) {
+          const TextLabel &label = labels[i];
+          if (label.y < last && bottoms[i] > first)
+            draw_text_in(font, label.x, label.y, label.text, label.color, label.opacity, clip);
+        }
+      };
+      if (count < 64)
+        band(0, m_height);
+      else
+        detail::parallel_rows(0, m_height, std::max(font.glyph_height(), detail::rows_per_band(m_width)), band);
+    }
+
+  public: /* Anti-aliased Draw Primitives */
+    /**
+     * Draw an anti-aliased line from (x1, y1) to (x2, y2) with Xiaolin Wu's algorithm.
+     * Pixels are blended with their coverage, parts outside the bitmap are clipped.
+     */
+    void draw_line_aa(float x1, float y1, float x2, float y2, const Pixel color) noexcept {
+      const bool steep = std::abs(y2 - y1) > std::abs(x2 - x1);
+      if (steep) {
+        std::swap(x1, y1);
+        std::swap(x2, y2);
+      }
+      if (x1 > x2) {
+        std::swap(x1, x2);
+        std::swap(y1, y2);
+      }
+      const float major_extent = static_cast<float>(steep ? m_height : m_width);
+      const float minor_extent = static_cast<float>(steep ? m_width : m_height);
+      if (!(x2 >= -1.0f && x1 <= major_extent && std::max(y1, y2) >= -1.0f && std::min(y1, y2) <= minor_extent))
+        return;
+
+      const float dx = x2 - x1;
+      const float gradient = dx == 0.0f ? 1.0f : (y2 - y1) / dx;
+      const auto plot = [&](const std::int32_t major, const std::int32_t minor, const float coverage) {
+        blend_pixel(steep ? minor : major, steep ? major : minor, color, detail::coverage_alpha(coverage));
+      };
+      const auto fraction = [](const float v) { return v - std::floor(v); };
+
+      // First endpoint
+      float x_end = std::round(x1);
+      float y_end = y1 + gradient * (x_end - x1);
+      float x_gap = 1.0f - fraction(x1 + 0.5f);
+      const auto major_first = static_cast<std::int32_t>(x_end);
+      auto minor = static_cast<std::int32_t>(std::floor(y_end));
+      plot(major_first, minor, (1.0f - fraction(y_end)) * x_gap);
+      plot(major_first, minor + 1, fraction(y_end) * x_gap);
+      float intersection = y_end + gradient;
+
+      // Second endpoint
+      x_end = std::round(x2);
+      y_end = y2 + gradient * (x_end - x2);
+      x_gap = fraction(x2 + 0.5f);
+      const auto major_last = static_cast<std::int32_t>(x_end);
+      minor = static_cast<std::int32_t>(std::floor(y_end));
+      plot(major_last, minor, (1.0f - fraction(y_end)) * x_gap);
+      plot(major_last, minor + 1, fraction(y_end) * x_gap);
+
+      // Pixel pairs straddling the line, skipping the part before the bitmap
+      std::int32_t first = major_first + 1;
+      if (first < 0) {
+        intersection += gradient * static_cast<float>(-first);
+        first = 0;
+      }
+      const std::int32_t last = std::min(major_last - 1, static_cast<std::int32_t>(major_extent) - 1);
+      for (std::int32_t major = first; major <= last; ++major, intersection += gradient) {
+        const auto row = static_cast<std::int32_t>(std::floor(intersection));
+        const float coverage = fraction(intersection);
+        plot(major, row, 1.0f - coverage);
+        plot(major, row + 1, coverage);
+      }
+    }
+
+    /**
+     * Draw an anti-aliased one pixel wide circle. Coverage falls off linearly with the distance
+     * of each pixel center to the ideal circle; parts outside the bitmap are clipped.
+     */
+    void draw_circle_aa(const float center_x, const float center_y, const float radius, const Pixel color) noexcept {
+      if (!(radius >= 0.0f))
+        return;
+      const float outer = radius + 1.0f;
+      const float inner = radius - 1.0f;
+      const std::int32_t first = std::max(0, static_cast<std::int32_t>(std::ceil(std::max(center_y - outer, -1.0f))));
+      const std::int32_t last = std::min(m_height - 1, static_cast<std::int32_t>(std::floor(std::min(center_y + outer, static_cast<float>(m_height)))));
+      for (std::int32_t y = first; y <= last; ++y) {
+        const float dy = static_cast<float>(y) - center_y;
+        const float outer_squared = outer * outer - dy * dy;
+        if (outer_squared <= 0.0f)
+          continue;
+        const float outer_half = std::sqrt(outer_squared);
+        const float inner_squared = inner > 0.0f ? inner * inner - dy * dy : -1.0f;
+        const std::int32_t left = static_cast<std::int32_t>(std::ceil(center_x - outer_half));
+        const std::int32_t right = static_cast<std::int32_t>(std::floor(center_x + outer_half));
+        const auto ring = [&](const std::int32_t x1, const std::int32_t x2) {
+          for (std::int32_t x = std::max(x1, 0); x <= std::min(x2, m_width - 1); ++x) {
+            const float dx = static_cast<float>(x) - center_x;
+            const float distance = std::sqrt(dx * dx + dy * dy);
+            blend_pixel(x, y, color, detail::coverage_alpha(1.0f - std::abs(distance - radius)));
+          }
+        };
+        if (inner_squared <= 0.0f) {
+          ring(left, right);
+        } else {
+          const float inner_half = std::sqrt(inner_squared);
+          const std::int32_t left_end = static_cast<std::int32_t>(std::floor(center_x - inner_half));
+          ring(left, left_end);
+          ring(std::max(static_cast<std::int32_t>(std::ceil(center_x + inner_half)), left_end + 1), right);
+        }
+      }
+    }
+
+    /**
+     * Fill an anti-aliased circle. Pixels whose center is at least half a pixel inside the circle are
+     * filled with `color`, the rim is blended with its analytic coverage. Parts outside the bitmap are clipped.
+     */
+    void fill_circle_aa(const float center_x, const float center_y, const float radius, const Pixel color) noexcept {
+      if (!(radius > 0.0f))
+        return;
+      const float outer = radius + 0.5f;
+      const float inner = radius - 0.5f;
+      const std::int32_t first = std::max(0, static_cast<std::int32_t>(std::ceil(std::max(center_y - outer, -1.0f))));
+      const std::int32_t last = std::min(m_height - 1, static_cast<std::int32_t>(std::floor(std::min(center_y + outer, static_cast<float>(m_height)))));
+      for (std::int32_t y = first; y <= last; ++y) {
+        const float dy = static_cast<float>(y) - center_y;
+        const float outer_squared = outer * outer - dy * dy;
+        if (outer_squared <= 0.0f)
+          continue;
+        const float outer_half = std::sqrt(outer_squared);
+        const std::int32_t left = static_cast<std::int32_t>(std::ceil(center_x - outer_half));
+        const std::int32_t right = static_cast<std::int32_t>(std::floor(center_x + outer_half));
+        const auto rim = [&](const std::int32_t x1, const std::int32_t x2) {
+          for (std::int32_t x = std::max(x1, 0); x <= std::min(x2, m_width - 1); ++x) {
+            const float dx = static_cast<float>(x) - center_x;
+            blend_pixel(x, y, color, detail::coverage_alpha(outer - std::sqrt(dx * dx + dy * dy)));
+          }
+        };
+        const float inner_squared = inner > 0.0f ? inner * inner - dy * dy : -1.0f;
+        if (inner_squared < 0.0f) {
+          rim(left, right);
+          continue;
+        }
+        const float inner_half = std::sqrt(inner_squared);
+        const std::int32_t solid_left = static_cast<std::int32_t>(std::ceil(center_x - inner_half));
+        const std::int32_t solid_right = static_cast<std::int32_t>(std::floor(center_x + inner_half));
+        rim(left, solid_left - 1);
+        fill_row_in(solid_left, solid_right, y, color, bounds());
+        rim(std::max(solid_right + 1, solid_left), right);
+      }
+    }
+
+    /**
+     * Fill an anti-aliased polygon given by `count` vertices (closed automatically). Coverage of every
+     * pixel is accumulated exactly from the signed area of the edges crossing it, so overlapping parts
+     * of a self intersecting polygon saturate. Parts outside the bitmap are clipped.
+     */
+    void fill_polygon_aa(const PointF *points, const std::size_t count, const Pixel color) {
+      if (count < 3)
+        return;
+      // Pixel (x, y) covers [x - 0.5, x + 0.5], shift so that it covers the cell [x, x + 1]
+      float min_x = points[0].x, max_x = points[0].x, min_y = points[0].y, max_y = points[0].y;
+      for (std::size_t i = 1; i < count; ++i) {
+        min_x = std::min(min_x, points[i].x);
+        max_x = std::max(max_x, points[i].x);
+        min_y = std::min(min_y, points[i].y);
+        max_y = std::max(max_y, points[i].y);
+      }
+      const float left = std::max(0.0f, std::floor(min_x + 0.5f));
+      const float top = std::max(0.0f, std::floor(min_y + 0.5f));
+      const float right = std::min(static_cast<float>(m_width), std::ceil(max_x + 0.5f));
+      const float bottom = std::min(static_cast<float>(m_height), std::ceil(max_y + 0.5f));
+      if (!(left < right && top < bottom))
+        return;
+
+      const auto x0 = static_cast<std::int32_t>(left);
+      const auto y0 = static_cast<std::int32_t>(top);
+      const auto width = static_cast<std::int32_t>(right) - x0;
+      const auto height = static_cast<std::int32_t>(bottom) - y0;
+      const std::size_t stride = static_cast<std::size_t>(width) + 2;
+      // The accumulation buffer is kept all zero between calls: every cell an edge touched is
+      // reset while its row is resolved, so only the cells near the edges are ever cleared.
+      std::vector<float> &accumulation = detail::scratch<detail::CoverageAccumulation, float>();
+      if (accumulation.size() < stride * static_cast<std::size_t>(height))
+        accumulation.resize(stride * static_cast<std::size_t>(height), 0.0f);
+      for (std::size_t i = 0; i < count; ++i) {
+        const PointF &a = points[i];
+        const PointF &b = points[(i + 1) % count];
+        detail::accumulate_edge(accumulation.data(), stride, static_cast<float>(width), static_cast<float>(height),
+                                a.x + 0.5f - left, a.y + 0.5f - top, b.x + 0.5f - left, b.y + 0.5f - top);
+      }
+
+      std::vector<std::uint8_t> &coverage = detail::scratch<detail::CoverageRow, std::uint8_t>();
+      coverage.resize(static_cast<std::size_t>(width));
+      for (std::int32_t y = 0; y < height; ++y) {
+        float *const row = accumulation.data() + static_cast<std::size_t>(y) * stride;
+        Pixel *const pixels = m_pixels.data() + IX(x0, y0 + y);
+        float sum = 0.0f;
+        for (std::int32_t x = 0; x < width;) {
+          std::int32_t end = x;
+          if (row[x] == 0.0f) {
+            // The running sum is constant up to the next edge: fill, skip or blend the run as a whole
+            while (end < width && row[end] == 0.0f) ++end;
+            const std::uint8_t alpha = detail::coverage_alpha(std::abs(sum));
+            if (alpha == 255) {
+              detail::fill_span(pixels + x, static_cast<std::size_t>(end - x), color);
+            } else if (alpha != 0) {
+              std::fill(coverage.begin() + x, coverage.begin() + end, alpha);
+              detail::blend_span(pixels + x, coverage.data() + x, static_cast<std::size_t>(end - x), color);
+            }
+          } else {
+            while (end < width && row[end] != 0.0f) {
+              sum += std::exchange(row[end], 0.0f);
+              coverage[end] = detail::coverage_alpha(std::abs(sum));
+              ++end;
+            }
+            detail::blend_span(pixels + x, coverage.data() + x, static_cast<std::size_t>(end - x), color);
+          }
+          x = end;
+        }
+        row[width] = row[width + 1] = 0.0f;
+      }
+    }
+
+  public: /* Accessors */
+    /**
+     *	Get pixel at position x,y
+     */
+    Pixel &get(const std::int32_t x, const std::int32_t y) {
+      if (!in_bounds(x, y))
+        detail::throw_out_of_bounds("Bitmap::get", x, y);
+      return m_pixels[IX(x, y)];
+    }
+
+    /**
+     *	Get const pixel at position x,y
+     */
+    [[nodiscard]] const Pixel &get(const std::int32_t x, const std::int32_t y) const {
+      if (!in_bounds(x, y))
+        detail::throw_out_of_bounds("Bitmap::get", x, y);
+      return m_pixels[IX(x, y)];
+    }
+
+    /**
+     *	Get pixel at position x,y without the bounds check of get(), which only an assertion keeps
+     */
+    Pixel &at_unchecked(const std::int32_t x, const std::int32_t y) noexcept {
+      assert(in_bounds(x, y) && "Bitmap::at_unchecked: x,y out of bounds");
+      return m_pixels[IX(x, y)];
+    }
+
+    [[nodiscard]] const Pixel &at_unchecked(const std::int32_t x, const std::int32_t y) const noexcept {
+      assert(in_bounds(x, y) && "Bitmap::at_unchecked: x,y out of bounds");
+      return m_pixels[IX(x, y)];
+    }
+
+    /**
+     *	Returns a pointer to the first of the width() pixels of row y, which follow one another in memory.
+     *	Loops over it carry no per pixel checks and can vectorize. y is checked by an assertion only.
+     */
+    [[nodiscard]] Pixel *row(const std::int32_t y) noexcept {
+      assert(y >= 0 && y < m_height && "Bitmap::row: y out of bounds");
+      return m_pixels.data() + IX(0, y);
+    }
+
+    [[nodiscard]] const Pixel *row(const std::int32_t y) const noexcept {
+      assert(y >= 0 && y < m_height && "Bitmap::row: y out of bounds");
+      return m_pixels.data() + IX(0, y);
+    }
+
+    /**
+     *	Returns the width() * height() pixels, row after row
+     */
+    [[nodiscard]] Pixel *data() noexcept { return m_pixels.data(); }
+
+    [[nodiscard]] const Pixel *data() const noexcept { return m_pixels.data(); }
+
+    /**
+     *	Returns all rows of the bitmap, to iterate over
+     */
+    [[nodiscard]] PixelRows<Pixel> rows() noexcept { return {m_pixels.data(), m_width, m_width, 0, m_height}; }
+
+    [[nodiscard]] PixelRows<const Pixel> rows() const noexcept { return {m_pixels.data(), m_width, m_width, 0, m_height}; }
+
+    /**
+     *	Returns rows [first, last) of the bitmap, to iterate over
+     *   @throws bmp::Exception on error
+     */
+    [[nodiscard]] PixelRows<Pixel> rows(const std::int32_t first, const std::int32_t last) {
+      check_rows(first, last);
+      return {m_pixels.data() + IX(0, first), m_width, m_width, first, last};
+    }
+
+    [[nodiscard]] PixelRows<const Pixel> rows(const std::int32_t first, const std::int32_t last) const {
+      check_rows(first, last);
+      return {m_pixels.data() + IX(0, first), m_width, m_width, first, last};
+    }
+
+    /**
+     *	Returns a read only view of all pixels
+     */
+    [[nodiscard]] BitmapView view() const noexcept { return {m_pixels.data(), m_width, m_height, m_width}; }
+
+    /**
+     *	Returns a read only view of the width x height region at x,y
+     *   @throws bmp::Exception on error
+     */
+    [[nodiscard]] BitmapView view(const std::int32_t x, const std::int32_t y, const std::int32_t width,
+                                  const std::int32_t height) const {
+      return view().sub_view(x, y, width, height);
+    }
+
+    /**
+     *	Returns the width of the Bitmap image
+     */
+    [[nodiscard]] std::int32_t width() const noexcept { return m_width; }
+
+    /**
+     *	Returns the height of the Bitmap image
+     */
+    [[nodiscard]] std::int32_t height() const noexcept { return m_height; }
+
+    /**
+     *	Clears Bitmap pixels with an rgb color
+     */
+    void clear(const Pixel pixel = Black) {
+      detail::fill_span(m_pixels.data(), m_pixels.size(), pixel);
+    }
+
+  public: /* Operators */
+    const Pixel &operator[](const std::size_t i) const { return m_pixels[i]; }
+
+    Pixel &operator[](const std::size_t i) { return m_pixels[i]; }
+
+    bool operator!() const noexcept { return (m_pixels.empty()) || (m_width == 0) || (m_height == 0); }
+
+    explicit operator bool() const noexcept { return !(*this); }
+
+    bool operator==(const Bitmap &image) const {
+      if (this == std::addressof(image)) {
+        return true;
+      }
+      return (m_width == image.m_width) &&
+             (m_height == image.m_height) &&
+             (std::memcmp(m_pixels.data(), image.m_pixels.data(), sizeof(Pixel) * m_pixels.size()) == 0);
+    }
+
+    bool operator!=(const Bitmap &image) const { return !(*this == image); }
+
+    Bitmap &operator=(const Bitmap &image) // Copy assignment operator
+    {
+      if (this != std::addressof(image)) {
+        m_width = image.m_width;
+        m_height = image.m_height;
+        m_pixels = image.m_pixels;
+      }
+      return *this;
+    }
+
+    Bitmap &operator=(Bitmap &&image) noexcept {
+      if (this != std::addressof(image)) {
+        m_pixels = std::move(image.m_pixels);
+        m_width = std::exchange(image.m_width, 0);
+        m_height = std::exchange(image.m_height, 0);
+      }
+      return *this;
+    }
+
+  public: /** foreach iterators access */
+    [[nodiscard]] std::vector<Pixel>::iterator begin() noexcept { return m_pixels.begin(); }
+
+    [[nodiscard]] std::vector<Pixel>::iterator end() noexcept { return m_pixels.end(); }
+
+    [[nodiscard]] std::vector<Pixel>::const_iterator cbegin() const noexcept { return m_pixels.cbegin(); }
+
+    [[nodiscard]] std::vector<Pixel>::const_iterator cend() const noexcept { return m_pixels.cend(); }
+
+    [[nodiscard]] std::vector<Pixel>::reverse_iterator rbegin() noexcept { return m_pixels.rbegin(); }
+
+    [[nodiscard]] std::vector<Pixel>::reverse_iterator rend() noexcept { return m_pixels.rend(); }
+
+    [[nodiscard]] std::vector<Pixel>::const_reverse_iterator crbegin() const noexcept { return m_pixels.crbegin(); }
+
+    [[nodiscard]] std::vector<Pixel>::const_reverse_iterator crend() const noexcept { return m_pixels.crend(); }
+
+  public: /* Modifiers */
+    /**
+     *	Sets rgb color to pixel at position x,y
+     *   @throws bmp::Exception on error
+     */
+    void set(const std::int32_t x, const std::int32_t y, const Pixel color) {
+      if (!in_bounds(x, y))
+        detail::throw_out_of_bounds("Bitmap::set", x, y);
+      m_pixels[IX(x, y)] = color;
+    }
+
+    /**
+     *	Sets rgb color to pixel at position x,y without the bounds check of set(), which only an assertion keeps
+     */
+    void set_unchecked(const std::int32_t x, const std::int32_t y, const Pixel color) noexcept {
+      assert(in_bounds(x, y) && "Bitmap::set_unchecked: x,y out of bounds");
+      m_pixels[IX(x, y)] = color;
+    }
+
+
+    /**
+    *	Vertically flips the bitmap and returns the flipped version
+    *
+    */
+    [[nodiscard("Bitmap::flip_v() is immutable")]]
+    Bitmap flip_v() const {
+      return remapped(detail::PixelMapping::identity(m_width, m_height).flipped_v());
+    }
+
+    /**
+    *	Horizontally flips the bitmap and returns the flipped version
+    *
+    */
+    [[nodiscard("Bitmap::flip_h() is immutable")]]
+    Bitmap flip_h() const {
+      return remapped(detail::PixelMapping::identity(m_width, m_height).flipped_h());
+    }
+
+    /**
+    *	Rotates the bitmap to the left and returns the rotated version
+    *
+    */
+    [[nodiscard("Bitmap::rotate_90_left() is immutable")]]
+    Bitmap rotate_90_left() const {
+      return remapped(detail::PixelMapping::identity(m_width, m_height).rotated_left());
+    }
+
+    /**
+    *	Rotates the bitmap to the right and returns the rotated version
+    *
+    */
+    [[nodiscard("Bitmap::rotate_90_right() is immutable")]]
+    Bitmap rotate_90_right() const {
+      return remapped(detail::PixelMapping::identity(m_width, m_height).rotated_right());
+    }
+
+    /**
+    *	Starts a lazy chain of flips, quarter turns and crops over this bitmap.
+    *	The chain is fused into one index mapping and evaluated in a single pass
+    *	by TransformView::to_bitmap(), evaluate() or save(). The bitmap must outlive the view.
+    */
+    [[nodiscard]] TransformView transform() const noexcept;
+
+  public: /* Parallel Algorithms */
+    /**
+     *	Sets every pixel to function(x, y). Bands of rows are handed out to the thread pool one at a time,
+     *	so uneven per pixel costs balance out. `function` is called concurrently and must be thread safe;
+     *	the first exception it throws is rethrown once all bands have finished.
+     */
+    template<typename Function>
+    void generate(Function &&function) {
+      detail::parallel_rows(0, m_height, detail::balanced_band(m_width, m_height), [&](const std::int32_t first, const std::int32_t last) {
+        for (std::int32_t y = first; y < last; ++y) {
+          Pixel *row = m_pixels.data() + IX(0, y);
+          for (std::int32_t x = 0; x < m_width; ++x)
+            row[x] = function(x, y);
+        }
+      });
+    }
+
+    /**
+     *	Calls function(PixelRow) once for every row, concurrently on the thread pool as generate() does
+     */
+    template<typename Function>
+    void for_each_row(Function &&function) {
+      detail::parallel_rows(0, m_height, detail::balanced_band(m_width, m_height), [&](const std::int32_t first, const std::int32_t last) {
+        for (std::int32_t y = first; y < last; ++y)
+          function(PixelRow<Pixel>(m_pixels.data() + IX(0, y), m_width, y));
+      });
+    }
+
+    template<typename Function>
+    void for_each_row(Function &&function) const {
+      detail::parallel_rows(0, m_height, detail::balanced_band(m_width, m_height), [&](const std::int32_t first, const std::int32_t last) {
+        for (std::int32_t y = first; y < last; ++y)
+          function(PixelRow<const Pixel>(m_pixels.data() + IX(0, y), m_width, y));
+      });
+    }
+
+  public: /* Compositing */
+    /**
+     *	Composites `source` onto this bitmap with its top left corner at (x, y), mixing every
+     *	pixel with the result of `mode` at the constant `opacity`. Parts outside this bitmap are
+     *	clipped. `source` must not overlap this bitmap.
+     */
+    void blend(const BitmapView &source, const std::int32_t x, const std::int32_t y,
+               const BlendMode mode = BlendMode::Normal, const std::uint8_t opacity = 255) {
+      composite(source, nullptr, 0, x, y, mode, opacity);
+    }
+
+    /**
+     *	Composites `source` onto this bitmap with its top left corner at (x, y) using a per pixel
+     *	alpha mask: source pixel (i, j) has alpha alpha[j * alpha_stride + i] (scaled by `opacity`).
+     *	Parts outside this bitmap are clipped. `source` must not overlap this bitmap.
+     *   @throws bmp::Exception on error
+     */
+    void blend(const BitmapView &source, const std::uint8_t *alpha, const std::int32_t alpha_stride,
+               const std::int32_t x, const std::int32_t y, const BlendMode mode = BlendMode::Normal,
+               const std::uint8_t opacity = 255) {
+      if (alpha == nullptr || alpha_stride < source.width())
+        throw Exception("Bitmap::blend: alpha mask is null or its stride " + std::to_string(alpha_stride) +
+                        " is smaller than the source width " + std::to_string(source.width()));
+      composite(source, alpha, alpha_stride, x, y, mode, opacity);
+    }
+
+  public: /* Blitting */
+    /**
+     *	Copies the width x height rectangle of `source` at (source_x, source_y) to (x, y).
+     *	Both rectangles are clipped, rows are copied with memcpy. `source` may be this bitmap.
+     */
+    void blit(const Bitmap &source, const std::int32_t source_x, const std::int32_t source_y, const std::int32_t width,
+              const std::int32_t height, const std::int32_t x, const std::int32_t y) {
+      blit_rect(source, {source_x, source_y, width, height, x, y}, nullptr);
+    }
+
+    /**
+     *	Copies the width x height rectangle of `source` at (source_x, source_y) to (x, y),
+     *	leaving destination pixels untouched where the source pixel equals `key`.
+     *	Both rectangles are clipped. `source` may be this bitmap.
+     */
+    void blit(const Bitmap &source, const std::int32_t source_x, const std::int32_t source_y, const std::int32_t width,
+              const std::int32_t height, const std::int32_t x, const std::int32_t y, const Pixel key) {
+      blit_rect(source, {source_x, source_y, width, height, x, y}, &key);
+    }
+
+    /**
+     *	Copies `count` sprites of `atlas` in order, each clipped like the single sprite blit
+     */
+    void blit(const Bitmap &atlas, const Sprite *sprites, const std::size_t count) {
+      for (std::size_t i = 0; i < count; ++i)
+        blit_rect(atlas, sprites[i], nullptr);
+    }
+
+    /**
+     *	Copies `count` sprites of `atlas` in order with `key` as the transparent color
+     */
+    void blit(const Bitmap &atlas, const Sprite *sprites, const std::size_t count, const Pixel key) {
+      for (std::size_t i = 0; i < count; ++i)
+        blit_rect(atlas, sprites[i], &key);
+    }
+
+  public: /* Resampling */
+    /**
+     *	Resamples the bitmap into `destination`, whose current width and height define the output size.
+     *	Reuses the destination pixels and internal scratch buffers so repeated calls do not allocate.
+     *   @throws bmp::Exception on error
+     */
+    void resize(Bitmap &destination, const ResizeFilter filter = ResizeFilter::Bilinear) const {
+      if (this == std::addressof(destination))
+        throw Exception("Bitmap::resize: destination must not be the source bitmap");
+      if (!*this || !destination)
+        throw Exception("Bitmap::resize: source and destination must not be empty");
+
+      const std::int32_t out_width = destination.m_width;
+      const std::int32_t out_height = destination.m_height;
+      Pixel *const out = destination.m_pixels.data();
+
+      if (filter == ResizeFilter::Nearest) {
+        std::vector<std::int32_t> &columns = detail::ResizeScratch::local().columns;
+        columns.resize(out_width);
+        for (std::int32_t x = 0; x < out_width; ++x)
+          columns[x] = static_cast<std::int32_t>((static_cast<std::int64_t>(x) * 2 + 1) * m_width / (2 * out_width));
+        const std::int32_t *const map = columns.data();
+        detail::parallel_rows(0, out_height, detail::rows_per_band(out_width), [&](std::int32_t first, std::int32_t last) {
+          for (std::int32_t y = first; y < last; ++y) {
+            const std::int32_t sy = static_cast<std::int32_t>((static_cast<std::int64_t>(y) * 2 + 1) * m_height / (2 * out_height));
+            const Pixel *src = m_pixels.data() + IX(0, sy);
+            Pixel *dst = out + destination.IX(0, y);
+            for (std::int32_t x = 0; x < out_width; ++x) dst[x] = src[map[x]];
+          }
+        });
+        return;
+      }
+
+      detail::ResizeScratch &scratch = detail::ResizeScratch::local();
+      detail::ResizeCoefficients &horizontal = scratch.horizontal;
+      detail::ResizeCoefficients &vertical = scratch.vertical;
+      detail::compute_resize_coefficients(horizontal, m_width, out_width, filter);
+      detail::compute_resize_coefficients(vertical, m_height, out_height, filter);
+
+      // Only the source rows referenced by the vertical pass need horizontal filtering
+      const std::int32_t row_first = vertical.first.front();
+      const std::int32_t row_last = vertical.first.back() + vertical.count.back();
+
+      scratch.rows.resize(static_cast<std::size_t>(out_width) * (row_last - row_first));
+      Pixel *const rows = scratch.rows.data();
+
+      if (out_width == m_width) {
+        std::copy(m_pixels.begin() + IX(0, row_first), m_pixels.begin() + IX(0, row_last), rows);
+      } else {
+        detail::parallel_rows(row_first, row_last, detail::rows_per_band(m_width), [&](std::int32_t first, std::int32_t last) {
+          for (std::int32_t y = first; y < last; ++y)
+            detail::resample_row(m_pixels.data() + IX(0, y), rows + static_cast<std::size_t>(y - row_first) * out_width,
+                                 out_width, horizontal);
+        });
+      }
+
+      const std::size_t channels = static_cast<std::size_t>(out_width) * sizeof(Pixel);
+      detail::parallel_rows(0, out_height, detail::rows_per_band(out_width), [&](std::int32_t first, std::int32_t last) {
+        for (std::int32_t y = first; y < last; ++y) {
+          auto *dst = reinterpret_cast<std::uint8_t *>(out + destination.IX(0, y));
+          // Same height: output row y is source row y, whatever window the filter would have used
+          if (out_height == m_height) {
+            std::memcpy(dst, rows + static_cast<std::size_t>(y - row_first) * out_width, channels);
+            continue;
+          }
+          const auto *src = reinterpret_cast<const std::uint8_t *>(rows + static_cast<std::size_t>(vertical.first[y] - row_first) * out_width);
+          detail::resample_column(src, channels, vertical.weights.data() + static_cast<std::size_t>(y) * vertical.taps,
+                                  vertical.count[y], dst);
+        }
+      });
+    }
+
+    /**
+     *	Resamples the bitmap to width x height and returns the resized version
+     *   @throws bmp::Exception on error
+     */
+    [[nodiscard("Bitmap::resize() is immutable")]]
+    Bitmap resize(const std::int32_t width, const std::int32_t height, const ResizeFilter filter = ResizeFilter::Bilinear) const {
+      Bitmap finished(width, height);
+      resize(finished, filter);
+      return finished;
+    }
+
+    /**
+     *	Maps the bitmap into `destination` through `transform` (source to destination pixel coordinates)
+     *	with bilinear sampling. Destination pixels not covered by the source are set to `background`.
+     *   @throws bmp::Exception on error
+     */
+    void warp_affine(Bitmap &destination, const AffineTransform &transform, const Pixel background = Black) const {
+      if (this == std::addressof(destination))
+        throw Exception("Bitmap::warp_affine: destination must not be the source bitmap");
+      if (!*this || !destination)
+        throw Exception("Bitmap::warp_affine: source and destination must not be empty");
+
+      const AffineTransform inverse = transform.inverse();
+      constexpr double one = static_cast<double>(std::int64_t{1} << detail::WARP_FRACTION_BITS);
+      constexpr double limit = static_cast<double>(std::int64_t{1} << 61);
+      const auto fixed = [&](const double value) {
+        return static_cast<std::int64_t>(std::llround(std::clamp(value * one, -limit, limit)));
+      };
+      const std::int64_t step_x = fixed(inverse.a);
+      const std::int64_t step_y = fixed(inverse.d);
+
+      detail::parallel_rows(0, destination.m_height, detail::rows_per_band(destination.m_width), [&](std::int32_t first, std::int32_t last) {
+        for (std::int32_t y = first; y < last; ++y) {
+          // Source position of the first pixel; the rest of the row is reached by stepping
+          detail::warp_scanline(m_pixels.data(), m_width, m_height,
+                                destination.m_pixels.data() + destination.IX(0, y), destination.m_width,
+                                fixed(inverse.b * y + inverse.c), fixed(inverse.e * y + inverse.f),
+                                step_x, step_y, background);
+        }
+      });
+    }
+
+    /**
+     *	Rotates the bitmap clockwise by an arbitrary angle around its center and returns the rotated version.
+     *	The result is enlarged to fit the whole rotated image, uncovered areas are set to `background`.
+     */
+    [[nodiscard("Bitmap::rotate() is immutable")]]
+    Bitmap rotate(const double degrees, const Pixel background = Black) const {
+      const AffineTransform rotation = AffineTransform::rotation(degrees);
+      const auto extent = [](const double w, const double h, const double cos, const double sin) {
+        return static_cast<std::int32_t>(std::ceil(std::abs(w * cos) + std::abs(h * sin) - 1e-9));
+      };
+      const std::int32_t width = std::max(1, extent(m_width, m_height, rotation.a, rotation.b));
+      const std::int32_t height = std::max(1, extent(m_height, m_width, rotation.a, rotation.b));
+
+      Bitmap finished(width, height);
+      warp_affine(finished,
+                  AffineTransform::translation((width - 1) / 2.0, (height - 1) / 2.0) * rotation *
+                    AffineTransform::translation(-(m_width - 1) / 2.0, -(m_height - 1) / 2.0),
+                  background);
+      return finished;
+    }
+
+    /**
+     *	Saves Bitmap pixels into a file
+     *   @throws bmp::Exception on error
+     */
+    void save(const std::filesystem::path &filename) const {
+      detail::write_bitmap(filename, m_width, m_height, [this](const std::int32_t y) { return m_pixels.data() + IX(0, y); },
+                           "Bitmap::save");
+    }
+
+    /**
+     *	Loads Bitmap from file
+     *   @throws bmp::Exception on error
+     */
+    void load(const std::filesystem::path &filename) {
+      m_pixels.clear();
+
+      if (std::ifstream ifs{filename, std::ios::binary}; ifs.good()) {
+        // Read Header
+        std::unique_ptr<BitmapHeader> header(new BitmapHeader());
+        ifs.read(reinterpret_cast<char *>(header.get()), sizeof(BitmapHeader));
+
+        // Check if Bitmap file is valid
+        if (header->magic != BITMAP_BUFFER_MAGIC) {
+          throw Exception("Bitmap::load(\"" + filename.string() + "\"): Unrecognized file format.");
+        }
+        // Check if the Bitmap file has 24 bits per pixel (for now supporting only 24bpp bitmaps)
+        if (header->bits_per_pixel != 24) {
+          throw Exception("Bitmap::load(\"" + filename.string() + "\"): Only 24 bits per pixel bitmaps supported.");
+        }
+
+        // Seek the beginning of the pixels data
+        // Note: We can't just assume we're there right after we read the BitmapHeader
+        // Because some editors like Gimp might put extra information after the header.
+        // Thanks to @seeliger-ec
+        ifs.seekg(header->offset_bits);
+
+        // Set width & height
+        m_width = header->width;
+        m_height = header->height;
+
+        // Resize pixels size
+        m_pixels.resize(static_cast<std::size_t>(m_width) * static_cast<std::size_t>(m_height), Black);
+
+        // Read Bitmap pixels
+        const std::int32_t row_size = m_width * 3 + m_width % 4;
+        std::vector<std::uint8_t> line(row_size);
+        for (std::int32_t y = m_height - 1; y >= 0; --y) {
+          ifs.read(reinterpret_cast<char *>(line.data()), line.size());
+          if (!ifs.good())
+            throw Exception("Bitmap::load(\"" + filename.string() + "\"): Failed to read bitmap pixels from file.");
+          std::size_t i = 0;
+          for (std::int32_t x = 0; x < m_width; ++x) {
+            Pixel color{};
+            color.b = line[i++];
+            color.g = line[i++];
+            color.r = line[i++];
+            m_pixels[IX(x, y)] = color;
+          }
+        }
+      } else
+        throw Exception("Bitmap::load(\"" + filename.string() + "\"): Failed to load bitmap pixels from file.");
+    }
+
+  private: /* Rasterizers */
+    /*
+     * Every primitive is rasterized against a clip rectangle: vertical extents are clipped once per shape,
+     * each span is clamped once per row, and only pixels inside `clip` are ever visited.
+     */
+
+    void draw_line_in(const std::int32_t x1, const std::int32_t y1, const std::int32_t x2, const std::int32_t y2,
+                      const Pixel color, const detail::ClipRect &clip) noexcept {
+      if (clip.x0 >= clip.x1 || clip.y0 >= clip.y1)
+        return;
+      const std::int64_t dx = std::abs(static_cast<std::int64_t>(x2) - x1);
+      const std::int64_t dy = std::abs(static_cast<std::int64_t>(y2) - y1);
+      const std::int32_t sx = (x1 < x2) ? 1 : -1;
+      const std::int32_t sy = (y1 < y2) ? 1 : -1;
+
+      // Step i (0..steps) of Bresenham's algorithm lands at major = start + i and
+      // minor = start + floor((2 * i * minor_delta + steps - 1) / (2 * steps)), so the range of
+      // visible steps along each axis can be solved for directly (Liang-Barsky style) and walked
+      // without per-pixel bounds checks.
+      const bool x_major = dx >= dy;
+      const std::int64_t steps = x_major ? dx : dy;
+      const std::int64_t minor_delta = x_major ? dy : dx;
+      const std::int64_t major_start = x_major ? x1 : y1;
+      const std::int64_t minor_start = x_major ? y1 : x1;
+      const std::int32_t major_sign = x_major ? sx : sy;
+      const std::int32_t minor_sign = x_major ? sy : sx;
+      const std::int64_t major_lo = x_major ? clip.x0 : clip.y0, major_hi = (x_major ? clip.x1 : clip.y1) - 1;
+      const std::int64_t minor_lo = x_major ? clip.y0 : clip.x0, minor_hi = (x_major ? clip.y1 : clip.x1) - 1;
+
+      std::int64_t first = major_sign > 0 ? major_lo - major_start : major_start - major_hi;
+      std::int64_t last = major_sign > 0 ? major_hi - major_start : major_start - major_lo;
+      first = std::max<std::int64_t>(first, 0);
+      last = std::min(last, steps);
+
+      // Visible offsets k along the minor axis
+      const std::int64_t k_lo = std::max<std::int64_t>(minor_sign > 0 ? minor_lo - minor_start : minor_start - minor_hi, 0);
+      const std::int64_t k_hi = minor_sign > 0 ? minor_hi - minor_start : minor_start - minor_lo;
+      if (k_lo > k_hi)
+        return;
+      if (steps == 0 || minor_delta == 0) {
+        if (k_lo > 0)
+          return;
+      } else {
+        first = std::max(first, detail::ceil_div(2 * steps * k_lo - steps + 1, 2 * minor_delta));
+        last = std::min(last, detail::ceil_div(2 * steps * (k_hi + 1) - steps + 1, 2 * minor_delta) - 1);
+      }
+      if (first > last)
+        return;
+
+      const std::int64_t twice_steps = 2 * std::max<std::int64_t>(steps, 1);
+      const std::int64_t numerator = 2 * first * minor_delta + steps - 1;
+      const std::int64_t k = steps == 0 ? 0 : numerator / twice_steps;
+      std::int64_t remainder = steps == 0 ? 0 : numerator - k * twice_steps;
+
+      const std::int64_t major = major_start + major_sign * first;
+      const std::int64_t minor = minor_start + minor_sign * k;
+      const auto x = static_cast<std::int32_t>(x_major ? major : minor);
+      const auto y = static_cast<std::int32_t>(x_major ? minor : major);
+      const std::ptrdiff_t major_stride = x_major ? sx : static_cast<std::ptrdiff_t>(sy) * m_width;
+      const std::ptrdiff_t minor_stride = x_major ? static_cast<std::ptrdiff_t>(sy) * m_width : sx;
+
+      Pixel *const pixels = m_pixels.data();
+      std::ptrdiff_t index = static_cast<std::ptrdiff_t>(IX(x, y));
+      for (std::int64_t i = first; i <= last; ++i) {
+        pixels[index] = color;
+        index += major_stride;
+        remainder += 2 * minor_delta;
+        if (remainder >= twice_steps) {
+          remainder -= twice_steps;
+          index += minor_stride;
+        }
+      }
+    }
+
+    /**
+     *	Fills pixels x1..x2 (inclusive) of row y that lie inside `clip`
+     */
+    void fill_row_in(const std::int64_t x1, const std::int64_t x2, const std::int64_t y, const Pixel color,
+                     const detail::ClipRect &clip) noexcept {
+      const std::int64_t first = std::max<std::int64_t>(x1, clip.x0), last = std::min<std::int64_t>(x2, clip.x1 - 1);
+      if (y >= clip.y0 && y < clip.y1 && first <= last)
+        fill_row(static_cast<std::int32_t>(first), static_cast<std::int32_t>(last), static_cast<std::int32_t>(y), color);
+    }
+
+    /**
+     *	Fills a shape symmetric about its center row, `radius` rows up and down, visiting only rows inside `clip`.
+     *	The rows at vertical offset dy span outer_half(dy) pixels left and right of center_x, minus a hole of
+     *	inner_half(dy) pixels when that is >= 0. Both half widths are computed once for the two rows at dy.
+     */
+    template<typename OuterHalf, typename InnerHalf>
+    void fill_symmetric_in(const std::int32_t center_x, const std::int32_t center_y, const std::int32_t radius,
+                           const Pixel color, const detail::ClipRect &clip, OuterHalf &&outer_half,
+                           InnerHalf &&inner_half) noexcept {
+      // Offsets of the visible rows below the center, mirrored for the rows above it
+      const std::int64_t below_first = clip.y0 - static_cast<std::int64_t>(center_y);
+      const std::int64_t below_last = clip.y1 - 1 - static_cast<std::int64_t>(center_y);
+      const std::int64_t first = below_first > 0 ? below_first : below_last < 0 ? -below_last : 0;
+      const std::int64_t last = std::min<std::int64_t>(std::max(below_last, -below_first), radius);
+      for (std::int64_t dy = first; dy <= last; ++dy) {
+        const std::int64_t outer = outer_half(dy), inner = inner_half(dy);
+        for (const std::int64_t y: {center_y + dy, center_y - dy}) {
+          if (inner < 0) {
+            fill_row_in(center_x - outer, center_x + outer, y, color, clip);
+          } else {
+            fill_row_in(center_x - outer, center_x - inner - 1, y, color, clip);
+            fill_row_in(center_x + inner + 1, center_x + outer, y, color, clip);
+          }
+          if (dy == 0)
+            break;
+        }
+      }
+    }
+
+    void fill_rect_in(const std::int32_t x, const std::int32_t y, const std::int32_t width, const std::int32_t height,
+                      const Pixel color, const detail::ClipRect &clip) noexcept {
+      if (width <= 0 || height <= 0)
+        return;
+      const std::int32_t x1 = std::max(x, clip.x0);
+      const std::int32_t x2 = static_cast<std::int32_t>(std::min<std::int64_t>(static_cast<std::int64_t>(x) + width, clip.x1)) - 1;
+      const std::int32_t y1 = std::max(y, clip.y0);
+      const std::int32_t y2 = static_cast<std::int32_t>(std::min<std::int64_t>(static_cast<std::int64_t>(y) + height, clip.y1));
+      for (std::int32_t dy = y1; dy < y2; ++dy)
+        fill_row(x1, x2, dy, color);
+    }
+
+    void draw_rect_in(const std::int32_t x, const std::int32_t y, const std::int32_t width, const std::int32_t height,
+                      const Pixel color, const detail::ClipRect &clip) noexcept {
+      if (width <= 0 || height <= 0)
+        return;
+      const std::int32_t right = x + width - 1;
+      const std::int32_t bottom = y + height - 1;
+      fill_row_in(x, right, y, color, clip);      // top
+      fill_row_in(x, right, bottom, color, clip); // bottom
+      const std::int32_t y1 = std::max(y + 1, clip.y0);
+      const std::int32_t y2 = std::min(bottom - 1, clip.y1 - 1);
+      const bool left_visible = x >= clip.x0 && x < clip.x1;
+      const bool right_visible = right >= clip.x0 && right < clip.x1;
+      for (std::int32_t dy = y1; dy <= y2; ++dy) {
+        if (left_visible) m_pixels[IX(x, dy)] = color;      // left
+        if (right_visible) m_pixels[IX(right, dy)] = color; // right
+      }
+    }
+
+    void draw_triangle_in(const std::int32_t x1, const std::int32_t y1,
+                          const std::int32_t x2, const std::int32_t y2,
+                          const std::int32_t x3, const std::int32_t y3,
+                          const Pixel color, const detail::ClipRect &clip) noexcept {
+      draw_line_in(x1, y1, x2, y2, color, clip);
+      draw_line_in(x2, y2, x3, y3, color, clip);
+      draw_line_in(x3, y3, x1, y1, color, clip);
+    }
+
+    void fill_triangle_in(const std::int32_t x1, const std::int32_t y1,
+                          const std::int32_t x2, const std::int32_t y2,
+                          const std::int32_t x3, const std::int32_t y3,
+                          const Pixel color, const detail::ClipRect &clip) {
+      const detail::TriangleEdges triangle(x1, y1, x2, y2, x3, y3);
+      const std::int32_t first = std::max(triangle.top(), clip.y0);
+      const std::int32_t last = std::min(triangle.bottom(), clip.y1 - 1);
+      if (triangle.empty() || first > last)
+        return;
+
+      // Each row's span is solved exactly from the edge functions, then written with fill_span
+      const auto rasterize = [&](const std::int32_t row_first, const std::int32_t row_last) {
+        for (std::int32_t y = row_first; y < row_last; ++y) {
+          std::int32_t x_first, x_last;
+          triangle.span(y, x_first, x_last);
+          fill_row(std::max(x_first, clip.x0), std::min(x_last, clip.x1 - 1), y, color);
+        }
+      };
+
+      const std::int64_t visible_width = std::min(triangle.right(), clip.x1 - 1) - std::max(triangle.left(), clip.x0) + 1;
+      if (visible_width * (last - first + 1) < detail::PARALLEL_TRIANGLE_AREA) {
+        rasterize(first, last + 1);
+        return;
+      }
+      detail::parallel_rows(first, last + 1, detail::rows_per_band(static_cast<std::int32_t>(visible_width)), rasterize);
+    }
+
+    void draw_circle_in(const std::int32_t center_x, const std::int32_t center_y, const std::int32_t radius,
+                        const Pixel color, const detail::ClipRect &clip) noexcept {
+      if (radius < 0 || clip.x0 >= clip.x1 || clip.y0 >= clip.y1)
+        return;
+
+      const std::int64_t r = radius;
+      if (center_x - r >= clip.x0 && center_x + r < clip.x1 && center_y - r >= clip.y0 && center_y + r < clip.y1) {
+        // Entirely visible: one walk plots all eight octants
+        Pixel *const center = m_pixels.data() + IX(center_x, center_y);
+        const std::ptrdiff_t width = m_width;
+        std::int32_t x = radius, y = 0, err = 0;
+        while (x >= y) {
+          center[y * width + x] = color;
+          center[x * width + y] = color;
+          center[x * width - y] = color;
+          center[y * width - x] = color;
+          center[-y * width - x] = color;
+          center[-x * width - y] = color;
+          center[-x * width + y] = color;
+          center[-y * width + x] = color;
+          if (err <= 0) {
+            y += 1;
+            err += 2 * y + 1;
+          }
+          if (err > 0) {
+            x -= 1;
+            err -= 2 * x + 1;
+          }
+        }
+        return;
+      }
+
+      // Otherwise the walk over the first octant (x >= y) is mirrored into all eight. x only falls and y only rises, so
+      // the states a mirror shows inside the clip are one stretch of the walk: it is entered in closed form
+      // and walked without per-pixel bounds checks, like the visible steps of draw_line_in.
+      for (std::int32_t octant = 0; octant < 8; ++octant) {
+        const std::int32_t sx = (octant & 1) ? -1 : 1, sy = (octant & 2) ? -1 : 1;
+        const bool swap = (octant & 4) != 0;
+
+        // Pixel (center_x + sx * u, center_y + sy * v) with (u, v) = (x, y), or (y, x) when swapped
+        const std::int64_t u_lo = sx > 0 ? clip.x0 - static_cast<std::int64_t>(center_x) : center_x - static_cast<std::int64_t>(clip.x1 - 1);
+        const std::int64_t u_hi = sx > 0 ? clip.x1 - 1 - static_cast<std::int64_t>(center_x) : center_x - static_cast<std::int64_t>(clip.x0);
+        const std::int64_t v_lo = sy > 0 ? clip.y0 - static_cast<std::int64_t>(center_y) : center_y - static_cast<std::int64_t>(clip.y1 - 1);
+        const std::int64_t v_hi = sy > 0 ? clip.y1 - 1 - static_cast<std::int64_t>(center_y) : center_y - static_cast<std::int64_t>(clip.y0);
+        const std::int64_t x_lo = swap ? v_lo : u_lo, x_hi = std::min(swap ? v_hi : u_hi, r);
+        const std::int64_t y_lo = std::max<std::int64_t>(swap ? u_lo : v_lo, 0), y_hi = swap ? u_hi : v_hi;
+        if (x_lo > x_hi || y_lo > y_hi || y_lo > r || x_hi < 0)
+          continue;
+
+        // First state on row y_lo or later, and first in column x_hi or later; the walk enters at the later one
+        std::int64_t x = std::max(detail::midpoint_row_end(r, y_lo), detail::midpoint_column_end(r, y_lo));
+        std::int64_t y = y_lo;
+        if (x_hi < x) {
+          x = x_hi;
+          y = std::max(y, detail::midpoint_column_end(r, x_hi + 1) + 1);
+        }
+        if (x < y || x < x_lo || y > y_hi)
+          continue;
+
+        std::int64_t err = (x - r) * (x + r) + y * (y + 2);
+        const std::ptrdiff_t x_step = swap ? static_cast<std::ptrdiff_t>(sy) * m_width : sx;
+        const std::ptrdiff_t y_step = swap ? sx : static_cast<std::ptrdiff_t>(sy) * m_width;
+        Pixel *pixel = m_pixels.data() + IX(static_cast<std::int32_t>(center_x + sx * (swap ? y : x)),
+                                            static_cast<std::int32_t>(center_y + sy * (swap ? x : y)));
+        while (x >= y && x >= x_lo && y <= y_hi) {
+          *pixel = color;
+          if (err <= 0) {
+            y += 1;
+            err += 2 * y + 1;
+            pixel += y_step;
+          }
+          if (err > 0) {
+            x -= 1;
+            err -= 2 * x + 1;
+            pixel -= x_step;
+          }
+        }
+      }
+    }
+
+    void fill_circle_in(const std::int32_t center_x, const std::int32_t center_y, const std::int32_t radius,
+                        const Pixel color, const detail::ClipRect &clip) noexcept {
+      if (radius < 0)
+        return;
+      fill_symmetric_in(center_x, center_y, radius, color, clip,
+                        [&](const std::int64_t dy) { return detail::circle_half_width(radius, dy); },
+                        [](std::int64_t) { return std::int64_t{-1}; });
+    }
+
+    void fill_ellipse_in(const std::int32_t center_x, const std::int32_t center_y, const std::int32_t radius_x,
+                         const std::int32_t radius_y, const Pixel color, const detail::ClipRect &clip) noexcept {
+      if (radius_x < 0 || radius_y < 0)
+        return;
+      fill_symmetric_in(center_x, center_y, radius_y, color, clip,
+                        [&](const std::int64_t dy) { return detail::ellipse_half_width(radius_x, radius_y, dy); },
+                        [](std::int64_t) { return std::int64_t{-1}; });
+    }
+
+    void fill_annulus_in(const std::int32_t center_x, const std::int32_t center_y, const std::int32_t inner_radius,
+                         const std::int32_t outer_radius, const Pixel color, const detail::ClipRect &clip) noexcept {
+      if (inner_radius < 0 || inner_radius > outer_radius)
+        return;
+      fill_symmetric_in(center_x, center_y, outer_radius, color, clip,
+                        [&](const std::int64_t dy) { return detail::circle_half_width(outer_radius, dy); },
+                        [&](const std::int64_t dy) {
+                          return dy <= inner_radius ? detail::circle_half_width(inner_radius, dy) : std::int64_t{-1};
+                        });
+    }
+
+  private: /* Batch Rasterizers */
+    /*
+     * A batch takes the unchecked path when a single min/max pass over its coordinates shows that
+     * every shape lies inside the bitmap, and otherwise clips each shape. `color_step` is 1 for
+     * per shape colors and 0 for a single shared color.
+     */
+
+    void fill_rects_batch(const std::int32_t *x, const std::int32_t *y, const std::int32_t *width,
+                          const std::int32_t *height, const Pixel *colors, const std::size_t color_step,
+                          const std::size_t count) noexcept {
+      std::int32_t min_x = 0, min_y = 0, min_size = 1;
+      std::int64_t max_right = 0, max_bottom = 0;
+      for (std::size_t i = 0; i < count; ++i) {
+        min_x = std::min(min_x, x[i]);
+        min_y = std::min(min_y, y[i]);
+        min_size = std::min(min_size, std::min(width[i], height[i]));
+        max_right = std::max(max_right, static_cast<std::int64_t>(x[i]) + width[i]);
+        max_bottom = std::max(max_bottom, static_cast<std::int64_t>(y[i]) + height[i]);
+      }
+
+      if (min_x < 0 || min_y < 0 || min_size <= 0 || max_right > m_width || max_bottom > m_height) {
+        for (std::size_t i = 0; i < count; ++i)
+          fill_rect_in(x[i], y[i], width[i], height[i], colors[i * color_step], bounds());
+        return;
+      }
+      for (std::size_t i = 0; i < count; ++i) {
+        const Pixel color = colors[i * color_step];
+        Pixel *row = m_pixels.data() + IX(x[i], y[i]);
+        for (std::int32_t dy = 0; dy < height[i]; ++dy, row += m_width)
+          detail::fill_span(row, static_cast<std::size_t>(width[i]), color);
+      }
+    }
+
+    void fill_circles_batch(const std::int32_t *center_x, const std::int32_t *center_y, const std::int32_t *radius,
+                            const Pixel *colors, const std::size_t color_step, const std::size_t count) noexcept {
+      std::int64_t min_left = 0, min_top = 0, max_right = 0, max_bottom = 0;
+      std::int32_t min_radius = 0;
+      for (std::size_t i = 0; i < count; ++i) {
+        min_radius = std::min(min_radius, radius[i]);
+        min_left = std::min(min_left, static_cast<std::int64_t>(center_x[i]) - radius[i]);
+        min_top = std::min(min_top, static_cast<std::int64_t>(center_y[i]) - radius[i]);
+        max_right = std::max(max_right, static_cast<std::int64_t>(center_x[i]) + radius[i]);
+        max_bottom = std::max(max_bottom, static_cast<std::int64_t>(center_y[i]) + radius[i]);
+      }
+
+      if (min_radius < 0 || min_left < 0 || min_top < 0 || max_right >= m_width || max_bottom >= m_height) {
+        for (std::size_t i = 0; i < count; ++i)
+          fill_circle_in(center_x[i], center_y[i], radius[i], colors[i * color_step], bounds());
+        return;
+      }
+      for (std::size_t i = 0; i < count; ++i) {
+        const Pixel color = colors[i * color_step];
+        Pixel *const center = m_pixels.data() + IX(center_x[i], center_y[i]);
+        for (std::int32_t dy = 0; dy <= radius[i]; ++dy) {
+          const auto half = static_cast<std::ptrdiff_t>(detail::circle_half_width(radius[i], dy));
+          const auto length = static_cast<std::size_t>(2 * half + 1);
+          detail::fill_span(center + static_cast<std::ptrdiff_t>(dy) * m_width - half, length, color);
+          if (dy != 0)
+            detail::fill_span(center - static_cast<std::ptrdiff_t>(dy) * m_width - half, length, color);
+        }
+      }
+    }
+
+    void draw_lines_batch(const std::int32_t *x1, const std::int32_t *y1, const std::int32_t *x2,
+                          const std::int32_t *y2, const Pixel *colors, const std::size_t color_step,
+                          const std::size_t count) noexcept {
+      std::int32_t min_x = 0, min_y = 0, max_x = 0, max_y = 0;
+      for (std::size_t i = 0; i < count; ++i) {
+        min_x = std::min(min_x, std::min(x1[i], x2[i]));
+        min_y = std::min(min_y, std::min(y1[i], y2[i]));
+        max_x = std::max(max_x, std::max(x1[i], x2[i]));
+        max_y = std::max(max_y, std::max(y1[i], y2[i]));
+      }
+
+      if (min_x < 0 || min_y < 0 || max_x >= m_width || max_y >= m_height) {
+        for (std::size_t i = 0; i < count; ++i)
+          draw_line_in(x1[i], y1[i], x2[i], y2[i], colors[i * color_step], bounds());
+        return;
+      }
+      for (std::size_t i = 0; i < count; ++i) {
+        // Bresenham without bounds checks, stepping a pointer along the line
+        const std::int32_t dx = std::abs(x2[i] - x1[i]);
+        const std::int32_t dy = std::abs(y2[i] - y1[i]);
+        const std::ptrdiff_t sx = (x1[i] < x2[i]) ? 1 : -1;
+        const std::ptrdiff_t sy = (y1[i] < y2[i]) ? m_width : -static_cast<std::ptrdiff_t>(m_width);
+        const Pixel color = colors[i * color_step];
+        Pixel *pixel = m_pixels.data() + IX(x1[i], y1[i]);
+        std::int32_t err = dx - dy;
+        for (std::int32_t step = std::max(dx, dy); ; --step) {
+          *pixel = color;
+          if (step == 0)
+            break;
+          const std::int32_t e2 = 2 * err;
+          if (e2 > -dy) {
+            err -= dy;
+            pixel += sx;
+          }
+          if (e2 < dx) {
+            err += dx;
+            pixel += sy;
+          }
+        }
+      }
+    }
+
+  private: /* Polygons */
+    /**
+     *	Calls span(x1, x2, y) for every run [x1, x2] of row y inside the polygon, clipped to the bitmap,
+     *	walking an edge table sorted by first scanline and an active edge list sorted by x
+     */
+    template<typename Emit>
+    void polygon_spans(const PointF *points, const std::size_t *contour_sizes, const std::size_t contours,
+                       const FillRule rule, Emit &&span) {
+      // Edge table: every non horizontal edge with the scanlines it crosses, sorted by first scanline
+      std::vector<detail::PolygonEdge> &edges = detail::scratch<detail::PolygonEdges, detail::PolygonEdge>();
+      edges.clear();
+      std::size_t offset = 0;
+      for (std::size_t c = 0; c < contours; ++c) {
+        const std::size_t size = contour_sizes[c];
+        for (std::size_t i = 0; i < size; ++i) {
+          PointF a = points[offset + i];
+          PointF b = points[offset + (i + 1) % size];
+          if (a.y == b.y)
+            continue;
+          std::int32_t winding = 1;
+          if (a.y > b.y) {
+            std::swap(a, b);
+            winding = -1;
+          }
+          const double first = std::max(std::ceil(static_cast<double>(a.y)), 0.0);
+          const double last = std::min(std::ceil(static_cast<double>(b.y)), static_cast<double>(m_height));
+          if (first >= last)
+            continue;
+          edges.push_back({a.x, a.y, (static_cast<double>(b.x) - a.x) / (static_cast<double>(b.y) - a.y),
+                           static_cast<std::int32_t>(first), static_cast<std::int32_t>(last), winding});
+        }
+        offset += size;
+      }
+      if (edges.empty())
+        return;
+      std::sort(edges.begin(), edges.end(), [](const detail::PolygonEdge &a, const detail::PolygonEdge &b) {
+        return a.first < b.first;
+      });
+
+      // Active edge list, kept sorted by x with an insertion sort since the order changes little between rows
+      std::vector<detail::ActiveEdge> &active = detail::scratch<detail::PolygonActiveEdges, detail::ActiveEdge>();
+      active.clear();
+      std::size_t next = 0;
+      for (std::int32_t y = edges.front().first; y < m_height && (next < edges.size() || !active.empty()); ++y) {
+        if (active.empty() && edges[next].first > y)
+          y = edges[next].first;
+        while (next < edges.size() && edges[next].first == y) {
+          active.push_back({0.0, edges[next].winding, static_cast<std::uint32_t>(next)});
+          ++next;
+        }
+        active.erase(std::remove_if(active.begin(), active.end(), [&](const detail::ActiveEdge &e) {
+          return edges[e.edge].last <= y;
+        }), active.end());
+        for (std::size_t i = 0; i < active.size(); ++i) {
+          const detail::PolygonEdge &edge = edges[active[i].edge];
+          active[i].x = edge.x0 + (y - edge.y0) * edge.slope;
+          for (std::size_t j = i; j > 0 && active[j - 1].x > active[j].x; --j)
+            std::swap(active[j - 1], active[j]);
+        }
+
+        // Walk the crossings left to right, writing each inside span once
+        std::int32_t winding = 0;
+        for (std::size_t i = 0; i + 1 < active.size(); ++i) {
+          winding = rule == FillRule::EvenOdd ? (winding ^ 1) : winding + active[i].winding;
+          if (winding == 0)
+            continue;
+          std::size_t j = i + 1;
+          if (rule == FillRule::NonZero) {
+            std::int32_t running = winding;
+            while (j + 1 < active.size() && running + active[j].winding != 0)
+              running += active[j++].winding;
+            winding = running + active[j].winding;
+          } else {
+            winding = 0;
+          }
+          const double left = std::max(std::ceil(active[i].x), 0.0);
+          const double right = std::min(std::ceil(active[j].x), static_cast<double>(m_width)) - 1.0;
+          if (left <= right)
+            span(static_cast<std::int32_t>(left), static_cast<std::int32_t>(right), y);
+          i = j;
+        }
+      }
+    }
+
+  private: /* Strokes */
+    /**
+     *	Fills the union of the convex stroke pieces without writing any pixel twice: the span of every
+     *	piece on each of its rows is or'ed into a one bit per pixel mask, whose runs are then filled in
+     *	parallel row bands. Contour i has sizes[i] points and is closed when closed[i] is non zero.
+     */
+    void stroke(const PointF *points, const std::size_t *sizes, const std::uint8_t *closed, const std::size_t contours,
+                const Pixel color, const StrokeStyle &style) {
+      std::vector<PointF> &vertices = detail::scratch<detail::StrokeVertices, PointF>();
+      std::vector<std::size_t> &vertex_counts = detail::scratch<detail::StrokeContourSizes, std::size_t>();
+      vertices.clear();
+      vertex_counts.clear();
+      for (std::size_t c = 0; c < contours; ++c) {
+        const std::size_t begin = vertices.size();
+        for (std::size_t i = 0; i < sizes[c]; ++i, ++points)
+          if (vertices.size() == begin || vertices.back().x != points->x || vertices.back().y != points->y)
+            vertices.push_back(*points);
+        if (closed[c] && vertices.size() > begin + 1 && vertices.back().x == vertices[begin].x && vertices.back().y == vertices[begin].y)
+          vertices.pop_back();
+        vertex_counts.push_back(vertices.size() - begin);
+      }
+      if (vertices.empty() || m_width == 0 || m_height == 0)
+        return;
+
+      // The mask is all zeros between calls: take_runs clears every word it reads
+      const auto words = static_cast<std::size_t>((m_width + 63) / 64);
+      std::vector<std::uint64_t> &mask = detail::scratch<detail::StrokeMask, std::uint64_t>();
+      if (mask.size() < words * static_cast<std::size_t>(m_height))
+        mask.resize(words * static_cast<std::size_t>(m_height));
+      std::int32_t top = m_height, bottom = 0, left = m_width, right = -1;
+
+      std::vector<double> &bounds = detail::scratch<detail::StrokePieceBounds, double>();
+      std::size_t offset = 0;
+      for (std::size_t c = 0; c < contours; ++c) {
+        detail::stroke_pieces(vertices.data() + offset, vertex_counts[c], closed[c] != 0, style, m_width, m_height,
+                              [&](const detail::StrokePoint *piece, const std::size_t size) {
+          const auto [first, last] = detail::piece_rows(piece, size, m_height);
+          if (first >= last)
+            return;
+          // Left and right crossings of every row, edges covering rows [ceil(y0), ceil(y1))
+          const auto rows = static_cast<std::size_t>(last - first);
+          bounds.resize(2 * rows);
+          for (std::size_t r = 0; r < rows; ++r) {
+            bounds[2 * r] = std::numeric_limits<double>::infinity();
+            bounds[2 * r + 1] = -std::numeric_limits<double>::infinity();
+          }
+          for (std::size_t i = 0; i < size; ++i) {
+            detail::StrokePoint a = piece[i], b = piece[(i + 1) % size];
+            if (a.y == b.y)
+              continue;
+            if (a.y > b.y)
+              std::swap(a, b);
+            const double slope = (b.x - a.x) / (b.y - a.y);
+            const std::int32_t row_last = detail::clamped_ceil(b.y, first, last);
+            for (std::int32_t y = detail::clamped_ceil(a.y, first, last); y < row_last; ++y) {
+              const double x = a.x + (y - a.y) * slope;
+              double *bound = bounds.data() + 2 * static_cast<std::size_t>(y - first);
+              bound[0] = std::min(bound[0], x);
+              bound[1] = std::max(bound[1], x);
+            }
+          }
+          for (std::size_t r = 0; r < rows; ++r) {
+            const std::int32_t x1 = detail::clamped_ceil(bounds[2 * r], 0, m_width);
+            const std::int32_t x2 = detail::clamped_ceil(bounds[2 * r + 1], 0, m_width) - 1;
+            if (x1 > x2)
+              continue;
+            const std::int32_t y = first + static_cast<std::int32_t>(r);
+            detail::set_bits(mask.data() + static_cast<std::size_t>(y) * words, x1, x2);
+            top = std::min(top, y), bottom = std::max(bottom, y + 1);
+            left = std::min(left, x1), right = std::max(right, x2);
+          }
+        });
+        offset += vertex_counts[c];
+      }
+      if (left > right)
+        return;
+
+      detail::parallel_rows(top, bottom, detail::rows_per_band(m_width), [&](const std::int32_t first, const std::int32_t last) {
+        for (std::int32_t y = first; y < last; ++y)
+          detail::take_runs(mask.data() + static_cast<std::size_t>(y) * words, left >> 6, right >> 6,
+                            [&](const std::int32_t x1, const std::int32_t x2) { fill_row(x1, x2, y, color); });
+      });
+    }
+
+  private: /* Text */
+    /**
+     *	Glyph rows of each text line are gathered into one coverage row spanning the visible glyphs,
+     *	trimmed to the columns holding ink, and blended in a single pass
+     */
+    void draw_text_in(const Font &font, const std::int32_t x, const std::int32_t y, const std::string_view text,
+                      const Pixel color, const std::uint8_t opacity, const detail::ClipRect &clip) {
+      if (!font || opacity == 0)
+        return;
+      const std::int32_t width = font.m_glyph_width, height = font.m_glyph_height;
+      std::vector<std::uint8_t> &coverage = detail::scratch<detail::CoverageRow, std::uint8_t>();
+      std::vector<std::int32_t> &codes = detail::scratch<detail::TextGlyphCodes, std::int32_t>();
+
+      std::int64_t line_y = y;
+      for (std::size_t begin = 0; begin <= text.size(); line_y += height) {
+        const std::size_t end = std::min(text.find('\n', begin), text.size());
+        const std::string_view line = text.substr(begin, end - begin);
+        begin = end + 1;
+        if (line_y >= clip.y1)
+          break;
+        if (line.empty() || line_y + height <= clip.y0)
+          continue;
+
+        // Glyphs [g0, g1) of the line overlap the clip columns
+        const std::int64_t g0 = std::max<std::int64_t>(0, detail::floor_div(clip.x0 - static_cast<std::int64_t>(x), width));
+        const std::int64_t g1 = std::min<std::int64_t>(static_cast<std::int64_t>(line.size()),
+                                                       detail::ceil_div(clip.x1 - static_cast<std::int64_t>(x), width));
+        if (g0 >= g1)
+          continue;
+        const std::int64_t origin = x + g0 * width;
+        coverage.resize(static_cast<std::size_t>((g1 - g0) * width));
+        codes.clear();
+        for (std::int64_t g = g0; g < g1; ++g)
+          codes.push_back(font.has_glyph(line[static_cast<std::size_t>(g)])
+                            ? static_cast<unsigned char>(line[static_cast<std::size_t>(g)]) - font.m_first : -1);
+
+        const std::int32_t row_first = static_cast<std::int32_t>(std::max<std::int64_t>(0, clip.y0 - line_y));
+        const std::int32_t row_last = static_cast<std::int32_t>(std::min<std::int64_t>(height, clip.y1 - line_y));
+        for (std::int32_t row = row_first; row < row_last; ++row) {
+          std::int64_t first = std::numeric_limits<std::int64_t>::max(), last = 0;
+          for (std::size_t g = 0; g < codes.size(); ++g) {
+            std::uint8_t *out = coverage.data() + g * width;
+            if (codes[g] < 0) {
+              std::memset(out, 0, static_cast<std::size_t>(width));
+              continue;
+            }
+            const auto glyph_row = static_cast<std::size_t>(codes[g]) * height + row;
+            std::memcpy(out, font.m_coverage.data() + glyph_row * width, static_cast<std::size_t>(width));
+            const Font::InkSpan &ink = font.m_ink[glyph_row];
+            if (ink.first < ink.last) {
+              first = std::min<std::int64_t>(first, static_cast<std::int64_t>(g) * width + ink.first);
+              last = static_cast<std::int64_t>(g) * width + ink.last;
+            }
+          }
+          first = std::max(first, clip.x0 - origin);
+          last = std::min(last, clip.x1 - origin);
+          if (first >= last)
+            continue;
+          std::uint8_t *alpha = coverage.data() + first;
+          const auto count = static_cast<std::size_t>(last - first);
+          if (opacity != 255)
+            detail::scale_coverage(alpha, count, opacity);
+          detail::blend_span(m_pixels.data() + IX(static_cast<std::int32_t>(origin + first), static_cast<std::int32_t>(line_y + row)),
+                             alpha, count, color);
+        }
+      }
+    }
+
+  private: /* Gradients */
+    void shade_rect(const std::int32_t x1, const std::int32_t x2, const std::int32_t y1, const std::int32_t y2,
+                    const detail::GradientGeometry &geometry, const std::vector<std::uint32_t> &table) {
+      if (x1 > x2)
+        return;
+      const auto size = static_cast<std::int32_t>(table.size());
+      detail::parallel_rows(y1, y2, detail::rows_per_band(x2 - x1 + 1), [&](const std::int32_t first, const std::int32_t last) {
+        for (std::int32_t y = first; y < last; ++y)
+          detail::shade_gradient_row(m_pixels.data() + IX(0, y), x1, x2, y, geometry, table.data(), size);
+      });
+    }
+
+    void shade_spans(const Span *spans, const std::size_t count, const detail::GradientGeometry &geometry,
+                     const std::vector<std::uint32_t> &table) {
+      const auto size = static_cast<std::int32_t>(table.size());
+      for (std::size_t i = 0; i < count; ++i) {
+        const Span &span = spans[i];
+        if (span.y < 0 || span.y >= m_height || span.width <= 0)
+          continue;
+        const std::int32_t x1 = std::max(span.x, 0);
+        const auto x2 = static_cast<std::int32_t>(std::min<std::int64_t>(static_cast<std::int64_t>(span.x) + span.width, m_width) - 1);
+        detail::shade_gradient_row(m_pixels.data() + IX(0, span.y), x1, x2, span.y, geometry, table.data(), size);
+      }
+    }
+
+    void shade_polygon(const PointF *points, const std::size_t count, const FillRule rule,
+                       const detail::GradientGeometry &geometry, const std::vector<std::uint32_t> &table) {
+      const auto size = static_cast<std::int32_t>(table.size());
+      polygon_spans(points, &count, 1, rule, [&](const std::int32_t x1, const std::int32_t x2, const std::int32_t y) {
+        detail::shade_gradient_row(m_pixels.data() + IX(0, y), x1, x2, y, geometry, table.data(), size);
+      });
+    }
+
+  private: /* Patterns */
+    void fill_pattern_in(const std::int32_t x, const std::int32_t y, const std::int32_t width, const std::int32_t height,
+                         BitmapView tile, const std::int32_t origin_x, const std::int32_t origin_y, const char *function) {
+      if (!tile)
+        throw Exception(std::string(function) + ": tile is empty");
+      const Pixel *begin = m_pixels.data(), *end = begin + m_pixels.size();
+      if (tile.row(0) < end && tile.row(tile.height() - 1) + tile.width() > begin) {
+        // The tile views pixels about to be overwritten: tile a copy of it instead
+        std::vector<Pixel> &copy = detail::scratch<detail::PatternTile, Pixel>();
+        copy.resize(static_cast<std::size_t>(tile.width()) * static_cast<std::size_t>(tile.height()));
+        for (std::int32_t j = 0; j < tile.height(); ++j)
+          std::memcpy(copy.data() + static_cast<std::size_t>(j) * tile.width(), tile.row(j), tile.width() * sizeof(Pixel));
+        tile = BitmapView(copy.data(), tile.width(), tile.height(), tile.width());
+      }
+      fill_periodic(x, y, width, height, tile.width(), tile.height(), origin_x, origin_y,
+                    [&](Pixel *dst, const std::int32_t count, const std::int64_t row, const std::int64_t phase) {
+        const Pixel *source = tile.row(static_cast<std::int32_t>(row));
+        const std::int32_t head = std::min(count, tile.width() - static_cast<std::int32_t>(phase));
+        std::memcpy(dst, source + phase, static_cast<std::size_t>(head) * sizeof(Pixel));
+        std::memcpy(dst + head, source, static_cast<std::size_t>(count - head) * sizeof(Pixel));
+      });
+    }
+
+    /**
+     *	Fills the width x height rect at (x, y) with a pattern repeating every period_width x period_height
+     *	pixels from (origin_x, origin_y). period(dst, count, row, phase) writes the first count <= period_width
+     *	pixels of pattern row `row` from column `phase` on. That first period of a row is doubled across it
+     *	with memcpy, later rows copy the row a period above, and when the rect spans whole bitmap rows those
+     *	are contiguous and copied as growing blocks of whole periods.
+     */
+    template<typename Period>
+    void fill_periodic(const std::int32_t x, const std::int32_t y, const std::int32_t width, const std::int32_t height,
+                       const std::int64_t period_width, const std::int64_t period_height, const std::int64_t origin_x,
+                       const std::int64_t origin_y, Period &&period) {
+      if (width <= 0 || height <= 0)
+        return;
+      const std::int64_t phase = detail::floor_mod(x - origin_x, period_width);
+      const auto first = static_cast<std::int32_t>(std::min<std::int64_t>(period_width, width));
+      const auto rows = static_cast<std::int32_t>(std::min<std::int64_t>(period_height, height));
+      const auto row_size = static_cast<std::size_t>(width);
+      for (std::int32_t j = 0; j < rows; ++j) {
+        Pixel *row = m_pixels.data() + IX(x, y + j);
+        period(row, first, detail::floor_mod(y + j - origin_y, period_height), phase);
+        for (std::size_t done = static_cast<std::size_t>(first); done < row_size; done *= 2)
+          std::memcpy(row + done, row, std::min(done, row_size - done) * sizeof(Pixel));
+      }
+      if (x == 0 && width == m_width) {
+        // Copies double until they reach about 64 KB, then repeat the block just written, which is still cached
+        Pixel *block = m_pixels.data() + IX(0, y);
+        const std::size_t total = row_size * static_cast<std::size_t>(height);
+        std::size_t chunk = row_size * static_cast<std::size_t>(rows);
+        for (std::size_t done = chunk; done < total; done += chunk) {
+          if (chunk * 2 <= done && chunk * sizeof(Pixel) < (std::size_t{1} << 16))
+            chunk *= 2;
+          std::memcpy(block + done, block + (done - chunk), std::min(chunk, total - done) * sizeof(Pixel));
+        }
+        return;
+      }
+      for (std::int32_t j = rows; j < height; ++j)
+        std::memcpy(m_pixels.data() + IX(x, y + j), m_pixels.data() + IX(x, y + j - rows), row_size * sizeof(Pixel));
+    }
+
+  private: /* Region Filling */
+    /**
+     *	Span based flood fill: every popped span of a row is scanned for runs of inside pixels,
+     *	each run is grown to its full extent, filled at once, and the rows above and below it
+     *	(widened by one pixel for 8-connectivity) are pushed on an explicit stack.
+     */
+    template<typename Inside, typename Mark>
+    std::size_t flood(const std::int32_t x, const std::int32_t y, const Pixel color, const Connectivity connectivity,
+                      Inside &&inside, Mark &&mark) {
+      const std::int32_t grow = connectivity == Connectivity::Eight ? 1 : 0;
+      std::vector<detail::FillSpan> &stack = detail::scratch<detail::FloodFillSpans, detail::FillSpan>();
+      stack.clear();
+      stack.push_back({x, x, y});
+      std::size_t filled = 0;
+      while (!stack.empty()) {
+        const detail::FillSpan span = stack.back();
+        stack.pop_back();
+        const std::size_t row = IX(0, span.y);
+        for (std::int32_t run = span.x1; run <= span.x2; ++run) {
+          if (!inside(row + run))
+            continue;
+          std::int32_t left = run;
+          while (left > 0 && inside(row + left - 1)) --left;
+          std::int32_t right = run;
+          while (right < m_width - 1 && inside(row + right + 1)) ++right;
+
+          mark(row + left, row + right);
+          detail::fill_span(m_pixels.data() + row + left, static_cast<std::size_t>(right - left) + 1, color);
+          filled += static_cast<std::size_t>(right - left) + 1;
+
+          const std::int32_t x1 = std::max(left - grow, 0);
+          const std::int32_t x2 = std::min(right + grow, m_width - 1);
+          if (span.y > 0) stack.push_back({x1, x2, span.y - 1});
+          if (span.y < m_height - 1) stack.push_back({x1, x2, span.y + 1});
+          run = right + 1;
+        }
+      }
+      return filled;
+    }
+
+  private: /* Blitting */
+    void blit_rect(const Bitmap &source, const Sprite &sprite, const Pixel *key) {
+      // Clip against the source, then against this bitmap, moving both corners together
+      std::int64_t sx = sprite.source_x, sy = sprite.source_y, x = sprite.x, y = sprite.y;
+      std::int64_t width = sprite.width, height = sprite.height;
+      const auto clip = [&](std::int64_t &a, std::int64_t &b, std::int64_t &extent, const std::int64_t limit) {
+        if (a < 0) {
+          b -= a;
+          extent += a;
+          a = 0;
+        }
+        extent = std::min(extent, limit - a);
+      };
+      clip(sx, x, width, source.m_width);
+      clip(sy, y, height, source.m_height);
+      clip(x, sx, width, m_width);
+      clip(y, sy, height, m_height);
+      if (width <= 0 || height <= 0)
+        return;
+
+      const auto count = static_cast<std::size_t>(width);
+      const Pixel *rows = source.m_pixels.data() + source.IX(static_cast<std::int32_t>(sx), static_cast<std::int32_t>(sy));
+      std::ptrdiff_t stride = source.m_width;
+      if (&source == this) {
+        // Copy the source rectangle first so that overlapping rectangles blit correctly
+        std::vector<Pixel> &copy = detail::scratch<detail::BlitSource, Pixel>();
+        copy.resize(count * static_cast<std::size_t>(height));
+        for (std::int64_t j = 0; j < height; ++j)
+          std::memcpy(copy.data() + j * width, rows + j * stride, count * sizeof(Pixel));
+        rows = copy.data();
+        stride = static_cast<std::ptrdiff_t>(width);
+      }
+
+      Pixel *out = m_pixels.data() + IX(static_cast<std::int32_t>(x), static_cast<std::int32_t>(y));
+      for (std::int64_t j = 0; j < height; ++j, rows += stride, out += m_width) {
+        if (key == nullptr)
+          std::memcpy(out, rows, count * sizeof(Pixel));
+        else
+          detail::copy_keyed(out, rows, count, *key);
+      }
+    }
+
+  private: /* Compositing */
+    void composite(const BitmapView &source, const std::uint8_t *alpha, const std::int32_t alpha_stride,
+                   const std::int32_t x, const std::int32_t y, const BlendMode mode, const std::uint8_t opacity) {
+      if (!source || opacity == 0)
+        return;
+      switch (mode) {
+        case BlendMode::Normal: return composite<BlendMode::Normal>(source, alpha, alpha_stride, x, y, opacity);
+        case BlendMode::Add: return composite<BlendMode::Add>(source, alpha, alpha_stride, x, y, opacity);
+        case BlendMode::Subtract: return composite<BlendMode::Subtract>(source, alpha, alpha_stride, x, y, opacity);
+        case BlendMode::Multiply: return composite<BlendMode::Multiply>(source, alpha, alpha_stride, x, y, opacity);
+        case BlendMode::Screen: return composite<BlendMode::Screen>(source, alpha, alpha_stride, x, y, opacity);
+        case BlendMode::Darken: return composite<BlendMode::Darken>(source, alpha, alpha_stride, x, y, opacity);
+        case BlendMode::Lighten: return composite<BlendMode::Lighten>(source, alpha, alpha_stride, x, y, opacity);
+        case BlendMode::Difference: return composite<BlendMode::Difference>(source, alpha, alpha_stride, x, y, opacity);
+      }
+    }
+
+    template<BlendMode Mode>
+    void composite(const BitmapView &source, const std::uint8_t *alpha, const std::int32_t alpha_stride,
+                   const std::int32_t x, const std::int32_t y, const std::uint8_t opacity) {
+      // Clip the destination rectangle, (sx, sy) is the first visible source pixel
+      const std::int32_t x1 = std::max(x, 0);
+      const std::int32_t y1 = std::max(y, 0);
+      const std::int32_t x2 = static_cast<std::int32_t>(std::min<std::int64_t>(static_cast<std::int64_t>(x) + source.width(), m_width));
+      const std::int32_t y2 = static_cast<std::int32_t>(std::min<std::int64_t>(static_cast<std::int64_t>(y) + source.height(), m_height));
+      if (x1 >= x2 || y1 >= y2)
+        return;
+      const std::int32_t sx = x1 - x;
+      const std::int32_t sy = y1 - y;
+      const auto width = static_cast<std::size_t>(x2 - x1);
+
+      const auto rows = [&](const std::int32_t first, const std::int32_t last) {
+        for (std::int32_t dy = first; dy < last; ++dy) {
+          Pixel *const dst = m_pixels.data() + IX(x1, dy);
+          const Pixel *const src = source.row(sy + dy - y1) + sx;
+          if (Mode == BlendMode::Normal && alpha == nullptr && opacity == 255) {
+            std::memcpy(dst, src, width * sizeof(Pixel));
+            continue;
+          }
+          const std::uint8_t *mask = alpha == nullptr ? nullptr
+            : alpha + static_cast<std::ptrdiff_t>(sy + dy - y1) * alpha_stride + sx;
+          detail::composite_span<Mode>(dst, src, mask, opacity, width);
+        }
+      };
+      if (width * static_cast<std::size_t>(y2 - y1) < (1u << 16))
+        rows(y1, y2);
+      else
+        detail::parallel_rows(y1, y2, detail::rows_per_band(static_cast<std::int32_t>(width)), rows);
+    }
+
+  private: /* Utils */
+    /**
+     *	Blends `color` into pixel (x, y) with the given alpha, ignoring pixels outside the bitmap
+     */
+    void blend_pixel(const std::int32_t x, const std::int32_t y, const Pixel color, const std::uint8_t alpha) noexcept {
+      if (alpha != 0 && in_bounds(x, y)) {
+        Pixel &pixel = m_pixels[IX(x, y)];
+        pixel = detail::blend(pixel, color, alpha);
+      }
+    }
+
+    /**
+     *	Throws unless [first, last) is a range of rows of the bitmap, possibly empty
+     */
+    void check_rows(const std::int32_t first, const std::int32_t last) const {
+      if (first < 0 || last < first || last > m_height)
+        throw Exception("Bitmap::rows(" + std::to_string(first) + ", " + std::to_string(last) + "): first,last out of bounds");
+    }
+
+    /**
+     *	Returns the clip rectangle covering the whole bitmap
+     */
+    [[nodiscard]] constexpr detail::ClipRect bounds() const noexcept {
+      return {0, 0, m_width, m_height};
+    }
+
+    /**
+     *	Fills pixels x1..x2 (inclusive) of row y, coordinates must be in bounds
+     */
+    void fill_row(const std::int32_t x1, const std::int32_t x2, const std::int32_t y, const Pixel color) noexcept {
+      if (x2 >= x1)
+        detail::fill_span(m_pixels.data() + IX(x1, y), static_cast<std::size_t>(x2 - x1) + 1, color);
+    }
+
+    /**
+     *	Evaluates an index mapping of this bitmap into a new bitmap
+     */
+    [[nodiscard]] Bitmap remapped(const detail::PixelMapping &mapping) const {
+      Bitmap finished(mapping.width, mapping.height);
+      remap_into(mapping, finished.m_pixels.data());
+      return finished;
+    }
+
+    /**
+     *	Evaluates an index mapping of this bitmap into mapping.width x mapping.height pixels at `destination`
+     */
+    void remap_into(const detail::PixelMapping &mapping, Pixel *destination) const {
+      const std::int32_t band = ((detail::rows_per_band(mapping.width) + detail::REMAP_TILE - 1) / detail::REMAP_TILE) * detail::REMAP_TILE;
+      detail::parallel_rows(0, mapping.height, band, [&](const std::int32_t first, const std::int32_t last) {
+        detail::remap_rows(m_pixels.data(), m_width, mapping, first, last,
+                           destination + static_cast<std::size_t>(first) * mapping.width);
+      });
+    }
+
+    /**
+     *	Converts 2D x,y coords into 1D index
+     */
+    [[nodiscard]] constexpr std::size_t IX(const std::int32_t x, const std::int32_t y) const noexcept {
+      return static_cast<std::size_t>(x) + static_cast<std::size_t>(m_width) * static_cast<std::size_t>(y);
+    }
+    /**
+     *	Returns true if x,y coords are within boundaries
+     */
+    [[nodiscard]] constexpr bool in_bounds(const std::int32_t x, const std::int32_t y) const noexcept {
+      return (x >= 0) && (x < m_width) && (y >= 0) && (y < m_height);
+    }
+
+  private:
+    std::vector<Pixel> m_pixels;
+    std::int32_t m_width;
+    std::int32_t m_height;
+
+    friend class TransformView;
+    friend class DisplayList;
+  };
+
+  /**
+   * Lazy composition of flips, quarter turns and crops over a source bitmap.
+   * Each step only updates an integer index mapping; pixels are touched once,
+   * when the view is evaluated or streamed into a file.
+   */
+  class TransformView {
+  public:
+    explicit TransformView(const Bitmap &source) noexcept
+      : m_source(std::addressof(source)),
+        m_mapping(detail::PixelMapping::identity(source.width(), source.height())) {
+    }
+
+    [[nodiscard]] TransformView flip_v() const noexcept { return {m_source, m_mapping.flipped_v()}; }
+
+    [[nodiscard]] TransformView flip_h() const noexcept { return {m_source, m_mapping.flipped_h()}; }
+
+    [[nodiscard]] TransformView rotate_90_left() const noexcept { return {m_source, m_mapping.rotated_left()}; }
+
+    [[nodiscard]] TransformView rotate_90_right() const noexcept { return {m_source, m_mapping.rotated_right()}; }
+
+    /**
+     *	Keeps the width x height region at x,y of the current view
+     *   @throws bmp::Exception on error
+     */
+    [[nodiscard]] TransformView crop(const std::int32_t x, const std::int32_t y, const std::int32_t width,
+                                     const std::int32_t height) const {
+      if (x < 0 || y < 0 || width <= 0 || height <= 0 || x + width > m_mapping.width || y + height > m_mapping.height)
+        throw Exception(
+          "TransformView::crop(" + std::to_string(x) + ", " + std::to_string(y) + ", " + std::to_string(width) + ", " +
+          std::to_string(height) + "): x,y,w or h out of bounds");
+      return {m_source, m_mapping.cropped(x, y, width, height)};
+    }
+
+    /**
+     *	Returns the width of the transformed image
+     */
+    [[nodiscard]] std::int32_t width() const noexcept { return m_mapping.width; }
+
+    /**
+     *	Returns the height of the transformed image
+     */
+    [[nodiscard]] std::int32_t height() const noexcept { return m_mapping.height; }
+
+    /**
+     *	Evaluates the view into a new bitmap
+     */
+    [[nodiscard]] Bitmap to_bitmap() const {
+      return m_source->remapped(m_mapping);
+    }
+
+    /**
+     *	Evaluates the view into `destination`, which must already have the view size
+     *   @throws bmp::Exception on error
+     */
+    void evaluate(Bitmap &destination) const {
+      if (destination.m_width != m_mapping.width || destination.m_height != m_mapping.height)
+        throw Exception("TransformView::evaluate: destination size does not match the view size");
+      if (std::addressof(destination) == m_source)
+        throw Exception("TransformView::evaluate: destination must not be the source bitmap");
+      m_source->remap_into(m_mapping, destination.m_pixels.data());
+    }
+
+    /**
+     *	Streams the transformed pixels into a bitmap file, one band of rows at a time
+     *   @throws bmp::Exception on error
+     */
+    void save(const std::filesystem::path &filename) const {
+      std::vector<Pixel> &band = detail::scratch<TransformView, Pixel>();
+      band.resize(static_cast<std::size_t>(m_mapping.width) * detail::REMAP_TILE);
+      std::int32_t band_first = -1;
+      detail::write_bitmap(filename, m_mapping.width, m_mapping.height, [&](const std::int32_t y) {
+        if (band_first < 0 || y < band_first) {
+          band_first = (y / detail::REMAP_TILE) * detail::REMAP_TILE;
+          detail::remap_rows(m_source->m_pixels.data(), m_source->m_width, m_mapping, band_first,
+                             std::min(band_first + detail::REMAP_TILE, m_mapping.height), band.data());
+        }
+        return band.data() + static_cast<std::size_t>(y - band_first) * m_mapping.width;
+      }, "TransformView::save");
+    }
+
+  private:
+    TransformView(const Bitmap *source, const detail::PixelMapping &mapping) noexcept
+      : m_source(source), m_mapping(mapping) {
+    }
+
+  private:
+    const Bitmap *m_source;
+    detail::PixelMapping m_mapping;
+  };
+
+  inline Font Font::load(const std::filesystem::path &filename, const std::int32_t glyph_width,
+                         const std::int32_t glyph_height, const char first_char) {
+    Bitmap atlas;
+    atlas.load(filename);
+    return Font(atlas.view(), glyph_width, glyph_height, first_char);
+  }
+
+  inline TransformView Bitmap::transform() const noexcept {
+    return TransformView(*this);
+  }
+
+  /**
+   * Image pyramid (mipmap chain): level 0 is a copy of the source and every following level halves
+   * the previous one, down to 1x1. All levels share a single contiguous allocation.
+   */
+  class Pyramid {
+  public:
+    Pyramid() noexcept = default;
+
+    explicit Pyramid(const Bitmap &source, const PyramidFilter filter = PyramidFilter::Box) {
+      build(source, filter);
+    }
+
+    /**
+     *	Rebuilds every level from `source`, reusing the current allocation when it is large enough
+     *   @throws bmp::Exception on error
+     */
+    void build(const Bitmap &source, const PyramidFilter filter = PyramidFilter::Box) {
+      if (!source)
+        throw Exception("Pyramid::build: source bitmap is empty");
+
+      m_levels.clear();
+      std::size_t total = 0;
+      for (std::int32_t w = source.width(), h = source.height();; w = std::max(1, w / 2), h = std::max(1, h / 2)) {
+        m_levels.push_back({total, w, h});
+        total += static_cast<std::size_t>(w) * h;
+        if (w == 1 && h == 1)
+          break;
+      }
+      m_pixels.resize(total);
+
+      const BitmapView base = source.view();
+      for (std::int32_t y = 0; y < base.height(); ++y)
+        std::copy(base.row(y), base.row(y) + base.width(), m_pixels.data() + static_cast<std::size_t>(y) * base.width());
+
+      for (std::size_t i = 1; i < m_levels.size(); ++i) {
+        const Level &parent = m_levels[i - 1];
+        const Level &level = m_levels[i];
+        detail::parallel_rows(0, level.height, detail::rows_per_band(parent.width), [&](std::int32_t first, std::int32_t last) {
+          detail::reduce_rows(m_pixels.data() + parent.offset, parent.width, parent.height,
+                              m_pixels.data() + level.offset, first, last, filter);
+        });
+      }
+    }
+
+    /**
+     *	Returns the number of levels, including the full resolution level 0
+     */
+    [[nodiscard]] std::size_t levels() const noexcept { return m_levels.size(); }
+
+    /**
+     *	Returns a view of level i
+     *   @throws bmp::Exception on error
+     */
+    [[nodiscard]] BitmapView level(const std::size_t i) const {
+      if (i >= m_levels.size())
+        throw Exception("Pyramid::level(" + std::to_string(i) + "): level out of range");
+      const Level &level = m_levels[i];
+      return {m_pixels.data() + level.offset, level.width, level.height, level.width};
+    }
+
+    /**
+     *	Writes every level concurrently into `directory` as <stem>_<level>.bmp
+     *   @throws bmp::Exception on error
+     */
+    void save(const std::filesystem::path &directory, const std::string &stem) const {
+      detail::ThreadPool::instance().run(m_levels.size(), [&](const std::size_t i) {
+        level(i).save(directory / (stem + "_" + std::to_string(i) + ".bmp"));
+      });
+    }
+
+  private:
+    struct Level {
+      std::size_t offset;
+      std::int32_t width;
+      std::int32_t height;
+    };
+
+    std::vector<Pixel> m_pixels;
+    std::vector<Level> m_levels;
+  };
+
+  /**
+   * Builds every power of two downscale of `source`
+   */
+  [[nodiscard]] inline Pyramid build_pyramid(const Bitmap &source, const PyramidFilter filter = PyramidFilter::Box) {
+    return Pyramid(source, filter);
+  }
+
+  /**
+   * Retained list of draw commands. Commands are binned into 64x64 screen tiles when rendered
+   * and the tiles are rasterized in parallel on the thread pool; within a tile commands run in
+   * recording order, so the result is identical to drawing them one by one with the *_clipped
+   * primitives. Geometry outside the target is clipped rather than rejected.
+   */
+  class DisplayList {
+  public:
+    DisplayList() noexcept = default;
+
+  public: /* Recording */
+    void draw_line(const std::int32_t x1, const std::int32_t y1, const std::int32_t x2, const std::int32_t y2,
+                   const Pixel color) {
+      m_commands.push_back({Kind::Line, color, {x1, y1, x2, y2, 0, 0}});
+    }
+
+    void fill_rect(const std::int32_t x, const std::int32_t y, const std::int32_t width, const std::int32_t height,
+                   const Pixel color) {
+      m_commands.push_back({Kind::FillRect, color, {x, y, width, height, 0, 0}});
+    }
+
+    void draw_rect(const std::int32_t x, const std::int32_t y, const std::int32_t width, const std::int32_t height,
+                   const Pixel color) {
+      m_commands.push_back({Kind::DrawRect, color, {x, y, width, height, 0, 0}});
+    }
+
+    void fill_triangle(const std::int32_t x1, const std::int32_t y1, const std::int32_t x2, const std::int32_t y2,
+                       const std::int32_t x3, const std::int32_t y3, const Pixel color) {
+      m_commands.push_back({Kind::FillTriangle, color, {x1, y1, x2, y2, x3, y3}});
+    }
+
+    void draw_triangle(const std::int32_t x1, const std::int32_t y1, const std::int32_t x2, const std::int32_t y2,
+                       const std::int32_t x3, const std::int32_t y3, const Pixel color) {
+      m_commands.push_back({Kind::DrawTriangle, color, {x1, y1, x2, y2, x3, y3}});
+    }
+
+    void fill_circle(const std::int32_t center_x, const std::int32_t center_y, const std::int32_t radius,
+                     const Pixel color) {
+      m_commands.push_back({Kind::FillCircle, color, {center_x, center_y, radius, 0, 0, 0}});
+    }
+
+    void draw_circle(const std::int32_t center_x, const std::int32_t center_y, const std::int32_t radius,
+                     const Pixel color) {
+      m_commands.push_back({Kind::DrawCircle, color, {center_x, center_y, radius, 0, 0, 0}});
+    }
+
+  public: /* Accessors */
+    /**
+     *	Reserves space for `count` commands
+     */
+    void reserve(const std::size_t count) { m_commands.reserve(count); }
+
+    /**
+     *	Removes every command, keeping the allocation for the next frame
+     */
+    void clear() noexcept { m_commands.clear(); }
+
+    [[nodiscard]] std::size_t size() const noexcept { return m_commands.size(); }
+
+    [[nodiscard]] bool empty() const noexcept { return m_commands.empty(); }
+
+  public: /* Rendering */
+    /**
+     *	Draws every recorded command into `target`
+     */
+    void render(Bitmap &target) const {
+      if (m_commands.empty() || !target)
+        return;
+
+      constexpr std::int32_t tile = detail::DISPLAY_LIST_TILE;
+      const std::int32_t tiles_x = (target.width() + tile - 1) / tile;
+      const std::int32_t tiles_y = (target.height() + tile - 1) / tile;
+      const std::size_t tiles = static_cast<std::size_t>(tiles_x) * tiles_y;
+
+      // Counting sort of the commands into per tile bins: count, prefix sum, then scatter in
+      // recording order, so every bin lists its commands in draw order without per tile vectors.
+      std::vector<std::uint32_t> &starts = detail::scratch<detail::DisplayListTileStarts, std::uint32_t>();
+      std::vector<std::uint32_t> &commands = detail::scratch<detail::DisplayListTileCommands, std::uint32_t>();
+      std::vector<std::uint32_t> &cursor = detail::scratch<detail::DisplayListTileCursors, std::uint32_t>();
+      starts.assign(tiles + 1, 0);
+      const auto for_each_tile = [&](const Command &command, auto &&function) {
+        TileRange range{};
+        if (!tile_range(command, target.width(), target.height(), range))
+          return;
+        for (std::int32_t ty = range.y0; ty <= range.y1; ++ty)
+          for (std::int32_t tx = range.x0; tx <= range.x1; ++tx)
+            function(static_cast<std::size_t>(ty) * tiles_x + tx);
+      };
+      for (const Command &command: m_commands)
+        for_each_tile(command, [&](const std::size_t t) { ++starts[t + 1]; });
+      for (std::size_t t = 0; t < tiles; ++t)
+        starts[t + 1] += starts[t];
+      commands.resize(starts[tiles]);
+      cursor.assign(starts.begin(), starts.end() - 1);
+      for (std::size_t i = 0; i < m_commands.size(); ++i)
+        for_each_tile(m_commands[i], [&](const std::size_t t) { commands[cursor[t]++] = static_cast<std::uint32_t>(i); });
+
+      const std::uint32_t *const bin_starts = starts.data();
+      const std::uint32_t *const bin_commands = commands.data();
+      detail::ThreadPool::instance().run(tiles, [&](const std::size_t t) {
+        const std::int32_t x0 = static_cast<std::int32_t>(t % tiles_x) * tile;
+        const std::int32_t y0 = static_cast<std::int32_t>(t / tiles_x) * tile;
+        const detail::ClipRect clip{x0, y0, std::min(x0 + tile, target.width()), std::min(y0 + tile, target.height())};
+        for (std::uint32_t i = bin_starts[t]; i < bin_starts[t + 1]; ++i)
+          execute(target, m_commands[bin_commands[i]], clip);
+      });
+    }
+
+  private:
+    enum class Kind : std::uint8_t {
+      Line,
+      FillRect,
+      DrawRect,
+      FillTriangle,
+      DrawTriangle,
+      FillCircle,
+      DrawCircle
+    };
+
+    struct Command {
+      Kind kind;
+      Pixel color;
+      std::int32_t v[6];
+    };
+
+    struct TileRange {
+      std::int32_t x0, y0, x1, y1;
+    };
+
+    /**
+     *	Inclusive range of tiles touched by the bounding box of `command`, false when nothing is visible
+     */
+    static bool tile_range(const Command &command, const std::int32_t width, const std::int32_t height,
+                           TileRange &range) noexcept {
+      const std::int32_t *v = command.v;
+      std::int64_t x0, y0, x1, y1;
+      switch (command.kind) {
+        case Kind::Line:
+          x0 = std::min(v[0], v[2]), x1 = std::max(v[0], v[2]);
+          y0 = std::min(v[1], v[3]), y1 = std::max(v[1], v[3]);
+          break;
+        case Kind::FillRect:
+        case Kind::DrawRect:
+          if (v[2] <= 0 || v[3] <= 0)
+            return false;
+          x0 = v[0], x1 = static_cast<std::int64_t>(v[0]) + v[2] - 1;
+          y0 = v[1], y1 = static_cast<std::int64_t>(v[1]) + v[3] - 1;
+          break;
+        case Kind::FillTriangle:
+        case Kind::DrawTriangle:
+          x0 = std::min({v[0], v[2], v[4]}), x1 = std::max({v[0], v[2], v[4]});
+          y0 = std::min({v[1], v[3], v[5]}), y1 = std::max({v[1], v[3], v[5]});
+          break;
+        default: // Circles
+          if (v[2] < 0)
+            return false;
+          x0 = static_cast<std::int64_t>(v[0]) - v[2], x1 = static_cast<std::int64_t>(v[0]) + v[2];
+          y0 = static_cast<std::int64_t>(v[1]) - v[2], y1 = static_cast<std::int64_t>(v[1]) + v[2];
+          break;
+      }
+      if (x1 < 0 || y1 < 0 || x0 >= width || y0 >= height)
+        return false;
+      constexpr std::int32_t tile = detail::DISPLAY_LIST_TILE;
+      range.x0 = static_cast<std::int32_t>(std::max<std::int64_t>(x0, 0) / tile);
+      range.y0 = static_cast<std::int32_t>(std::max<std::int64_t>(y0, 0) / tile);
+      range.x1 = static_cast<std::int32_t>(std::min<std::int64_t>(x1, width - 1) / tile);
+      range.y1 = static_cast<std::int32_t>(std::min<std::int64_t>(y1, height - 1) / tile);
+      return true;
+    }
+
+    /**
+     *	Rasterizes the part of `command` inside `clip`
+     */
+    static void execute(Bitmap &target, const Command &command, const detail::ClipRect &clip) {
+      const std::int32_t *v = command.v;
+      switch (command.kind) {
+        case Kind::Line:
+          target.draw_line_in(v[0], v[1], v[2], v[3], command.color, clip);
+          break;
+        case Kind::FillRect:
+          target.fill_rect_in(v[0], v[1], v[2], v[3], command.color, clip);
+          break;
+        case Kind::DrawRect:
+          target.draw_rect_in(v[0], v[1], v[2], v[3], command.color, clip);
+          break;
+        case Kind::FillTriangle:
+          target.fill_triangle_in(v[0], v[1], v[2], v[3], v[4], v[5], command.color, clip);
+          break;
+        case Kind::DrawTriangle:
+          target.draw_triangle_in(v[0], v[1], v[2], v[3], v[4], v[5], command.color, clip);
+          break;
+        case Kind::FillCircle:
+          target.fill_circle_in(v[0], v[1], v[2], command.color, clip);
+          break;
+        case Kind::DrawCircle:
+          target.draw_circle_in(v[0], v[1], v[2], command.color, clip);
+          break;
+      }
+    }
+
+    std::vector<Command> m_commands;
+  };
+
+  /**
+   * Rectangle of pixels handed to the kernel of a TileScheduler
+   */
+  struct Tile {
+    std::int32_t x;
+    std::int32_t y;
+    std::int32_t width;
+    std::int32_t height;
+  };
+
+  /**
+   * Time the kernel of a TileScheduler spent on one tile and the worker slot that ran it
+   */
+  struct TileTiming {
+    Tile tile;
+    double seconds;
+    std::size_t worker;
+  };
+
+  /**
+   * Runs a kernel over fixed size tiles of a bitmap, for workloads whose cost per pixel varies
+   * wildly such as escape time fractals. Tiles are ordered along a Morton (Z) curve and every
+   * worker slot starts with a contiguous run of that order in its own queue, so neighbouring
+   * tiles run on the same thread. A slot takes tiles from the front of its queue and, once it
+   * is empty, steals the back half of the fullest other queue. The time spent on every tile of
+   * the last run is kept to find hotspots.
+   */
+  class TileScheduler {
+  public:
+    /**
+     *   @throws bmp::Exception when a tile dimension is not positive
+     */
+    explicit TileScheduler(const std::int32_t tile_width = 64, const std::int32_t tile_height = 64)
+      : m_tile_width(tile_width), m_tile_height(tile_height) {
+      if (tile_width <= 0 || tile_height <= 0)
+        throw Exception("TileScheduler: tile size " + std::to_string(tile_width) + "x" + std::to_string(tile_height) +
+                        " is not positive");
+    }
+
+    [[nodiscard]] std::int32_t tile_width() const noexcept { return m_tile_width; }
+
+    [[nodiscard]] std::int32_t tile_height() const noexcept { return m_tile_height; }
+
+  public: /* Scheduling */
+    /**
+     *	Calls kernel(tile) once for every tile covering a width x height area, concurrently on the
+     *	thread pool. Edge tiles are clipped to the area. The first exception thrown by the kernel
+     *	is rethrown once the other tiles are done.
+     */
+    template<typename Kernel>
+    void run(const std::int32_t width, const std::int32_t height, Kernel &&kernel) {
+      order_tiles(width, height);
+      const std::size_t tiles = m_order.size();
+      m_timings.resize(tiles);
+      if (tiles == 0)
+        return;
+
+      const std::size_t workers = std::min(detail::ThreadPool::instance().concurrency(), tiles);
+      const std::unique_ptr<Queue[]> queues(new Queue[workers]);
+      for (std::size_t i = 0; i < workers; ++i) {
+        queues[i].front = tiles * i / workers;
+        queues[i].back = tiles * (i + 1) / workers;
+      }
+      detail::ThreadPool::instance().run(workers, [&](const std::size_t worker) {
+        std::size_t index = 0;
+        while (next_tile(queues.get(), workers, worker, index)) {
+          const Tile tile = tile_at(m_order[index]);
+          const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+          kernel(tile);
+          m_timings[index] = {tile, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(), worker};
+        }
+      });
+    }
+
+    /**
+     *	Calls kernel(tile, rows) for every tile of `image`, where `rows` are the rows of the tile:
+     *	row[i] is the pixel at x = tile.x + i and row.y() is the row index in the bitmap
+     */
+    template<typename Kernel>
+    void run(Bitmap &image, Kernel &&kernel) {
+      Pixel *pixels = image.data();
+      const std::int32_t stride = image.width();
+      run(image.width(), image.height(), [&](const Tile &tile) {
+        kernel(tile, PixelRows<Pixel>(pixels + static_cast<std::ptrdiff_t>(tile.y) * stride + tile.x, stride, tile.width,
+                                      tile.y, tile.y + tile.height));
+      });
+    }
+
+    /**
+     *	Sets every pixel of `image` to function(x, y), tile by tile
+     */
+    template<typename Function>
+    void generate(Bitmap &image, Function &&function) {
+      run(image, [&](const Tile &tile, const PixelRows<Pixel> rows) {
+        for (const PixelRow<Pixel> row: rows)
+          for (std::int32_t i = 0; i < tile.width; ++i)
+            row[i] = function(tile.x + i, row.y());
+      });
+    }
+
+  public: /* Profiling */
+    /**
+     *	Returns the time spent on every tile by the last run, in scheduling (Morton) order
+     */
+    [[nodiscard]] const std::vector<TileTiming> &timings() const noexcept { return m_timings; }
+
+  private:
+    // Remaining tiles [front, back) of one worker slot, as positions in m_order
+    struct alignas(64) Queue {
+      std::mutex mutex;
+      std::size_t front{0};
+      std::size_t back{0};
+    };
+
+    // Rebuilds the Morton order of the tile grid when the area changed since the last run
+    void order_tiles(const std::int32_t width, const std::int32_t height) {
+      const std::int32_t tiles_x = width > 0 && height > 0 ? (width - 1) / m_tile_width + 1 : 0;
+      const std::int32_t tiles_y = width > 0 && height > 0 ? (height - 1) / m_tile_height + 1 : 0;
+      if (width == m_width && height == m_height && tiles_x * static_cast<std::size_t>(tiles_y) == m_order.size())
+        return;
+      m_width = width;
+      m_height = height;
+      m_tiles_x = tiles_x;
+      m_order.resize(static_cast<std::size_t>(tiles_x) * tiles_y);
+      for (std::size_t i = 0; i < m_order.size(); ++i)
+        m_order[i] = i;
+      const auto code = [tiles_x](const std::size_t i) {
+        return detail::morton_code(static_cast<std::uint32_t>(i % tiles_x), static_cast<std::uint32_t>(i / tiles_x));
+      };
+      std::sort(m_order.begin(), m_order.end(), [&](const std::size_t a, const std::size_t b) { return code(a) < code(b); });
+    }
+
+    [[nodiscard]] Tile tile_at(const std::size_t i) const noexcept {
+      const std::int32_t x = static_cast<std::int32_t>(i % m_tiles_x) * m_tile_width;
+      const std::int32_t y = static_cast<std::int32_t>(i / m_tiles_x) * m_tile_height;
+      return {x, y, std::min(m_tile_width, m_width - x), std::min(m_tile_height, m_height - y)};
+    }
+
+    // Takes the next tile of slot `worker` into `index`, stealing when its queue is empty. False once no tiles are left.
+    static bool next_tile(Queue *queues, const std::size_t workers, const std::size_t worker, std::size_t &index) {
+      Queue &own = queues[worker];
+      {
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (own.front < own.back) {
+          index = own.front++;
+          return true;
+        }
+      }
+      while (true) {
+        std::size_t victim = workers, most = 0;
+        for (std::size_t i = 0; i < workers; ++i) {
+          if (i == worker)
+            continue;
+          std::lock_guard<std::mutex> lock(queues[i].mutex);
+          if (queues[i].back - queues[i].front > most) {
+            most = queues[i].back - queues[i].front;
+            victim = i;
+          }
+        }
+        if (victim == workers)
+          return false;
+
+        std::size_t begin, end;
+        {
+          std::lock_guard<std::mutex> lock(queues[victim].mutex);
+          Queue &from = queues[victim];
+          if (from.front == from.back)
+            continue; // Emptied since it was picked
+          end = from.back;
+          begin = end - (end - from.front + 1) / 2;
+          from.back = begin;
+        }
+        std::lock_guard<std::mutex> lock(own.mutex);
+        own.front = begin + 1;
+        own.back = end;
+        index = begin;
+        return true;
+      }
+    }
+
+    std::int32_t m_tile_width;
+    std::int32_t m_tile_height;
+    std::int32_t m_width{0};
+    std::int32_t m_height{0};
+    std::int32_t m_tiles_x{0};
+    std::vector<std::size_t> m_order;
+    std::vector<TileTiming> m_timings;
+  };
+
+  /**
+   * Renders Mandelbrot and Julia sets. Pixels are iterated four at a time in SIMD lanes until all
+   * four are done. Points caught in a cycle or inside the main cardioid and period 2 bulb stop early
+   * (see FractalParams). Escaped points are colored by their smooth iteration count through a
+   * palette built once per render. Tiles are spread over the thread pool by a TileScheduler, whose
+   * timings show where the time went.
+   */
+  class FractalRenderer {
+  public:
+    FractalRenderer() = default;
+
+    /**
+     *	Renders the fractal described by `params` into every pixel of `image`
+     *   @throws bmp::Exception when max_iterations is 0 or above 2^20, the view width is not positive
+     *   or the colormap of the colors is invalid
+     */
+    void render(Bitmap &image, const FractalParams &params) {
+      const detail::FractalSetup setup = prepare(image.width(), image.height(), params);
+      m_scheduler.run(image, [&](const Tile &tile, const PixelRows<Pixel> rows) {
+        for (const PixelRow<Pixel> row: rows)
+          detail::shade_fractal_line(setup, tile.x, row.y(), 1, 0, tile.width, row.data(), 1);
+      });
+    }
+
+    /**
+     *	Renders like render(), skipping regions enclosed by a single color (Mariani-Silver subdivision).
+     *	Grid lines every 64 pixels are computed first. A cell whose border has one color is filled
+     *	with it. Any other cell is split in four by computing its middle row and column, and small
+     *	cells are computed in full. The Mandelbrot set and connected Julia sets have no holes, so cells
+     *	bordered by the inside color are almost always right. Cells bordered by one escape color can
+     *	miss details smaller than the cell that do not touch its border.
+     *   @throws bmp::Exception as render()
+     */
+    void render_adaptive(Bitmap &image, const FractalParams &params) {
+      subdivide(image, params, false, [](const Bitmap &, std::int32_t) {});
+    }
+
+    /**
+     *	Renders like render_adaptive(), coarse to fine. callback(image, pass) is called after the grid
+     *	lines and after every level of subdivision, with every cell still to refine filled with the
+     *	color of its top left corner, so that a viewer can show the partial image. The last call, which
+     *	has the highest pass number, shows the finished image.
+     *   @throws bmp::Exception as render(), or whatever the callback throws
+     */
+    template<typename Callback>
+    void render_progressive(Bitmap &image, const FractalParams &params, Callback &&callback) {
+      subdivide(image, params, true, std::forward<Callback>(callback));
+    }
+
+    /**
+     *	Returns the scheduler of the tiles, whose timings() cover the last render()
+     */
+    [[nodiscard]] const TileScheduler &scheduler() const noexcept { return m_scheduler; }
+
+  private:
+    // Rectangle whose border rows x0..x1 at y0 and y1 and columns y0..y1 at x0 and x1 are computed
+    struct Cell {
+      std::int32_t x0, y0, x1, y1;
+    };
+
+    template<typename Callback>
+    void subdivide(Bitmap &image, const FractalParams &params, const bool preview, Callback &&callback) {
+      const detail::FractalSetup setup = prepare(image.width(), image.height(), params);
+      if (!image)
+        return;
+      const std::int32_t width = image.width(), height = image.height();
+      Pixel *pixels = image.data();
+      const auto at = [&](const std::int32_t x, const std::int32_t y) -> Pixel & {
+        return pixels[static_cast<std::ptrdiff_t>(y) * width + x];
+      };
+      const auto fill_interior = [&](const Cell &cell, const Pixel color) {
+        for (std::int32_t y = cell.y0 + 1; y < cell.y1; ++y)
+          std::fill(&at(cell.x0 + 1, y), &at(cell.x1, y), color);
+      };
+
+      // Grid lines, including the last row and column. Columns skip the pixels the rows computed.
+      const auto lines = [](const std::int32_t size) {
+        std::vector<std::int32_t> positions;
+        for (std::int32_t i = 0; i < size - 1; i += detail::FRACTAL_GRID)
+          positions.push_back(i);
+        positions.push_back(size - 1);
+        return positions;
+      };
+      const std::vector<std::int32_t> xs = lines(width), ys = lines(height);
+      detail::ThreadPool::instance().run(ys.size() + xs.size(), [&](const std::size_t i) {
+        if (i < ys.size()) {
+          detail::shade_fractal_line(setup, 0, ys[i], 1, 0, width, &at(0, ys[i]), 1);
+          return;
+        }
+        const std::int32_t x = xs[i - ys.size()];
+        for (std::size_t j = 0; j + 1 < ys.size(); ++j)
+          detail::shade_fractal_line(setup, x, ys[j] + 1, 0, 1, ys[j + 1] - ys[j] - 1, &at(x, ys[j] + 1), width);
+      });
+      m_cells.clear();
+      for (std::size_t j = 0; j + 1 < ys.size(); ++j)
+        for (std::size_t i = 0; i + 1 < xs.size(); ++i)
+          m_cells.push_back({xs[i], ys[j], xs[i + 1], ys[j + 1]});
+      if (preview) {
+        detail::ThreadPool::instance().run(m_cells.size(), [&](const std::size_t i) {
+          fill_interior(m_cells[i], at(m_cells[i].x0, m_cells[i].y0));
+        });
+      }
+
+      for (std::int32_t pass = 0;; ++pass) {
+        if (preview)
+          callback(static_cast<const Bitmap &>(image), pass);
+        if (m_cells.empty())
+          return;
+
+        // Every cell writes only its own interior and leaves up to 4 children in its slots of m_split
+        m_split.assign(4 * m_cells.size(), Cell{0, 0, 0, 0});
+        detail::ThreadPool::instance().run(m_cells.size(), [&](const std::size_t i) {
+          const Cell cell = m_cells[i];
+          const std::int32_t inner_width = cell.x1 - cell.x0 - 1, inner_height = cell.y1 - cell.y0 - 1;
+          if (inner_width <= 0 || inner_height <= 0)
+            return;
+          const Pixel color = at(cell.x0, cell.y0);
+          bool uniform = true;
+          for (std::int32_t x = cell.x0; x <= cell.x1 && uniform; ++x)
+            uniform = at(x, cell.y0) == color && at(x, cell.y1) == color;
+          for (std::int32_t y = cell.y0 + 1; y < cell.y1 && uniform; ++y)
+            uniform = at(cell.x0, y) == color && at(cell.x1, y) == color;
+          if (uniform) {
+            fill_interior(cell, color);
+            return;
+          }
+          if (inner_width < detail::FRACTAL_MIN_CELL || inner_height < detail::FRACTAL_MIN_CELL) {
+            for (std::int32_t y = cell.y0 + 1; y < cell.y1; ++y)
+              detail::shade_fractal_line(setup, cell.x0 + 1, y, 1, 0, inner_width, &at(cell.x0 + 1, y), 1);
+            return;
+          }
+          const std::int32_t mx = cell.x0 + (cell.x1 - cell.x0) / 2, my = cell.y0 + (cell.y1 - cell.y0) / 2;
+          detail::shade_fractal_line(setup, cell.x0 + 1, my, 1, 0, inner_width, &at(cell.x0 + 1, my), 1);
+          detail::shade_fractal_line(setup, mx, cell.y0 + 1, 0, 1, my - cell.y0 - 1, &at(mx, cell.y0 + 1), width);
+          detail::shade_fractal_line(setup, mx, my + 1, 0, 1, cell.y1 - my - 1, &at(mx, my + 1), width);
+          Cell *children = m_split.data() + 4 * i;
+          children[0] = {cell.x0, cell.y0, mx, my};
+          children[1] = {mx, cell.y0, cell.x1, my};
+          children[2] = {cell.x0, my, mx, cell.y1};
+          children[3] = {mx, my, cell.x1, cell.y1};
+          if (preview)
+            for (int c = 0; c < 4; ++c)
+              fill_interior(children[c], at(children[c].x0, children[c].y0));
+        });
+        m_cells.clear();
+        for (const Cell &cell: m_split)
+          if (cell.x1 > cell.x0)
+            m_cells.push_back(cell);
+      }
+    }
+
+    // Checks `params` and builds the palette and mapping of a width x height image
+    detail::FractalSetup prepare(const std::int32_t width, const std::int32_t height, const FractalParams &params) {
+      if (params.max_iterations == 0 || params.max_iterations > detail::FRACTAL_MAX_ITERATIONS)
+        throw Exception("FractalRenderer: max_iterations " + std::to_string(params.max_iterations) + " is not in [1, " +
+                        std::to_string(detail::FRACTAL_MAX_ITERATIONS) + "]");
+      if (!(params.width > 0.0) || !std::isfinite(params.width))
+        throw Exception("FractalRenderer: view width " + std::to_string(params.width) + " is not positive");
+
+      // Entry k holds the color of the smooth iteration count (k + 0.5) / FRACTAL_SUBSTEPS
+      const std::vector<std::uint32_t> &table = detail::gradient_table(params.colors);
+      const double period = params.color_period > 0.0 ? params.color_period : params.max_iterations;
+      m_palette.resize((static_cast<std::size_t>(params.max_iterations) + 1) * detail::FRACTAL_SUBSTEPS);
+      for (std::size_t k = 0; k < m_palette.size(); ++k) {
+        double t = (static_cast<double>(k) + 0.5) / detail::FRACTAL_SUBSTEPS / period;
+        if (params.color_period > 0.0)
+          t -= std::floor(t);
+        const auto entry = static_cast<std::size_t>(t * static_cast<double>(table.size()));
+        m_palette[k] = table[std::min(entry, table.size() - 1)];
+      }
+
+      detail::FractalSetup setup;
+      setup.step = width > 0 ? params.width / width : 0.0;
+      setup.x0 = params.center_x - setup.step * (width - 1) / 2.0;
+      setup.y0 = params.center_y + setup.step * (height - 1) / 2.0;
+      setup.julia = params.type == FractalType::Julia;
+      setup.cr = params.julia_x;
+      setup.ci = params.julia_y;
+      setup.max_iterations = params.max_iterations;
+      setup.periodicity_check = params.periodicity_check;
+      setup.interior_check = params.interior_check;
+      setup.epsilon = std::min(1e-12, setup.step * 1e-4);
+      setup.palette = m_palette.data();
+      setup.palette_size = static_cast<std::uint32_t>(m_palette.size());
+      setup.inside = detail::pack(params.inside);
+      return setup;
+    }
+
+    TileScheduler m_scheduler;
+    std::vector<std::uint32_t> m_palette;
+    std::vector<Cell> m_cells;
+    std::vector<Cell> m_split;
   };
 }